@@ -0,0 +1,117 @@
+// Compares a loop of single lookups with the batched, prefetching lookups of
+// HtTable (both modes) and DEF_HASHTABLE, at table sizes from inside L2 to
+// well beyond it.
+//
+// usage: bench_batch [max_entries]
+
+#include "bench_common.h"
+#include "hashtable/hash64.h"
+#include "hashtable/hashtable.h"
+#include "hashtable/hashtable2.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_SIZE 24
+#define LOOKUPS (1u << 20)
+#define BATCH 256 // Keys handed to each batched call, like one system's worth of entities
+
+size_t IdTable_hash_key(uint64_t key) {
+	return (size_t) hash64_wy(&key, sizeof(key), 0);
+}
+
+DEF_HASHTABLE(uint64_t, uint64_t, IdTable)
+
+typedef struct {
+	double single_ns;
+	double batch_ns;
+} Timings;
+
+static Timings run_ht(HtMode mode, char (*keys)[KEY_SIZE], char **lookups, unsigned n) {
+	HtTable tab;
+	Timings t;
+	if (mode == HT_MODE_FLAT) {
+		ht_init_table_flat(&tab, n);
+	} else {
+		ht_init_table(&tab, n);
+	}
+	for (unsigned i = 0; i < n; ++i) {
+		ht_emplace(&tab, keys[i], keys[i]);
+	}
+
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(ht_search(&tab, lookups[i]));
+	}
+	t.single_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+
+	void *values[BATCH];
+	start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; i += BATCH) {
+		ht_search_batch(&tab, lookups + i, BATCH, values);
+		bench_consume(values);
+	}
+	t.batch_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+
+	ht_deinit_table(&tab);
+	return t;
+}
+
+static Timings run_def(const uint64_t *lookups, unsigned n) {
+	IdTable tab;
+	Timings t;
+	IdTable_init(&tab, n);
+	for (unsigned i = 0; i < n; ++i) {
+		IdTable_insert(&tab, (uint64_t) i * 4096, i);
+	}
+
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(IdTable_get(&tab, lookups[i]));
+	}
+	t.single_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+
+	uint64_t *values[BATCH];
+	start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; i += BATCH) {
+		IdTable_get_batch(&tab, lookups + i, BATCH, values);
+		bench_consume(values);
+	}
+	t.batch_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+
+	IdTable_deinit(&tab);
+	return t;
+}
+
+static void report(unsigned n, const char *name, Timings t) {
+	printf("%-10u %-14s %8.1fns %8.1fns %8.2fx\n", n, name, t.single_ns, t.batch_ns, t.single_ns / t.batch_ns);
+}
+
+int main(int argc, char **argv) {
+	unsigned max_n = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 1u << 22;
+	uint64_t seed = 1;
+
+	printf("%-10s %-14s %10s %10s %9s\n", "entries", "table", "single", "batch", "speedup");
+	for (unsigned n = 1u << 14; n <= max_n; n *= 4) {
+		char(*keys)[KEY_SIZE] = malloc((size_t) n * KEY_SIZE);
+		char	**lookups = malloc(sizeof(char *) * LOOKUPS);
+		uint64_t *ids = malloc(sizeof(uint64_t) * LOOKUPS);
+		for (unsigned i = 0; i < n; ++i) {
+			snprintf(keys[i], KEY_SIZE, "entity_%u", i);
+		}
+		// Random hits, so consecutive lookups share no cache lines
+		for (unsigned i = 0; i < LOOKUPS; ++i) {
+			unsigned k = (unsigned) (bench_rand(&seed) % n);
+			lookups[i] = keys[k];
+			ids[i] = (uint64_t) k * 4096;
+		}
+
+		report(n, "HtTable/chain", run_ht(HT_MODE_CHAINED, keys, lookups, n));
+		report(n, "HtTable/flat", run_ht(HT_MODE_FLAT, keys, lookups, n));
+		report(n, "DEF_HASHTABLE", run_def(ids, n));
+
+		free(keys);
+		free(lookups);
+		free(ids);
+	}
+	return 0;
+}
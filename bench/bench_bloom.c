@@ -0,0 +1,103 @@
+// Measures lookups that mostly miss, such as optional component lookups, with
+// and without an attached Bloom filter, for HtTable (both modes) and
+// DEF_HASHTABLE.
+//
+// usage: bench_bloom [max_entries] [hit_percent]
+
+#include "bench_common.h"
+#include "hashtable/hash64.h"
+#include "hashtable/hashtable.h"
+#include "hashtable/hashtable2.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_SIZE 24
+#define LOOKUPS	 (1u << 20)
+
+size_t IdTable_hash_key(uint64_t key) {
+	return (size_t) hash64_wy(&key, sizeof(key), 0);
+}
+
+DEF_HASHTABLE(uint64_t, uint64_t, IdTable)
+
+static double time_ht(HtTable *tab, char **lookups) {
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(ht_search(tab, lookups[i]));
+	}
+	return (double) (bench_now_ns() - start) / LOOKUPS;
+}
+
+static void run_ht(HtMode mode, char (*keys)[KEY_SIZE], char **lookups, unsigned n) {
+	HtTable tab;
+	if (mode == HT_MODE_FLAT) {
+		ht_init_table_flat(&tab, n);
+	} else {
+		ht_init_table(&tab, n);
+	}
+	for (unsigned i = 0; i < n; ++i) {
+		ht_emplace(&tab, keys[i], keys[i]);
+	}
+	double plain = time_ht(&tab, lookups);
+	ht_attach_bloom(&tab, 0);
+	double filtered = time_ht(&tab, lookups);
+	printf("%-10u %-14s %8.1fns %8.1fns %8.2fx\n", n, mode == HT_MODE_FLAT ? "HtTable/flat" : "HtTable/chain", plain,
+		   filtered, plain / filtered);
+	ht_deinit_table(&tab);
+}
+
+static double time_def(IdTable *tab, const uint64_t *lookups) {
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(IdTable_get(tab, lookups[i]));
+	}
+	return (double) (bench_now_ns() - start) / LOOKUPS;
+}
+
+static void run_def(const uint64_t *lookups, unsigned n) {
+	IdTable tab;
+	IdTable_init(&tab, n);
+	for (unsigned i = 0; i < n; ++i) {
+		IdTable_insert(&tab, i, i);
+	}
+	double plain = time_def(&tab, lookups);
+	IdTable_attach_bloom(&tab, 0);
+	double filtered = time_def(&tab, lookups);
+	printf("%-10u %-14s %8.1fns %8.1fns %8.2fx\n", n, "DEF_HASHTABLE", plain, filtered, plain / filtered);
+	IdTable_deinit(&tab);
+}
+
+int main(int argc, char **argv) {
+	unsigned max_n = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 1u << 22;
+	unsigned hit_percent = argc > 2 ? (unsigned) strtoul(argv[2], NULL, 10) : 10;
+	uint64_t seed = 1;
+
+	printf("%u%% of lookups hit\n", hit_percent);
+	printf("%-10s %-14s %10s %10s %9s\n", "entries", "table", "plain", "filtered", "speedup");
+	for (unsigned n = 1u << 14; n <= max_n; n *= 4) {
+		// The second half of the keys is never inserted and serves the misses
+		char(*keys)[KEY_SIZE] = malloc((size_t) n * 2 * KEY_SIZE);
+		char	**lookups = malloc(sizeof(char *) * LOOKUPS);
+		uint64_t *ids = malloc(sizeof(uint64_t) * LOOKUPS);
+		for (unsigned i = 0; i < n * 2; ++i) {
+			snprintf(keys[i], KEY_SIZE, "entity_%u", i);
+		}
+		for (unsigned i = 0; i < LOOKUPS; ++i) {
+			unsigned k = (unsigned) (bench_rand(&seed) % n);
+			if (bench_rand(&seed) % 100 >= hit_percent) {
+				k += n;
+			}
+			lookups[i] = keys[k];
+			ids[i] = k;
+		}
+
+		run_ht(HT_MODE_CHAINED, keys, lookups, n);
+		run_ht(HT_MODE_FLAT, keys, lookups, n);
+		run_def(ids, n);
+
+		free(keys);
+		free(lookups);
+		free(ids);
+	}
+	return 0;
+}
@@ -0,0 +1,84 @@
+// Compares DEF_BPLUSTREE with the red-black DEF_BTREE on random 64-bit keys:
+// inserting every key, looking up every key in random order, and walking
+// the whole tree in key order. The binary tree links nodes preallocated in
+// one array, so its insert times do not include allocation.
+//
+// usage: bench_bplustree [max_keys]
+
+#include "bench_common.h"
+#include "btree/bplustree.h"
+#include "btree/btree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+DEF_BPLUSTREE(uint64_t, uint64_t, KeyMap)
+DEF_BTREE(uint64_t, KeyTree)
+
+static int KeyTree_node_cmp(KeyTree_node *pnode_a, KeyTree_node *pnode_b) {
+	return (pnode_a->value > pnode_b->value) - (pnode_a->value < pnode_b->value);
+}
+
+static double ns_per(uint64_t start, size_t n) {
+	return (double) (bench_now_ns() - start) / (double) n;
+}
+
+int main(int argc, char **argv) {
+	size_t	 max_n = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 10000000;
+	uint64_t seed = 1;
+
+	uint64_t *keys = malloc(max_n * sizeof(uint64_t));
+	uint64_t *probes = malloc(max_n * sizeof(uint64_t));
+	for (size_t i = 0; i < max_n; ++i)
+		keys[i] = bench_rand(&seed);
+
+	printf("%10s  %-8s %10s %10s %10s  (ns per key)\n", "keys", "tree", "insert", "find", "walk");
+	for (size_t n = 1000; n <= max_n; n *= 10) {
+		for (size_t i = 0; i < n; ++i)
+			probes[i] = keys[bench_rand(&seed) % n];
+		uint64_t sum = 0;
+
+		KeyMap map;
+		KeyMap_init(&map);
+		uint64_t start = bench_now_ns();
+		for (size_t i = 0; i < n; ++i)
+			KeyMap_insert(&map, keys[i], i);
+		double insert = ns_per(start, n);
+		start = bench_now_ns();
+		for (size_t i = 0; i < n; ++i)
+			sum += *KeyMap_find(&map, probes[i]);
+		double find = ns_per(start, n);
+		start = bench_now_ns();
+		for (KeyMap_cursor cursor = KeyMap_begin(&map); KeyMap_cursor_valid(&cursor); KeyMap_cursor_next(&cursor))
+			sum += *KeyMap_cursor_value(&cursor);
+		double walk = ns_per(start, n);
+		printf("%10zu  %-8s %10.1f %10.1f %10.1f\n", n, "b+tree", insert, find, walk);
+		KeyMap_deinit(&map);
+
+		KeyTree_node *nodes = malloc(n * sizeof(KeyTree_node));
+		KeyTree		  tree;
+		KeyTree_init(&tree);
+		start = bench_now_ns();
+		for (size_t i = 0; i < n; ++i) {
+			KeyTree_node_init_t(&nodes[i], keys[i]);
+			KeyTree_insert(&tree, &nodes[i]);
+		}
+		insert = ns_per(start, n);
+		start = bench_now_ns();
+		for (size_t i = 0; i < n; ++i)
+			sum += KeyTree_find(&tree, probes[i])->value;
+		find = ns_per(start, n);
+		KeyTree_node *node;
+		start = bench_now_ns();
+		BTREE_FOREACH(KeyTree, &tree, node) {
+			sum += node->value;
+		}
+		walk = ns_per(start, n);
+		printf("%10zu  %-8s %10.1f %10.1f %10.1f\n", n, "rbtree", insert, find, walk);
+		free(nodes);
+		bench_consume(&sum);
+	}
+
+	free(keys);
+	free(probes);
+	return 0;
+}
@@ -0,0 +1,93 @@
+// Compares walking a DEF_COLONY with walking a DEF_VECTOR and an array of
+// separately malloc'd objects (the usual way to get stable addresses), with
+// increasing fractions of the elements erased.
+//
+// usage: bench_colony [elements]
+
+#include "bench_common.h"
+#include "vector/colony.h"
+#include "vector/vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Entity {
+	float position[3];
+	float velocity[3];
+} Entity;
+
+DEF_COLONY(Entity, EntityColony)
+DEF_VECTOR(Entity, EntityVec)
+DEF_VECTOR(Entity *, EntityPtrVec)
+
+static Entity make_entity(size_t i) {
+	Entity e = {{(float) i, 0, 0}, {1, 2, 3}};
+	return e;
+}
+
+// Nanoseconds per live element of the fastest of a few walks, summing x positions
+#define TIME_WALK(LOOP, live)                                                                                          \
+	do {                                                                                                               \
+		uint64_t best = UINT64_MAX;                                                                                    \
+		for (int rep = 0; rep < 5; ++rep) {                                                                            \
+			float	 sum = 0;                                                                                          \
+			uint64_t start = bench_now_ns();                                                                           \
+			LOOP;                                                                                                      \
+			uint64_t ns = bench_now_ns() - start;                                                                      \
+			bench_consume(&sum);                                                                                       \
+			if (ns < best)                                                                                             \
+				best = ns;                                                                                             \
+		}                                                                                                              \
+		printf(" %10.2f", (double) best / (double) (live));                                                            \
+	} while (0)
+
+int main(int argc, char **argv) {
+	size_t	 n = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 1000000;
+	uint64_t seed = 1;
+
+	EntityColony colony;
+	EntityVec	 vec;
+	EntityPtrVec objects;
+	EntityColony_init(&colony);
+	EntityVec_init(&vec, n);
+	EntityPtrVec_init(&objects, n);
+	Entity **in_colony = malloc(n * sizeof(Entity *));
+	for (size_t i = 0; i < n; ++i) {
+		in_colony[i] = EntityColony_insert(&colony, make_entity(i));
+		EntityVec_push_back(&vec, make_entity(i));
+		Entity *e = malloc(sizeof(Entity));
+		*e = make_entity(i);
+		EntityPtrVec_push_back(&objects, e);
+	}
+
+	printf("%-8s %10s %10s %10s  (ns per live element)\n", "erased", "vector", "malloc", "colony");
+	for (int percent = 0; percent <= 90; percent += 30) {
+		// Erase at random until `percent` of the original elements are gone; the vector
+		// and the pointer array close the gaps, the colony leaves them in place
+		size_t target = n - n * (size_t) percent / 100;
+		while (colony.count > target) {
+			size_t i = (size_t) (bench_rand(&seed) % n);
+			if (in_colony[i]) {
+				EntityColony_erase(&colony, in_colony[i]);
+				in_colony[i] = NULL;
+			}
+		}
+		vec.count = target;
+		while (objects.count > target)
+			free(objects.data[--objects.count]);
+
+		printf("%-7d%%", percent);
+		TIME_WALK(for (size_t i = 0; i < vec.count; ++i) sum += vec.data[i].position[0], target);
+		TIME_WALK(for (size_t i = 0; i < objects.count; ++i) sum += objects.data[i]->position[0], target);
+		Entity *e;
+		TIME_WALK(COLONY_FOREACH(EntityColony, &colony, e) sum += e->position[0], target);
+		printf("\n");
+	}
+
+	for (size_t i = 0; i < objects.count; ++i)
+		free(objects.data[i]);
+	EntityPtrVec_deinit(&objects);
+	EntityVec_deinit(&vec);
+	EntityColony_deinit(&colony);
+	free(in_colony);
+	return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Monotonic wall clock in nanoseconds
+static inline uint64_t bench_now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// xorshift64* generator, good enough to shuffle benchmark inputs
+static inline uint64_t bench_rand(uint64_t *state) {
+	uint64_t x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return x * 0x2545f4914f6cdd1dull;
+}
+
+// Keeps the optimizer from discarding a computed result
+static inline void bench_consume(const void *p) {
+#if defined(__GNUC__) || defined(__clang__)
+	__asm__ volatile("" : : "r"(p) : "memory");
+#else
+	static const void *volatile sink;
+	sink = p;
+#endif
+}
+
+#endif // BENCH_COMMON_H
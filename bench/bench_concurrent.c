@@ -0,0 +1,111 @@
+// Measures multi-threaded throughput of HtConcurrentTable against an HtTable
+// behind one mutex, for 1 up to max_threads threads doing 95% lookups and 5%
+// inserts/deletes.
+//
+// usage: bench_concurrent [max_threads] [entries]
+
+#include "bench_common.h"
+#include "hashtable/hashtable.h"
+#include "hashtable/htconcurrent.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_SIZE 24
+#define OPS_PER_THREAD (1u << 20)
+#define WRITE_PERCENT 5
+
+typedef struct {
+	HtConcurrentTable *ctab;   // Table under test, or NULL for the locked HtTable
+	HtTable			  *tab;	   // HtTable shared through `lock`
+	pthread_mutex_t	  *lock;   // The external mutex HtTable users need today
+	char (*keys)[KEY_SIZE];	   // Keys present in the table
+	char (*extra)[KEY_SIZE];   // Keys written and deleted by the writes
+	unsigned		   n;	   // Number of keys
+	uint64_t		   seed;   // Per-thread random state
+} Worker;
+
+static void *work(void *p) {
+	Worker *w = p;
+	for (unsigned i = 0; i < OPS_PER_THREAD; ++i) {
+		uint64_t r = bench_rand(&w->seed);
+		unsigned k = (unsigned) (r % w->n);
+		bool	 write = (r >> 40) % 100 < WRITE_PERCENT;
+		if (w->ctab) {
+			if (!write) {
+				bench_consume(htc_search(w->ctab, w->keys[k]));
+			} else if (r & (1ull << 63)) {
+				htc_emplace(w->ctab, w->extra[k], w->extra[k]);
+			} else {
+				htc_delete(w->ctab, w->extra[k]);
+			}
+		} else {
+			pthread_mutex_lock(w->lock);
+			if (!write) {
+				bench_consume(ht_search(w->tab, w->keys[k]));
+			} else if (r & (1ull << 63)) {
+				ht_emplace(w->tab, w->extra[k], w->extra[k]);
+			} else {
+				ht_delete(w->tab, w->extra[k]);
+			}
+			pthread_mutex_unlock(w->lock);
+		}
+	}
+	return NULL;
+}
+
+// Runs `threads` workers and returns millions of operations per second
+static double run(unsigned threads, HtConcurrentTable *ctab, HtTable *tab, pthread_mutex_t *lock,
+				  char (*keys)[KEY_SIZE], char (*extra)[KEY_SIZE], unsigned n) {
+	pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+	Worker	  *workers = malloc(sizeof(Worker) * threads);
+
+	uint64_t start = bench_now_ns();
+	for (unsigned t = 0; t < threads; ++t) {
+		workers[t] = (Worker){ctab, tab, lock, keys, extra, n, t + 1};
+		pthread_create(&ids[t], NULL, work, &workers[t]);
+	}
+	for (unsigned t = 0; t < threads; ++t) {
+		pthread_join(ids[t], NULL);
+	}
+	uint64_t elapsed = bench_now_ns() - start;
+
+	free(ids);
+	free(workers);
+	return (double) OPS_PER_THREAD * threads / (double) elapsed * 1e3;
+}
+
+int main(int argc, char **argv) {
+	unsigned max_threads = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 16;
+	unsigned n = argc > 2 ? (unsigned) strtoul(argv[2], NULL, 10) : 1u << 16;
+
+	char(*keys)[KEY_SIZE] = malloc((size_t) n * KEY_SIZE);
+	char(*extra)[KEY_SIZE] = malloc((size_t) n * KEY_SIZE);
+	for (unsigned i = 0; i < n; ++i) {
+		snprintf(keys[i], KEY_SIZE, "entity_%u", i);
+		snprintf(extra[i], KEY_SIZE, "spawned_%u", i);
+	}
+
+	HtConcurrentTable ctab;
+	htc_init_table(&ctab, 64, n / 64);
+	HtTable tab;
+	ht_init_table_flat(&tab, n);
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	for (unsigned i = 0; i < n; ++i) {
+		htc_emplace(&ctab, keys[i], keys[i]);
+		ht_emplace(&tab, keys[i], keys[i]);
+	}
+
+	printf("%-8s %14s %14s\n", "threads", "concurrent", "mutex+flat");
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		double concurrent = run(threads, &ctab, NULL, NULL, keys, extra, n);
+		double locked = run(threads, NULL, &tab, &lock, keys, extra, n);
+		printf("%-8u %9.1f Mop/s %9.1f Mop/s\n", threads, concurrent, locked);
+	}
+
+	htc_deinit_table(&ctab);
+	ht_deinit_table(&tab);
+	free(keys);
+	free(extra);
+	return 0;
+}
@@ -0,0 +1,152 @@
+// Compares the HtTable hash functions: throughput in bytes per cycle across
+// key lengths, and bucket distribution on key sets shaped like real game data.
+//
+// usage: bench_hash [keys_per_set]
+
+#include "bench_common.h"
+#include "hashtable/hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#else
+#define BENCH_CYCLES() bench_now_ns() // Reported figures are then bytes per ns
+#endif
+
+#define MAX_KEY 64
+
+typedef struct {
+	const char *name;
+	HtHashFn	fn;
+} HashCase;
+
+static const HashCase hashes[] = {
+	{"shift-add", ht_hash_shift_add}, {"fnv1a", ht_hash_fnv1a}, {"wy", ht_hash_wy},
+	{"xxh", ht_hash_xxh},			  {"crc", ht_hash_crc},
+};
+#define HASH_COUNT (sizeof(hashes) / sizeof(hashes[0]))
+
+typedef struct {
+	char  (*keys)[MAX_KEY];
+	size_t *lens;
+	unsigned count;
+} KeySet;
+
+static const char *components[] = {"Transform", "RigidBody", "Collider", "MeshRenderer", "Animator",
+								   "AudioSource", "Light", "Camera", "Script", "ParticleEmitter"};
+static const char *asset_dirs[] = {"textures/env", "textures/characters", "meshes/props", "sounds/sfx", "shaders"};
+static const char *asset_exts[] = {".png", ".ktx2", ".gltf", ".ogg", ".spv"};
+static const char *loc_screens[] = {"menu", "hud", "inventory", "dialog", "settings", "quest"};
+
+static KeySet make_set(const char *kind, unsigned n) {
+	KeySet set = {malloc((size_t) n * MAX_KEY), malloc(sizeof(size_t) * n), n};
+	for (unsigned i = 0; i < n; ++i) {
+		char *key = set.keys[i];
+		int	  len = 0;
+		if (strcmp(kind, "components") == 0) {
+			len = snprintf(key, MAX_KEY, "%sComponent#%u", components[i % 10], i / 10);
+		} else if (strcmp(kind, "asset paths") == 0) {
+			len = snprintf(key, MAX_KEY, "assets/%s/item_%05u_lod%u%s", asset_dirs[i % 5], i / 15, i % 3,
+						   asset_exts[i % 5]);
+		} else if (strcmp(kind, "loc keys") == 0) {
+			len = snprintf(key, MAX_KEY, "ui.%s.entry_%u.label", loc_screens[i % 6], i / 6);
+		} else {
+			// Entity IDs packed as index << 12 | generation, hashed as raw bytes
+			uint32_t id = (i << 12) | (i & 7);
+			memcpy(key, &id, sizeof(id));
+			len = sizeof(id);
+		}
+		set.lens[i] = (size_t) len;
+	}
+	return set;
+}
+
+// Hashes every key into `buckets` buckets (a power of two, indexed by the low
+// bits) and reports the chi-square statistic divided by its expected value
+// (about 1.0 for a uniform hash) and the fullest bucket.
+static void distribution(const HashCase *hash, const KeySet *set, unsigned buckets, double *chi_ratio,
+						 unsigned *max_load) {
+	unsigned *counts = calloc(buckets, sizeof(unsigned));
+	for (unsigned i = 0; i < set->count; ++i) {
+		++counts[hash->fn(set->keys[i], set->lens[i], 0) & (buckets - 1)];
+	}
+
+	double expected = (double) set->count / buckets;
+	double chi = 0;
+	*max_load = 0;
+	for (unsigned b = 0; b < buckets; ++b) {
+		double d = counts[b] - expected;
+		chi += d * d / expected;
+		if (counts[b] > *max_load) {
+			*max_load = counts[b];
+		}
+	}
+	*chi_ratio = chi / (buckets - 1);
+	free(counts);
+}
+
+static double bytes_per_cycle(const HashCase *hash, const unsigned char *buf, size_t len) {
+	unsigned iters = (unsigned) (64u * 1024 * 1024 / (len + 16));
+	uint64_t sink = 0;
+	uint64_t start = BENCH_CYCLES();
+	for (unsigned i = 0; i < iters; ++i) {
+		sink += hash->fn(buf, len, sink); // Chain the seed so calls cannot overlap
+	}
+	uint64_t cycles = BENCH_CYCLES() - start;
+	bench_consume(&sink);
+	return (double) len * iters / (double) cycles;
+}
+
+int main(int argc, char **argv) {
+	unsigned n = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 1u << 16;
+
+	printf("Throughput (bytes/cycle)\n%-8s", "length");
+	for (unsigned h = 0; h < HASH_COUNT; ++h) {
+		printf(" %10s", hashes[h].name);
+	}
+	printf("\n");
+
+	unsigned char *buf = malloc(4096);
+	uint64_t	   seed = 1;
+	for (unsigned i = 0; i < 4096; ++i) {
+		buf[i] = (unsigned char) bench_rand(&seed);
+	}
+	static const size_t lengths[] = {4, 8, 16, 24, 32, 64, 128, 256, 1024, 4096};
+	for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+		printf("%-8zu", lengths[l]);
+		for (unsigned h = 0; h < HASH_COUNT; ++h) {
+			printf(" %10.2f", bytes_per_cycle(&hashes[h], buf, lengths[l]));
+		}
+		printf("\n");
+	}
+	free(buf);
+
+	unsigned buckets = 1;
+	while (buckets < n) {
+		buckets *= 2;
+	}
+	printf("\nDistribution over %u buckets, %u keys (chi2/expected, max bucket load)\n%-12s", buckets, n, "key set");
+	for (unsigned h = 0; h < HASH_COUNT; ++h) {
+		printf(" %14s", hashes[h].name);
+	}
+	printf("\n");
+
+	static const char *sets[] = {"components", "asset paths", "loc keys", "entity ids"};
+	for (unsigned s = 0; s < sizeof(sets) / sizeof(sets[0]); ++s) {
+		KeySet set = make_set(sets[s], n);
+		printf("%-12s", sets[s]);
+		for (unsigned h = 0; h < HASH_COUNT; ++h) {
+			double	 chi;
+			unsigned max_load;
+			distribution(&hashes[h], &set, buckets, &chi, &max_load);
+			printf(" %9.2f %4u", chi, max_load);
+		}
+		printf("\n");
+		free(set.keys);
+		free(set.lens);
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Compares the chained and flat HtTable modes on string keys.
+//
+// usage: bench_hashtable [max_entries]
+
+#include "bench_common.h"
+#include "hashtable/hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KEY_SIZE 24
+
+typedef struct {
+	double insert_ns;
+	double hit_ns;
+	double miss_ns;
+	double delete_ns;
+} Timings;
+
+static void make_keys(char (*keys)[KEY_SIZE], unsigned n, const char *prefix, uint64_t seed) {
+	for (unsigned i = 0; i < n; ++i) {
+		snprintf(keys[i], KEY_SIZE, "%s_%u", prefix, i);
+	}
+	// Shuffle so lookups do not follow insertion order
+	for (unsigned i = n - 1; i > 0; --i) {
+		unsigned j = (unsigned) (bench_rand(&seed) % (i + 1));
+		char	 tmp[KEY_SIZE];
+		memcpy(tmp, keys[i], KEY_SIZE);
+		memcpy(keys[i], keys[j], KEY_SIZE);
+		memcpy(keys[j], tmp, KEY_SIZE);
+	}
+}
+
+static Timings run(HtMode mode, char (*keys)[KEY_SIZE], char (*misses)[KEY_SIZE], unsigned n) {
+	HtTable tab;
+	Timings t;
+
+	if (mode == HT_MODE_FLAT) {
+		ht_init_table_flat(&tab, 16);
+	} else {
+		ht_init_table(&tab, n); // One bucket per key, so chained inserts never rehash
+	}
+
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < n; ++i) {
+		ht_emplace(&tab, keys[i], keys[i]);
+	}
+	t.insert_ns = (double) (bench_now_ns() - start) / n;
+
+	start = bench_now_ns();
+	for (unsigned i = 0; i < n; ++i) {
+		bench_consume(ht_search(&tab, keys[n - 1 - i]));
+	}
+	t.hit_ns = (double) (bench_now_ns() - start) / n;
+
+	start = bench_now_ns();
+	for (unsigned i = 0; i < n; ++i) {
+		bench_consume(ht_search(&tab, misses[i]));
+	}
+	t.miss_ns = (double) (bench_now_ns() - start) / n;
+
+	start = bench_now_ns();
+	for (unsigned i = 0; i < n; ++i) {
+		ht_delete(&tab, keys[i]);
+	}
+	t.delete_ns = (double) (bench_now_ns() - start) / n;
+
+	ht_deinit_table(&tab);
+	return t;
+}
+
+int main(int argc, char **argv) {
+	unsigned max_n = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 1u << 20;
+
+	printf("%-10s %-8s %10s %10s %10s %10s\n", "entries", "mode", "insert", "hit", "miss", "delete");
+	for (unsigned n = 1024; n <= max_n; n *= 8) {
+		char(*keys)[KEY_SIZE] = malloc((size_t) n * KEY_SIZE);
+		char(*misses)[KEY_SIZE] = malloc((size_t) n * KEY_SIZE);
+		make_keys(keys, n, "entity", 1);
+		make_keys(misses, n, "absent", 2);
+
+		Timings chained = run(HT_MODE_CHAINED, keys, misses, n);
+		Timings flat = run(HT_MODE_FLAT, keys, misses, n);
+
+		printf("%-10u %-8s %8.1fns %8.1fns %8.1fns %8.1fns\n", n, "chained", chained.insert_ns, chained.hit_ns,
+			   chained.miss_ns, chained.delete_ns);
+		printf("%-10u %-8s %8.1fns %8.1fns %8.1fns %8.1fns\n", n, "flat", flat.insert_ns, flat.hit_ns, flat.miss_ns,
+			   flat.delete_ns);
+		printf("%-10u %-8s %9.2fx %9.2fx %9.2fx %9.2fx\n", n, "speedup", chained.insert_ns / flat.insert_ns,
+			   chained.hit_ns / flat.hit_ns, chained.miss_ns / flat.miss_ns, chained.delete_ns / flat.delete_ns);
+
+		free(keys);
+		free(misses);
+	}
+	return 0;
+}
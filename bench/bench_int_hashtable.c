@@ -0,0 +1,91 @@
+// Compares integer-key lookups of DEF_HASHTABLE with identity hashing against
+// DEF_INT_HASHTABLE (single and batched), for sequential and strided IDs.
+//
+// usage: bench_int_hashtable [max_entries]
+
+#include "bench_common.h"
+#include "hashtable/hashtable2.h"
+#include "hashtable/int_hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOOKUPS (1u << 20)
+#define BATCH	256
+
+size_t IdTable_hash_key(uint32_t key) {
+	return (size_t) key;
+}
+
+DEF_HASHTABLE(uint32_t, uint32_t, IdTable)
+DEF_INT_HASHTABLE(uint32_t, uint32_t, IdMap, UINT32_MAX)
+
+static double run_def(const uint32_t *ids, const uint32_t *lookups, unsigned n) {
+	IdTable tab;
+	IdTable_init(&tab, n);
+	for (unsigned i = 0; i < n; ++i) {
+		IdTable_insert(&tab, ids[i], i);
+	}
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(IdTable_get(&tab, lookups[i]));
+	}
+	double ns = (double) (bench_now_ns() - start) / LOOKUPS;
+	IdTable_deinit(&tab);
+	return ns;
+}
+
+static void run_int(const uint32_t *ids, const uint32_t *lookups, unsigned n, double *single_ns, double *batch_ns) {
+	IdMap map;
+	IdMap_init(&map, n);
+	for (unsigned i = 0; i < n; ++i) {
+		IdMap_insert(&map, ids[i], i);
+	}
+	uint64_t start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; ++i) {
+		bench_consume(IdMap_get(&map, lookups[i]));
+	}
+	*single_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+
+	uint32_t *values[BATCH];
+	start = bench_now_ns();
+	for (unsigned i = 0; i < LOOKUPS; i += BATCH) {
+		IdMap_get_batch(&map, lookups + i, BATCH, values);
+		bench_consume(values);
+	}
+	*batch_ns = (double) (bench_now_ns() - start) / LOOKUPS;
+	IdMap_deinit(&map);
+}
+
+int main(int argc, char **argv) {
+	unsigned max_n = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 10) : 1u << 22;
+	uint64_t seed = 1;
+
+	printf("%-10s %-8s %14s %12s %12s\n", "entries", "ids", "DEF_HASHTABLE", "int single", "int batch");
+	for (unsigned n = 1u << 12; n <= max_n; n *= 4) {
+		uint32_t *ids = malloc(sizeof(uint32_t) * n);
+		uint32_t *lookups = malloc(sizeof(uint32_t) * LOOKUPS);
+		for (int strided = 0; strided < 2; ++strided) {
+			// Strided IDs all share their low bits: the identity hash puts them in a few buckets
+			for (unsigned i = 0; i < n; ++i) {
+				ids[i] = strided ? i * 1024 : i;
+			}
+			for (unsigned i = 0; i < LOOKUPS; ++i) {
+				lookups[i] = ids[bench_rand(&seed) % n];
+			}
+			// Chains of n / 4 entries under strided IDs make large tables take minutes
+			double def_ns = strided && n > (1u << 14) ? 0 : run_def(ids, lookups, n);
+			double single_ns, batch_ns;
+			run_int(ids, lookups, n, &single_ns, &batch_ns);
+			printf("%-10u %-8s ", n, strided ? "strided" : "dense");
+			if (def_ns > 0) {
+				printf("%12.1fns", def_ns);
+			} else {
+				printf("%14s", "skipped");
+			}
+			printf(" %10.1fns %10.1fns\n", single_ns, batch_ns);
+		}
+		free(ids);
+		free(lookups);
+	}
+	return 0;
+}
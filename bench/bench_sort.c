@@ -0,0 +1,110 @@
+// Compares qsort with the generated DEF_VECTOR_SORT and the serial and
+// parallel radix sorts, on 64-bit keys and on 64-bit key/value pairs.
+//
+// usage: bench_sort [max_elements] [threads]
+
+#include "bench_common.h"
+#include "vector/radix_sort.h"
+#include "vector/vector.h"
+#include "vector/vector_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define U64_LESS(a, b)	(*(a) < *(b))
+#define PAIR_LESS(a, b) ((a)->key < (b)->key)
+
+DEF_VECTOR(uint64_t, KeyVec)
+DEF_VECTOR_SORT(uint64_t, KeyVec, U64_LESS)
+DEF_VECTOR(RadixPair64, PairVec)
+DEF_VECTOR_SORT(RadixPair64, PairVec, PAIR_LESS)
+
+static int cmp_u64(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+	return (x > y) - (x < y);
+}
+
+static int cmp_pair(const void *a, const void *b) {
+	uint64_t x = ((const RadixPair64 *) a)->key, y = ((const RadixPair64 *) b)->key;
+	return (x > y) - (x < y);
+}
+
+// Milliseconds to sort a fresh copy of `input` with the sort selected by `which`
+static double time_keys(const uint64_t *input, size_t n, int which, unsigned threads) {
+	uint64_t *data = malloc(n * sizeof(uint64_t));
+	memcpy(data, input, n * sizeof(uint64_t));
+	uint64_t start = bench_now_ns();
+	switch (which) {
+	case 0:
+		qsort(data, n, sizeof(uint64_t), cmp_u64);
+		break;
+	case 1:
+		KeyVec_sort_range(data, n);
+		break;
+	case 2:
+		radix_sort_u64(data, n);
+		break;
+	default:
+		radix_sort_u64_parallel(data, n, threads);
+		break;
+	}
+	double ms = (double) (bench_now_ns() - start) / 1e6;
+	bench_consume(data);
+	free(data);
+	return ms;
+}
+
+static double time_pairs(const RadixPair64 *input, size_t n, int which, unsigned threads) {
+	RadixPair64 *data = malloc(n * sizeof(RadixPair64));
+	memcpy(data, input, n * sizeof(RadixPair64));
+	uint64_t start = bench_now_ns();
+	switch (which) {
+	case 0:
+		qsort(data, n, sizeof(RadixPair64), cmp_pair);
+		break;
+	case 1:
+		PairVec_sort_range(data, n);
+		break;
+	case 2:
+		radix_sort_pairs64(data, n);
+		break;
+	default:
+		radix_sort_pairs64_parallel(data, n, threads);
+		break;
+	}
+	double ms = (double) (bench_now_ns() - start) / 1e6;
+	bench_consume(data);
+	free(data);
+	return ms;
+}
+
+int main(int argc, char **argv) {
+	size_t	 max_n = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 10000000;
+	unsigned threads = argc > 2 ? (unsigned) strtoul(argv[2], NULL, 10) : 0;
+	uint64_t seed = 1;
+
+	uint64_t	*keys = malloc(max_n * sizeof(uint64_t));
+	RadixPair64 *pairs = malloc(max_n * sizeof(RadixPair64));
+	for (size_t i = 0; i < max_n; ++i) {
+		keys[i] = bench_rand(&seed);
+		pairs[i].key = keys[i];
+		pairs[i].value = i;
+	}
+
+	printf("%-6s %10s %10s %10s %10s %10s  (ms)\n", "data", "elements", "qsort", "_sort", "radix", "parallel");
+	for (size_t n = 1000; n <= max_n; n *= 10) {
+		printf("%-6s %10zu", "u64", n);
+		for (int which = 0; which < 4; ++which) {
+			printf(" %10.2f", time_keys(keys, n, which, threads));
+		}
+		printf("\n%-6s %10zu", "pairs", n);
+		for (int which = 0; which < 4; ++which) {
+			printf(" %10.2f", time_pairs(pairs, n, which, threads));
+		}
+		printf("\n");
+	}
+
+	free(keys);
+	free(pairs);
+	return 0;
+}
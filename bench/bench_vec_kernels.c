@@ -0,0 +1,238 @@
+// Compares the vec_kernels functions at each SIMD level against the plain
+// loops they replace, on an L1-sized and a memory-sized array.
+//
+// usage: bench_vec_kernels [large_n]
+
+#include "bench_common.h"
+#include "vector/vec_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Inputs and outputs shared by every case
+typedef struct BenchData {
+	float	*f;
+	float	*g;
+	float	*out;
+	int32_t *i;
+	int32_t *iout;
+	uint8_t *mask;
+	size_t	 n;
+} BenchData;
+
+typedef void (*BenchFn)(BenchData *d);
+
+/* Plain loops, as written without the kernels */
+
+static void loop_find(BenchData *d) {
+	size_t k = 0;
+	while (k < d->n && d->i[k] != -5000) {
+		++k;
+	}
+	bench_consume(&k);
+}
+
+static void loop_count(BenchData *d) {
+	size_t count = 0;
+	for (size_t k = 0; k < d->n; ++k) {
+		count += d->i[k] == 7;
+	}
+	bench_consume(&count);
+}
+
+static void loop_min(BenchData *d) {
+	float min = d->f[0];
+	for (size_t k = 1; k < d->n; ++k) {
+		min = d->f[k] < min ? d->f[k] : min;
+	}
+	bench_consume(&min);
+}
+
+static void loop_argmin(BenchData *d) {
+	size_t best = 0;
+	for (size_t k = 1; k < d->n; ++k) {
+		best = d->f[k] < d->f[best] ? k : best;
+	}
+	bench_consume(&best);
+}
+
+static void loop_sum(BenchData *d) {
+	float sum = 0.0f;
+	for (size_t k = 0; k < d->n; ++k) {
+		sum += d->f[k];
+	}
+	bench_consume(&sum);
+}
+
+static void loop_dot(BenchData *d) {
+	float sum = 0.0f;
+	for (size_t k = 0; k < d->n; ++k) {
+		sum += d->f[k] * d->g[k];
+	}
+	bench_consume(&sum);
+}
+
+static void loop_fill(BenchData *d) {
+	for (size_t k = 0; k < d->n; ++k) {
+		d->out[k] = 1.5f;
+	}
+	bench_consume(d->out);
+}
+
+static void loop_clamp(BenchData *d) {
+	for (size_t k = 0; k < d->n; ++k) {
+		float x = d->f[k] < -0.5f ? -0.5f : d->f[k];
+		d->out[k] = x > 0.5f ? 0.5f : x;
+	}
+	bench_consume(d->out);
+}
+
+static void loop_compact(BenchData *d) {
+	size_t kept = 0;
+	for (size_t k = 0; k < d->n; ++k) {
+		if (d->mask[k]) {
+			d->iout[kept++] = d->i[k];
+		}
+	}
+	bench_consume(&kept);
+}
+
+static void loop_prefix(BenchData *d) {
+	int32_t sum = 0;
+	for (size_t k = 0; k < d->n; ++k) {
+		sum += d->i[k];
+		d->iout[k] = sum;
+	}
+	bench_consume(d->iout);
+}
+
+/* The same work through the kernels */
+
+static void kern_find(BenchData *d) {
+	size_t k = vec_find_i32(d->i, d->n, -5000);
+	bench_consume(&k);
+}
+
+static void kern_count(BenchData *d) {
+	size_t count = vec_count_i32(d->i, d->n, 7);
+	bench_consume(&count);
+}
+
+static void kern_min(BenchData *d) {
+	float min = vec_min_f32(d->f, d->n);
+	bench_consume(&min);
+}
+
+static void kern_argmin(BenchData *d) {
+	size_t best = vec_argmin_f32(d->f, d->n);
+	bench_consume(&best);
+}
+
+static void kern_sum(BenchData *d) {
+	float sum = vec_sum_f32(d->f, d->n);
+	bench_consume(&sum);
+}
+
+static void kern_dot(BenchData *d) {
+	float sum = vec_dot_f32(d->f, d->g, d->n);
+	bench_consume(&sum);
+}
+
+static void kern_fill(BenchData *d) {
+	vec_fill_f32(d->out, d->n, 1.5f);
+	bench_consume(d->out);
+}
+
+// The kernel clamps in place, so clamp a copy as the loop does
+static void kern_clamp(BenchData *d) {
+	memcpy(d->out, d->f, d->n * sizeof(float));
+	vec_clamp_f32(d->out, d->n, -0.5f, 0.5f);
+	bench_consume(d->out);
+}
+
+static void kern_compact(BenchData *d) {
+	size_t kept = vec_compact_i32(d->iout, d->i, d->mask, d->n);
+	bench_consume(&kept);
+}
+
+static void kern_prefix(BenchData *d) {
+	vec_prefix_sum_i32(d->iout, d->i, d->n);
+	bench_consume(d->iout);
+}
+
+static const struct {
+	const char *name;
+	BenchFn		loop;
+	BenchFn		kernel;
+} cases[] = {
+	{"find_i32", loop_find, kern_find},			 {"count_i32", loop_count, kern_count},
+	{"min_f32", loop_min, kern_min},			 {"argmin_f32", loop_argmin, kern_argmin},
+	{"sum_f32", loop_sum, kern_sum},			 {"dot_f32", loop_dot, kern_dot},
+	{"fill_f32", loop_fill, kern_fill},			 {"clamp_f32", loop_clamp, kern_clamp},
+	{"compact_i32", loop_compact, kern_compact}, {"prefix_sum_i32", loop_prefix, kern_prefix},
+};
+
+// Nanoseconds per element, best of a few rounds of about 16M elements each
+static double time_case(BenchFn fn, BenchData *d) {
+	size_t reps = ((size_t) 1 << 24) / d->n + 1;
+	double best = 0;
+	for (int round = 0; round < 3; ++round) {
+		uint64_t start = bench_now_ns();
+		for (size_t r = 0; r < reps; ++r) {
+			fn(d);
+		}
+		double ns = (double) (bench_now_ns() - start) / ((double) reps * d->n);
+		best = round == 0 || ns < best ? ns : best;
+	}
+	return best;
+}
+
+int main(int argc, char **argv) {
+	size_t large_n = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : (size_t) 1 << 22;
+	size_t sizes[2] = {4096, large_n};
+	uint64_t seed = 1;
+
+	BenchData d;
+	d.f = malloc(large_n * sizeof(float));
+	d.g = malloc(large_n * sizeof(float));
+	d.out = malloc(large_n * sizeof(float));
+	d.i = malloc(large_n * sizeof(int32_t));
+	d.iout = malloc(large_n * sizeof(int32_t));
+	d.mask = malloc(large_n);
+	for (size_t k = 0; k < large_n; ++k) {
+		d.f[k] = (float) (bench_rand(&seed) % 20001) / 10000.0f - 1.0f;
+		d.g[k] = (float) (bench_rand(&seed) % 20001) / 10000.0f - 1.0f;
+		d.i[k] = (int32_t) (bench_rand(&seed) % 1000);
+		d.mask[k] = (uint8_t) (bench_rand(&seed) & 1);
+	}
+	// Fault the output pages in before timing
+	memset(d.out, 0, large_n * sizeof(float));
+	memset(d.iout, 0, large_n * sizeof(int32_t));
+
+	VecSimdLevel best = vec_simd_detect();
+	printf("widest SIMD level: %s\n", best == VEC_SIMD_AVX2 ? "AVX2" : best == VEC_SIMD_SSE2 ? "SSE2" : "scalar");
+	printf("%-16s %10s %10s %10s %10s %10s  (ns/element)\n", "kernel", "elements", "loop", "scalar", "sse2", "avx2");
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+		for (int s = 0; s < 2; ++s) {
+			d.n = sizes[s];
+			printf("%-16s %10zu %10.3f", cases[c].name, d.n, time_case(cases[c].loop, &d));
+			for (int level = VEC_SIMD_SCALAR; level <= VEC_SIMD_AVX2; ++level) {
+				if (level > (int) best) {
+					printf(" %10s", "-");
+					continue;
+				}
+				vec_simd_set_level((VecSimdLevel) level);
+				printf(" %10.3f", time_case(cases[c].kernel, &d));
+			}
+			printf("\n");
+		}
+	}
+
+	free(d.f);
+	free(d.g);
+	free(d.out);
+	free(d.i);
+	free(d.iout);
+	free(d.mask);
+	return 0;
+}
@@ -0,0 +1,90 @@
+// Compares lower-bound searches on a sorted array of random 32-bit keys:
+// bsearch, a plain binary search generated for the element type, and the
+// branchless prefetching search of DEF_VECTOR_EYTZINGER over the same keys in
+// Eytzinger layout. Probes are random, so large arrays miss the cache.
+//
+// usage: bench_vector_eytzinger [max_keys]
+
+#include "bench_common.h"
+#include "vector/vector.h"
+#include "vector/vector_eytzinger.h"
+#include "vector/vector_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define U32_LESS(a, b) (*(a) < *(b))
+
+DEF_VECTOR(uint32_t, KeyVec)
+DEF_VECTOR_SORT(uint32_t, KeyVec, U32_LESS)
+DEF_VECTOR_EYTZINGER(uint32_t, KeyVec, U32_LESS)
+
+static int cmp_u32(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+// Index of the first key not less than key
+static size_t binary_lower_bound(const uint32_t *data, size_t n, uint32_t key) {
+	size_t lo = 0;
+	while (n > 0) {
+		size_t half = n / 2;
+		if (data[lo + half] < key) {
+			lo += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return lo;
+}
+
+static double ns_per(uint64_t start, size_t n) {
+	return (double) (bench_now_ns() - start) / (double) n;
+}
+
+int main(int argc, char **argv) {
+	size_t	 max_n = argc > 1 ? (size_t) strtoull(argv[1], NULL, 10) : 10000000;
+	size_t	 probe_n = 2000000;
+	uint64_t seed = 1;
+
+	uint32_t *probes = malloc(probe_n * sizeof(uint32_t));
+	printf("%10s %10s %10s %10s  (ns per lookup)\n", "keys", "bsearch", "binary", "eytzinger");
+	for (size_t n = 1000; n <= max_n; n *= 10) {
+		KeyVec sorted, eytz;
+		KeyVec_init(&sorted, n);
+		KeyVec_init(&eytz, n);
+		for (size_t i = 0; i < n; ++i)
+			KeyVec_push_back(&sorted, (uint32_t) bench_rand(&seed) | 1); // odd keys, so even probes miss
+		KeyVec_sort(&sorted);
+		KeyVec_append_n(&eytz, VEC_SPAN(&sorted));
+		KeyVec_eytzinger_layout(&eytz);
+		for (size_t i = 0; i < probe_n; ++i)
+			probes[i] = i % 2 ? sorted.data[bench_rand(&seed) % n] : (uint32_t) bench_rand(&seed) & ~1u;
+
+		// bsearch only finds exact matches, so it is timed on the hits alone
+		uint64_t sum = 0;
+		uint64_t start = bench_now_ns();
+		for (size_t i = 1; i < probe_n; i += 2)
+			sum += *(const uint32_t *) bsearch(&probes[i], sorted.data, n, sizeof(uint32_t), cmp_u32);
+		double bsearch_ns = ns_per(start, probe_n / 2);
+
+		start = bench_now_ns();
+		for (size_t i = 0; i < probe_n; ++i)
+			sum += binary_lower_bound(VEC_SPAN(&sorted), probes[i]);
+		double binary_ns = ns_per(start, probe_n);
+
+		start = bench_now_ns();
+		for (size_t i = 0; i < probe_n; ++i)
+			sum += KeyVec_eytzinger_lower_bound(VEC_SPAN(&eytz), &probes[i]);
+		double eytz_ns = ns_per(start, probe_n);
+
+		printf("%10zu %10.1f %10.1f %10.1f\n", n, bsearch_ns, binary_ns, eytz_ns);
+		bench_consume(&sum);
+		KeyVec_deinit(&sorted);
+		KeyVec_deinit(&eytz);
+	}
+
+	free(probes);
+	return 0;
+}
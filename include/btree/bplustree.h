@@ -0,0 +1,470 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*  Generic B+-tree macro
+ *
+ *  Usage:
+ *      DEF_BPLUSTREE(uint64_t, Event *, Timeline)
+ *
+ *  Generates:
+ *      typedef struct Timeline { ...; size_t count; size_t height; } Timeline;
+ *      void      Timeline_init(Timeline *tree);
+ *      void      Timeline_deinit(Timeline *tree);
+ *      int       Timeline_insert(Timeline *tree, uint64_t key, Event *value);
+ *      int       Timeline_erase(Timeline *tree, uint64_t key);
+ *      Event   **Timeline_find(const Timeline *tree, uint64_t key);
+ *      Timeline_cursor Timeline_begin(const Timeline *tree);
+ *      Timeline_cursor Timeline_lower_bound(const Timeline *tree, uint64_t key);
+ *      int       Timeline_cursor_valid(const Timeline_cursor *cursor);
+ *      uint64_t  Timeline_cursor_key(const Timeline_cursor *cursor);
+ *      Event   **Timeline_cursor_value(const Timeline_cursor *cursor);
+ *      void      Timeline_cursor_next(Timeline_cursor *cursor);
+ *
+ *  A map from unique keys to values. Every node holds a sorted array of up
+ *  to BPLUSTREE_KEY_BYTES / sizeof(KEY_T) keys, one or a few cache lines,
+ *  so a lookup touches a handful of nodes instead of one per level of a
+ *  binary tree. Node search compares the key against the whole array with
+ *  a branchless, fixed-length loop that compilers turn into SIMD compares.
+ *  Values live only in the leaves, which are linked in key order, so
+ *  in-order scans walk arrays.
+ *
+ *  KEY_T must be an integer or floating-point type (ordered with <, no
+ *  NaNs). _insert adds the key or replaces its value and returns 0 only if
+ *  a node could not be allocated, in which case the tree is unchanged.
+ *  _erase returns 1 if the key was present. Nodes are kept at least half
+ *  full, and the tree frees and allocates them itself; _insert and _erase
+ *  invalidate cursors and pointers to values.
+ */
+
+// Bytes of keys per node; define before including to change it
+#ifndef BPLUSTREE_KEY_BYTES
+#define BPLUSTREE_KEY_BYTES 128
+#endif
+
+// Node alignment, one cache line
+#define BPLUSTREE_ALIGN 64
+
+// Deepest tree _insert handles; nodes but the root have at least 3 children, so 48 levels hold over 2^64 keys
+#define BPLUSTREE_MAX_HEIGHT 48
+
+#define DEF_BPLUSTREE(KEY_T, VAL_T, TREE_T)                                                                            \
+	enum { TREE_T##_fanout = BPLUSTREE_KEY_BYTES / sizeof(KEY_T) }; /* most keys per node */                           \
+	enum { TREE_T##_min_keys = TREE_T##_fanout / 2 };				/* fewest keys per node but the root */            \
+                                                                                                                       \
+	_Static_assert(TREE_T##_fanout >= 4, "BPLUSTREE_KEY_BYTES too small");                                             \
+                                                                                                                       \
+	/* fields shared by inner nodes and leaves, which begin with it */                                                 \
+	typedef struct TREE_T##_node {                                                                                     \
+		KEY_T	 keys[TREE_T##_fanout];                                                                                \
+		uint32_t count; /* keys in use */                                                                              \
+		uint32_t leaf;                                                                                                 \
+	} TREE_T##_node;                                                                                                   \
+                                                                                                                       \
+	/* inner node: keys in children[i] < keys[i] <= keys in children[i + 1] */                                         \
+	typedef struct TREE_T##_inner {                                                                                    \
+		TREE_T##_node  node;                                                                                           \
+		TREE_T##_node *children[TREE_T##_fanout + 1];                                                                  \
+	} TREE_T##_inner;                                                                                                  \
+                                                                                                                       \
+	typedef struct TREE_T##_leaf {                                                                                     \
+		TREE_T##_node		  node;                                                                                    \
+		struct TREE_T##_leaf *prev; /* neighbours in key order */                                                      \
+		struct TREE_T##_leaf *next;                                                                                    \
+		VAL_T				  values[TREE_T##_fanout];                                                                 \
+	} TREE_T##_leaf;                                                                                                   \
+                                                                                                                       \
+	typedef struct TREE_T {                                                                                            \
+		TREE_T##_node *root;                                                                                           \
+		TREE_T##_leaf *first; /* leaf with the smallest keys */                                                        \
+		TREE_T##_leaf *last;                                                                                           \
+		size_t		   count;                                                                                          \
+		size_t		   height; /* levels, 0 when empty */                                                              \
+	} TREE_T;                                                                                                          \
+                                                                                                                       \
+	/* position of an entry: a leaf and a slot in it; leaf is NULL past the end */                                     \
+	typedef struct {                                                                                                   \
+		TREE_T##_leaf *leaf;                                                                                           \
+		uint32_t	   index;                                                                                          \
+	} TREE_T##_cursor;                                                                                                 \
+                                                                                                                       \
+	/* number of keys in node less than key; the slot of key in a leaf */                                              \
+	static inline uint32_t TREE_T##_rank_lower(const TREE_T##_node *node, KEY_T key) {                                 \
+		uint32_t rank = 0;                                                                                             \
+		for (uint32_t i = 0; i < TREE_T##_fanout; ++i)                                                                 \
+			rank += (i < node->count) & (node->keys[i] < key);                                                         \
+		return rank;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* number of keys in node not greater than key; the child of an inner node to descend into */                      \
+	static inline uint32_t TREE_T##_rank_upper(const TREE_T##_node *node, KEY_T key) {                                 \
+		uint32_t rank = 0;                                                                                             \
+		for (uint32_t i = 0; i < TREE_T##_fanout; ++i)                                                                 \
+			rank += (i < node->count) & (node->keys[i] <= key);                                                        \
+		return rank;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline TREE_T##_inner *TREE_T##_as_inner(TREE_T##_node *node) {                                             \
+		return (TREE_T##_inner *) node;                                                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline TREE_T##_leaf *TREE_T##_as_leaf(TREE_T##_node *node) {                                               \
+		return (TREE_T##_leaf *) node;                                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline TREE_T##_node *TREE_T##_alloc_node(size_t bytes, uint32_t leaf) {                                    \
+		size_t		   size = (bytes + BPLUSTREE_ALIGN - 1) / BPLUSTREE_ALIGN * BPLUSTREE_ALIGN;                       \
+		TREE_T##_node *node = (TREE_T##_node *) aligned_alloc(BPLUSTREE_ALIGN, size);                                  \
+		if (node) {                                                                                                    \
+			memset(node, 0, sizeof(TREE_T##_node)); /* the key search reads unused slots too */                        \
+			node->leaf = leaf;                                                                                         \
+		}                                                                                                              \
+		return node;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* initialise */                                                                                                   \
+	static inline void TREE_T##_init(TREE_T *tree) {                                                                   \
+		tree->root = NULL;                                                                                             \
+		tree->first = tree->last = NULL;                                                                               \
+		tree->count = tree->height = 0;                                                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TREE_T##_free_node(TREE_T##_node *node) {                                                       \
+		if (!node->leaf) {                                                                                             \
+			for (uint32_t i = 0; i <= node->count; ++i)                                                                \
+				TREE_T##_free_node(TREE_T##_as_inner(node)->children[i]);                                              \
+		}                                                                                                              \
+		free(node);                                                                                                    \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* de‑initialise: free every node */                                                                               \
+	static inline void TREE_T##_deinit(TREE_T *tree) {                                                                 \
+		if (tree->root)                                                                                                \
+			TREE_T##_free_node(tree->root);                                                                            \
+		TREE_T##_init(tree);                                                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* leaf that holds key if it is present, or NULL for an empty tree */                                              \
+	static inline TREE_T##_leaf *TREE_T##_find_leaf(const TREE_T *tree, KEY_T key) {                                   \
+		TREE_T##_node *node = tree->root;                                                                              \
+		if (!node)                                                                                                     \
+			return NULL;                                                                                               \
+		while (!node->leaf)                                                                                            \
+			node = TREE_T##_as_inner(node)->children[TREE_T##_rank_upper(node, key)];                                  \
+		return TREE_T##_as_leaf(node);                                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* find – the value stored under key, or NULL */                                                                   \
+	static inline VAL_T *TREE_T##_find(const TREE_T *tree, KEY_T key) {                                                \
+		TREE_T##_leaf *leaf = TREE_T##_find_leaf(tree, key);                                                           \
+		if (!leaf)                                                                                                     \
+			return NULL;                                                                                               \
+		uint32_t i = TREE_T##_rank_lower(&leaf->node, key);                                                            \
+		return i < leaf->node.count && leaf->node.keys[i] == key ? &leaf->values[i] : NULL;                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* begin – cursor at the smallest key */                                                                           \
+	static inline TREE_T##_cursor TREE_T##_begin(const TREE_T *tree) {                                                 \
+		TREE_T##_cursor cursor = {tree->first, 0};                                                                     \
+		return cursor;                                                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* lower_bound – cursor at the first key not less than key */                                                      \
+	static inline TREE_T##_cursor TREE_T##_lower_bound(const TREE_T *tree, KEY_T key) {                                \
+		TREE_T##_cursor cursor = {TREE_T##_find_leaf(tree, key), 0};                                                   \
+		if (cursor.leaf) {                                                                                             \
+			cursor.index = TREE_T##_rank_lower(&cursor.leaf->node, key);                                               \
+			if (cursor.index == cursor.leaf->node.count) {                                                             \
+				cursor.leaf = cursor.leaf->next;                                                                       \
+				cursor.index = 0;                                                                                      \
+			}                                                                                                          \
+		}                                                                                                              \
+		return cursor;                                                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline int TREE_T##_cursor_valid(const TREE_T##_cursor *cursor) {                                           \
+		return cursor->leaf != NULL;                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline KEY_T TREE_T##_cursor_key(const TREE_T##_cursor *cursor) {                                           \
+		return cursor->leaf->node.keys[cursor->index];                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline VAL_T *TREE_T##_cursor_value(const TREE_T##_cursor *cursor) {                                        \
+		return &cursor->leaf->values[cursor->index];                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TREE_T##_cursor_next(TREE_T##_cursor *cursor) {                                                 \
+		if (++cursor->index == cursor->leaf->node.count) {                                                             \
+			cursor->leaf = cursor->leaf->next;                                                                         \
+			cursor->index = 0;                                                                                         \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* put key and value into slot i of a leaf with room */                                                            \
+	static inline void TREE_T##_leaf_put(TREE_T##_leaf *leaf, uint32_t i, KEY_T key, VAL_T value) {                    \
+		uint32_t tail = leaf->node.count - i;                                                                          \
+		memmove(&leaf->node.keys[i + 1], &leaf->node.keys[i], tail * sizeof(KEY_T));                                   \
+		memmove(&leaf->values[i + 1], &leaf->values[i], tail * sizeof(VAL_T));                                         \
+		leaf->node.keys[i] = key;                                                                                      \
+		leaf->values[i] = value;                                                                                       \
+		++leaf->node.count;                                                                                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* put key and value into slot i of a full leaf, moving the upper half into the empty leaf right */                \
+	static inline void TREE_T##_split_leaf(TREE_T *tree, TREE_T##_leaf *leaf, uint32_t i, KEY_T key, VAL_T value,      \
+										   TREE_T##_leaf *right) {                                                     \
+		/* split the fanout + 1 entries evenly, then insert into the half that holds slot i */                         \
+		uint32_t half = (TREE_T##_fanout + 1) / 2;                                                                     \
+		int		 to_right = i >= half;                                                                                 \
+		uint32_t from = to_right ? half : half - 1;                                                                    \
+		uint32_t moved = TREE_T##_fanout - from;                                                                       \
+		memcpy(right->node.keys, &leaf->node.keys[from], moved * sizeof(KEY_T));                                       \
+		memcpy(right->values, &leaf->values[from], moved * sizeof(VAL_T));                                             \
+		right->node.count = moved;                                                                                     \
+		leaf->node.count = from;                                                                                       \
+		right->prev = leaf;                                                                                            \
+		right->next = leaf->next;                                                                                      \
+		if (leaf->next)                                                                                                \
+			leaf->next->prev = right;                                                                                  \
+		else                                                                                                           \
+			tree->last = right;                                                                                        \
+		leaf->next = right;                                                                                            \
+		if (to_right)                                                                                                  \
+			TREE_T##_leaf_put(right, i - from, key, value);                                                            \
+		else                                                                                                           \
+			TREE_T##_leaf_put(leaf, i, key, value);                                                                    \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* put key and the child right of it after children[c] of an inner node with room */                               \
+	static inline void TREE_T##_inner_put(TREE_T##_inner *inner, uint32_t c, KEY_T key, TREE_T##_node *child) {        \
+		uint32_t tail = inner->node.count - c;                                                                         \
+		memmove(&inner->node.keys[c + 1], &inner->node.keys[c], tail * sizeof(KEY_T));                                 \
+		memmove(&inner->children[c + 2], &inner->children[c + 1], tail * sizeof(TREE_T##_node *));                     \
+		inner->node.keys[c] = key;                                                                                     \
+		inner->children[c + 1] = child;                                                                                \
+		++inner->node.count;                                                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* the same for a full inner node: keep the lower half, move the upper half into the empty node right and          \
+	 * return the middle key, which moves up */                                                                        \
+	static inline KEY_T TREE_T##_split_inner(TREE_T##_inner *inner, uint32_t c, KEY_T key, TREE_T##_node *child,       \
+											 TREE_T##_inner *right) {                                                  \
+		/* lay out the fanout + 1 keys in order */                                                                     \
+		KEY_T		   keys[TREE_T##_fanout + 1];                                                                      \
+		TREE_T##_node *children[TREE_T##_fanout + 2];                                                                  \
+		memcpy(keys, inner->node.keys, c * sizeof(KEY_T));                                                             \
+		keys[c] = key;                                                                                                 \
+		memcpy(&keys[c + 1], &inner->node.keys[c], (TREE_T##_fanout - c) * sizeof(KEY_T));                             \
+		memcpy(children, inner->children, (c + 1) * sizeof(TREE_T##_node *));                                          \
+		children[c + 1] = child;                                                                                       \
+		memcpy(&children[c + 2], &inner->children[c + 1], (TREE_T##_fanout - c) * sizeof(TREE_T##_node *));            \
+		uint32_t half = (TREE_T##_fanout + 1) / 2;                                                                     \
+		uint32_t right_keys = TREE_T##_fanout - half;                                                                  \
+		memcpy(inner->node.keys, keys, half * sizeof(KEY_T));                                                          \
+		memcpy(inner->children, children, (half + 1) * sizeof(TREE_T##_node *));                                       \
+		inner->node.count = half;                                                                                      \
+		memcpy(right->node.keys, &keys[half + 1], right_keys * sizeof(KEY_T));                                         \
+		memcpy(right->children, &children[half + 1], (right_keys + 1) * sizeof(TREE_T##_node *));                      \
+		right->node.count = right_keys;                                                                                \
+		return keys[half];                                                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* insert – add key with value, or replace the value of key; 0 if out of memory */                                 \
+	static inline int TREE_T##_insert(TREE_T *tree, KEY_T key, VAL_T value) {                                          \
+		if (!tree->root) {                                                                                             \
+			TREE_T##_leaf *leaf = TREE_T##_as_leaf(TREE_T##_alloc_node(sizeof(TREE_T##_leaf), 1));                     \
+			if (!leaf)                                                                                                 \
+				return 0;                                                                                              \
+			leaf->prev = leaf->next = NULL;                                                                            \
+			tree->root = &leaf->node;                                                                                  \
+			tree->first = tree->last = leaf;                                                                           \
+			tree->height = 1;                                                                                          \
+		}                                                                                                              \
+                                                                                                                       \
+		/* descend, remembering each inner node and the child taken from it */                                         \
+		TREE_T##_inner *path[BPLUSTREE_MAX_HEIGHT];                                                                    \
+		uint32_t		slots[BPLUSTREE_MAX_HEIGHT];                                                                   \
+		size_t			depth = 0;                                                                                     \
+		TREE_T##_node  *node = tree->root;                                                                             \
+		while (!node->leaf) {                                                                                          \
+			slots[depth] = TREE_T##_rank_upper(node, key);                                                             \
+			path[depth] = TREE_T##_as_inner(node);                                                                     \
+			node = path[depth]->children[slots[depth]];                                                                \
+			++depth;                                                                                                   \
+		}                                                                                                              \
+		TREE_T##_leaf *leaf = TREE_T##_as_leaf(node);                                                                  \
+		uint32_t	   i = TREE_T##_rank_lower(node, key);                                                             \
+		if (i < node->count && node->keys[i] == key) {                                                                 \
+			leaf->values[i] = value;                                                                                   \
+			return 1;                                                                                                  \
+		}                                                                                                              \
+		if (node->count < TREE_T##_fanout) {                                                                           \
+			TREE_T##_leaf_put(leaf, i, key, value);                                                                    \
+			++tree->count;                                                                                             \
+			return 1;                                                                                                  \
+		}                                                                                                              \
+                                                                                                                       \
+		/* the leaf splits, and so does each full inner node above it up to the first with room, or the root,          \
+		 * which then gets a new parent; allocate all of those nodes before changing anything */                       \
+		size_t splits = 0;                                                                                             \
+		while (splits < depth && path[depth - 1 - splits]->node.count == TREE_T##_fanout)                              \
+			++splits;                                                                                                  \
+		TREE_T##_node *fresh[BPLUSTREE_MAX_HEIGHT + 1];                                                                \
+		size_t		   needed = 1 + splits + (splits == depth);                                                        \
+		for (size_t n = 0; n < needed; ++n) {                                                                          \
+			fresh[n] = n == 0 ? TREE_T##_alloc_node(sizeof(TREE_T##_leaf), 1)                                          \
+							  : TREE_T##_alloc_node(sizeof(TREE_T##_inner), 0);                                        \
+			if (!fresh[n]) {                                                                                           \
+				while (n > 0)                                                                                          \
+					free(fresh[--n]);                                                                                  \
+				return 0;                                                                                              \
+			}                                                                                                          \
+		}                                                                                                              \
+                                                                                                                       \
+		TREE_T##_split_leaf(tree, leaf, i, key, value, TREE_T##_as_leaf(fresh[0]));                                    \
+		++tree->count;                                                                                                 \
+		KEY_T		   split_key = TREE_T##_as_leaf(fresh[0])->node.keys[0];                                           \
+		TREE_T##_node *split = fresh[0];                                                                               \
+		for (size_t n = 1; n <= splits; ++n) {                                                                         \
+			TREE_T##_inner *inner = path[depth - n];                                                                   \
+			split_key = TREE_T##_split_inner(inner, slots[depth - n], split_key, split, TREE_T##_as_inner(fresh[n]));  \
+			split = fresh[n];                                                                                          \
+		}                                                                                                              \
+		if (splits < depth) {                                                                                          \
+			TREE_T##_inner_put(path[depth - 1 - splits], slots[depth - 1 - splits], split_key, split);                 \
+		} else {                                                                                                       \
+			TREE_T##_inner *new_root = TREE_T##_as_inner(fresh[splits + 1]);                                           \
+			new_root->node.keys[0] = split_key;                                                                        \
+			new_root->node.count = 1;                                                                                  \
+			new_root->children[0] = tree->root;                                                                        \
+			new_root->children[1] = split;                                                                             \
+			tree->root = &new_root->node;                                                                              \
+			++tree->height;                                                                                            \
+		}                                                                                                              \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* merge children[i + 1] of parent into children[i] and drop it */                                                 \
+	static inline void TREE_T##_merge_children(TREE_T *tree, TREE_T##_inner *parent, uint32_t i) {                     \
+		TREE_T##_node *left = parent->children[i];                                                                     \
+		TREE_T##_node *right = parent->children[i + 1];                                                                \
+		if (left->leaf) {                                                                                              \
+			TREE_T##_leaf *left_leaf = TREE_T##_as_leaf(left);                                                         \
+			TREE_T##_leaf *right_leaf = TREE_T##_as_leaf(right);                                                       \
+			memcpy(&left->keys[left->count], right->keys, right->count * sizeof(KEY_T));                               \
+			memcpy(&left_leaf->values[left->count], right_leaf->values, right->count * sizeof(VAL_T));                 \
+			left_leaf->next = right_leaf->next;                                                                        \
+			if (right_leaf->next)                                                                                      \
+				right_leaf->next->prev = left_leaf;                                                                    \
+			else                                                                                                       \
+				tree->last = left_leaf;                                                                                \
+			left->count += right->count;                                                                               \
+		} else {                                                                                                       \
+			left->keys[left->count] = parent->node.keys[i];                                                            \
+			memcpy(&left->keys[left->count + 1], right->keys, right->count * sizeof(KEY_T));                           \
+			memcpy(&TREE_T##_as_inner(left)->children[left->count + 1], TREE_T##_as_inner(right)->children,            \
+				   (right->count + 1) * sizeof(TREE_T##_node *));                                                      \
+			left->count += right->count + 1;                                                                           \
+		}                                                                                                              \
+		uint32_t tail = parent->node.count - i - 1;                                                                    \
+		memmove(&parent->node.keys[i], &parent->node.keys[i + 1], tail * sizeof(KEY_T));                               \
+		memmove(&parent->children[i + 1], &parent->children[i + 2], tail * sizeof(TREE_T##_node *));                   \
+		--parent->node.count;                                                                                          \
+		free(right);                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* refill children[c] of parent, which fell below min_keys, from a sibling or by merging */                        \
+	static inline void TREE_T##_fix_child(TREE_T *tree, TREE_T##_inner *parent, uint32_t c) {                          \
+		TREE_T##_node *child = parent->children[c];                                                                    \
+		TREE_T##_node *left = c > 0 ? parent->children[c - 1] : NULL;                                                  \
+		TREE_T##_node *right = c < parent->node.count ? parent->children[c + 1] : NULL;                                \
+		if (left && left->count > TREE_T##_min_keys) {                                                                 \
+			/* rotate the left sibling's last entry in */                                                              \
+			memmove(&child->keys[1], child->keys, child->count * sizeof(KEY_T));                                       \
+			if (child->leaf) {                                                                                         \
+				TREE_T##_leaf *leaf = TREE_T##_as_leaf(child);                                                         \
+				memmove(&leaf->values[1], leaf->values, child->count * sizeof(VAL_T));                                 \
+				child->keys[0] = left->keys[left->count - 1];                                                          \
+				leaf->values[0] = TREE_T##_as_leaf(left)->values[left->count - 1];                                     \
+				parent->node.keys[c - 1] = child->keys[0];                                                             \
+			} else {                                                                                                   \
+				TREE_T##_inner *inner = TREE_T##_as_inner(child);                                                      \
+				memmove(&inner->children[1], inner->children, (child->count + 1) * sizeof(TREE_T##_node *));           \
+				child->keys[0] = parent->node.keys[c - 1];                                                             \
+				inner->children[0] = TREE_T##_as_inner(left)->children[left->count];                                   \
+				parent->node.keys[c - 1] = left->keys[left->count - 1];                                                \
+			}                                                                                                          \
+			--left->count;                                                                                             \
+			++child->count;                                                                                            \
+		} else if (right && right->count > TREE_T##_min_keys) {                                                        \
+			/* rotate the right sibling's first entry in */                                                            \
+			if (child->leaf) {                                                                                         \
+				TREE_T##_leaf *right_leaf = TREE_T##_as_leaf(right);                                                   \
+				child->keys[child->count] = right->keys[0];                                                            \
+				TREE_T##_as_leaf(child)->values[child->count] = right_leaf->values[0];                                 \
+				memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(KEY_T));                             \
+				memmove(right_leaf->values, &right_leaf->values[1], (right->count - 1) * sizeof(VAL_T));               \
+				parent->node.keys[c] = right->keys[0];                                                                 \
+			} else {                                                                                                   \
+				TREE_T##_inner *right_inner = TREE_T##_as_inner(right);                                                \
+				child->keys[child->count] = parent->node.keys[c];                                                      \
+				TREE_T##_as_inner(child)->children[child->count + 1] = right_inner->children[0];                       \
+				parent->node.keys[c] = right->keys[0];                                                                 \
+				memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(KEY_T));                             \
+				memmove(right_inner->children, &right_inner->children[1], right->count * sizeof(TREE_T##_node *));     \
+			}                                                                                                          \
+			--right->count;                                                                                            \
+			++child->count;                                                                                            \
+		} else if (left) {                                                                                             \
+			TREE_T##_merge_children(tree, parent, c - 1);                                                              \
+		} else {                                                                                                       \
+			TREE_T##_merge_children(tree, parent, c);                                                                  \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline int TREE_T##_erase_from(TREE_T *tree, TREE_T##_node *node, KEY_T key) {                              \
+		if (node->leaf) {                                                                                              \
+			TREE_T##_leaf *leaf = TREE_T##_as_leaf(node);                                                              \
+			uint32_t	   i = TREE_T##_rank_lower(node, key);                                                         \
+			if (i == node->count || node->keys[i] != key)                                                              \
+				return 0;                                                                                              \
+			uint32_t tail = node->count - i - 1;                                                                       \
+			memmove(&node->keys[i], &node->keys[i + 1], tail * sizeof(KEY_T));                                         \
+			memmove(&leaf->values[i], &leaf->values[i + 1], tail * sizeof(VAL_T));                                     \
+			--node->count;                                                                                             \
+			return 1;                                                                                                  \
+		}                                                                                                              \
+		uint32_t c = TREE_T##_rank_upper(node, key);                                                                   \
+		if (!TREE_T##_erase_from(tree, TREE_T##_as_inner(node)->children[c], key))                                     \
+			return 0;                                                                                                  \
+		if (TREE_T##_as_inner(node)->children[c]->count < TREE_T##_min_keys)                                           \
+			TREE_T##_fix_child(tree, TREE_T##_as_inner(node), c);                                                      \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* erase – remove key; 1 if it was present */                                                                      \
+	static inline int TREE_T##_erase(TREE_T *tree, KEY_T key) {                                                        \
+		if (!tree->root || !TREE_T##_erase_from(tree, tree->root, key))                                                \
+			return 0;                                                                                                  \
+		--tree->count;                                                                                                 \
+		TREE_T##_node *root = tree->root;                                                                              \
+		if (root->count == 0) {                                                                                        \
+			/* an inner root left with one child hands over to it; an empty leaf root empties the tree */              \
+			if (root->leaf) {                                                                                          \
+				tree->root = NULL;                                                                                     \
+				tree->first = tree->last = NULL;                                                                       \
+			} else {                                                                                                   \
+				tree->root = TREE_T##_as_inner(root)->children[0];                                                     \
+			}                                                                                                          \
+			--tree->height;                                                                                            \
+			free(root);                                                                                                \
+		}                                                                                                              \
+		return 1;                                                                                                      \
+	}
+
+#endif /* BPLUSTREE_H */
@@ -1,47 +1,111 @@
 #ifndef BTREE_H
 #define BTREE_H
 
-#include "vector/vector.h"
+#include "vector/small_vector.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-/*  Generic btree macro
+/*  Generic binary search tree macro
  *
  *  Usage:
- *      DEF_BTREE(int, IntVec)
+ *      DEF_BTREE(int, IntTree)
+ *
+ *      static int IntTree_node_cmp(IntTree_node *a, IntTree_node *b) {
+ *          return (a->value > b->value) - (a->value < b->value);
+ *      }
  *
  *  Generates:
- *      typedef struct { int *data; size_t capacity; size_t count; } IntVec;
- *      void IntVec_init(IntVec *btr, size_t initial_capacity);
- *      void IntVec_deinit(IntVec *btr);
- *      void IntVec_realloc(IntVec *btr, size_t new_capacity);
- *      void IntVec_push_back(IntVec *btr, int value);
- *      int  IntVec_pop_back(IntVec *btr, int *out);
+ *      typedef struct IntTree_node { IntTree_node *pchildren[2]; IntTree_node *pparent; ...; int value; } IntTree_node;
+ *      typedef struct IntTree { IntTree_node *root; size_t count; } IntTree;
+ *      void          IntTree_init(IntTree *tree);
+ *      IntTree_node *IntTree_insert(IntTree *tree, IntTree_node *node);
+ *      void          IntTree_erase(IntTree *tree, IntTree_node *node);
+ *      IntTree_node *IntTree_find(const IntTree *tree, int value);
+ *      IntTree_node *IntTree_lower_bound(const IntTree *tree, int value);
+ *      IntTree_node *IntTree_upper_bound(const IntTree *tree, int value);
+ *      IntTree_node *IntTree_first(const IntTree *tree);
+ *      IntTree_node *IntTree_next(IntTree_node *node);
+ *      ... _last, _prev, and the same four for _preorder_ and _postorder_.
+ *      IntTree_node *IntTree_build_from_sorted(IntTree *tree, const int *values, size_t n);
+ *      void          IntTree_link_sorted(IntTree *tree, IntTree_node *nodes, size_t n);
+ *      size_t        IntTree_count_range(const IntTree *tree, int lo, int hi);
+ *      void          IntTree_visit_range(const IntTree *tree, int lo, int hi, visit, ctx);
+ *      void          IntTree_split(IntTree *tree, int key, IntTree *right);
+ *      void          IntTree_join(IntTree *tree, IntTree *right);
+ *      ... node helpers and IntTree_iterator.
+ *
+ *  The tree is intrusive: it links nodes the caller allocated and never
+ *  allocates or frees any itself. The caller defines _node_cmp, which orders
+ *  nodes by value. _insert and _erase keep the tree red-black balanced, so
+ *  its height stays below 2 log2(n + 1) and every operation is O(log n).
+ *  _insert returns the node it linked, or the node already in the tree with
+ *  an equal value, leaving the tree unchanged. _find, _lower_bound and
+ *  _upper_bound return the node equal to, the first not less than, and the
+ *  first greater than `value`, or NULL.
+ *
+ *  The traversal functions step from a node to the next one in order by
+ *  following pparent and pchildren, so they need no stack and never
+ *  allocate; each step is O(1) amortised over a full walk. BTREE_FOREACH
+ *  and its variants wrap them in a for loop.
+ *
+ *  _build_from_sorted and _link_sorted build a perfectly balanced tree from
+ *  ascending values in O(n); _build_from_sorted puts all nodes in a single
+ *  allocation that the caller frees. Ranges are half-open, [lo, hi). _split
+ *  and _join relink the nodes in O(n) without allocating and leave both
+ *  trees perfectly balanced.
+ *
+ *  Trees built by hand with _node_parent_to can be read with the iterators
+ *  and traversals but must not be passed to _insert or _erase.
  */
 
+// Ancestors an iterator keeps without allocating; deeper descents spill its stack to the heap
+#ifndef BTREE_ITER_INLINE_DEPTH
+#define BTREE_ITER_INLINE_DEPTH 32
+#endif
+
 typedef enum IterDirection {
 	BTREE_LEFT = 0,
 	BTREE_RIGHT = 1,
 } IterDirection;
 
+// Loops over a tree in key order, reverse key order, pre-order or post-order. `node` is a BTREE_T##_node
+// pointer declared by the caller; the body must not unlink it.
+#define BTREE_FOREACH(BTREE_T, tree, node) for ((node) = BTREE_T##_first(tree); (node); (node) = BTREE_T##_next(node))
+#define BTREE_FOREACH_REVERSE(BTREE_T, tree, node)                                                                     \
+	for ((node) = BTREE_T##_last(tree); (node); (node) = BTREE_T##_prev(node))
+#define BTREE_FOREACH_PREORDER(BTREE_T, tree, node)                                                                    \
+	for ((node) = BTREE_T##_preorder_first(tree); (node); (node) = BTREE_T##_preorder_next(node))
+#define BTREE_FOREACH_POSTORDER(BTREE_T, tree, node)                                                                   \
+	for ((node) = BTREE_T##_postorder_first(tree); (node); (node) = BTREE_T##_postorder_next(node))
+
 #define DEF_BTREE(VAL_T, BTREE_T)                                                                                      \
                                                                                                                        \
 	/* btree node struct */                                                                                            \
 	typedef struct BTREE_T##_node {                                                                                    \
 		struct BTREE_T##_node *pchildren[2];                                                                           \
 		struct BTREE_T##_node *pparent;                                                                                \
+		unsigned char		   red; /* colour, kept by _insert and _erase */                                           \
 		VAL_T				   value;                                                                                  \
 	} BTREE_T##_node;                                                                                                  \
                                                                                                                        \
-	DEF_VECTOR(struct BTREE_T##_node *, BTREE_T##_pnode_stack);                                                        \
+	/* ordered tree of linked nodes */                                                                                 \
+	typedef struct BTREE_T {                                                                                           \
+		BTREE_T##_node *root;                                                                                          \
+		size_t		   count;                                                                                          \
+	} BTREE_T;                                                                                                         \
+                                                                                                                       \
+	DEF_SMALL_VECTOR(struct BTREE_T##_node *, BTREE_ITER_INLINE_DEPTH, BTREE_T##_pnode_stack)                          \
                                                                                                                        \
+	/* iterators hold their stack inline and must not be copied */                                                     \
 	typedef struct BTREE_T##_iterator {                                                                                \
 		BTREE_T##_pnode_stack stack;                                                                                   \
 		BTREE_T##_node		 *current;                                                                                 \
 	} BTREE_T##_iterator;                                                                                              \
                                                                                                                        \
 	static inline void BTREE_T##_iterator_init(BTREE_T##_iterator *iter, BTREE_T##_node *start) {                      \
-		BTREE_T##_pnode_stack_init(&iter->stack, 8);                                                                   \
+		BTREE_T##_pnode_stack_init(&iter->stack, 0);                                                                   \
 		iter->current = start;                                                                                         \
 	}                                                                                                                  \
                                                                                                                        \
@@ -55,6 +119,7 @@ typedef enum IterDirection {
 		btr->pchildren[0] = NULL;                                                                                      \
 		btr->pchildren[1] = NULL;                                                                                      \
 		btr->pparent = NULL;                                                                                           \
+		btr->red = 0;                                                                                                  \
 	}                                                                                                                  \
                                                                                                                        \
 	static inline void BTREE_T##_node_parent_to(BTREE_T##_node *node, BTREE_T##_node *new_parent, IterDirection dir) { \
@@ -67,6 +132,7 @@ typedef enum IterDirection {
 		btr->pchildren[0] = NULL;                                                                                      \
 		btr->pchildren[1] = NULL;                                                                                      \
 		btr->pparent = NULL;                                                                                           \
+		btr->red = 0;                                                                                                  \
 		btr->value = value;                                                                                            \
 	}                                                                                                                  \
                                                                                                                        \
@@ -74,7 +140,7 @@ typedef enum IterDirection {
 	/* if pnode_a < pnode_b, then the return value shall be negative */                                                \
 	static int BTREE_T##_node_cmp(BTREE_T##_node *pnode_a, BTREE_T##_node *pnode_b);                                   \
                                                                                                                        \
-	static int BTREE_T##_iter_parent(BTREE_T##_iterator *iter) {                                                       \
+	static inline int BTREE_T##_iter_parent(BTREE_T##_iterator *iter) {                                                \
 		struct BTREE_T##_node *p;                                                                                      \
 		int					   result = BTREE_T##_pnode_stack_pop_back(&iter->stack, &p);                              \
 		if (result != 0) {                                                                                             \
@@ -83,7 +149,7 @@ typedef enum IterDirection {
 		return result;                                                                                                 \
 	}                                                                                                                  \
                                                                                                                        \
-	static int BTREE_T##_iter_child(BTREE_T##_iterator *iter, IterDirection direction) {                               \
+	static inline int BTREE_T##_iter_child(BTREE_T##_iterator *iter, IterDirection direction) {                        \
 		struct BTREE_T##_node *pnext = iter->current->pchildren[direction];                                            \
 		if (pnext) {                                                                                                   \
 			BTREE_T##_pnode_stack_push_back(&iter->stack, iter->current);                                              \
@@ -92,6 +158,436 @@ typedef enum IterDirection {
 		} else {                                                                                                       \
 			return 0;                                                                                                  \
 		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* initialise an empty tree */                                                                                     \
+	static inline void BTREE_T##_init(BTREE_T *tree) {                                                                 \
+		tree->root = NULL;                                                                                             \
+		tree->count = 0;                                                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* point parent (or the root, if parent is NULL) at new_child where it pointed at old_child */                     \
+	static inline void BTREE_T##_replace_child(BTREE_T *tree, BTREE_T##_node *parent, BTREE_T##_node *old_child,       \
+											   BTREE_T##_node *new_child) {                                            \
+		if (!parent)                                                                                                   \
+			tree->root = new_child;                                                                                    \
+		else                                                                                                           \
+			parent->pchildren[parent->pchildren[BTREE_RIGHT] == old_child] = new_child;                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* rotate node down to its `dir` side, lifting its child from the other side into its place */                     \
+	static inline void BTREE_T##_rotate(BTREE_T *tree, BTREE_T##_node *node, IterDirection dir) {                      \
+		BTREE_T##_node *lift = node->pchildren[!dir];                                                                  \
+		node->pchildren[!dir] = lift->pchildren[dir];                                                                  \
+		if (lift->pchildren[dir])                                                                                      \
+			lift->pchildren[dir]->pparent = node;                                                                      \
+		lift->pparent = node->pparent;                                                                                 \
+		BTREE_T##_replace_child(tree, node->pparent, node, lift);                                                      \
+		lift->pchildren[dir] = node;                                                                                   \
+		node->pparent = lift;                                                                                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline int BTREE_T##_is_red(const BTREE_T##_node *node) {                                                   \
+		return node && node->red;                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* insert – link node, or return the existing node with an equal value */                                          \
+	static inline BTREE_T##_node *BTREE_T##_insert(BTREE_T *tree, BTREE_T##_node *node) {                              \
+		BTREE_T##_node	*parent = NULL;                                                                                \
+		BTREE_T##_node **link = &tree->root;                                                                           \
+		while (*link) {                                                                                                \
+			parent = *link;                                                                                            \
+			int cmp = BTREE_T##_node_cmp(node, parent);                                                                \
+			if (cmp == 0)                                                                                              \
+				return parent;                                                                                         \
+			link = &parent->pchildren[cmp > 0];                                                                        \
+		}                                                                                                              \
+		node->pchildren[BTREE_LEFT] = node->pchildren[BTREE_RIGHT] = NULL;                                             \
+		node->pparent = parent;                                                                                        \
+		node->red = 1;                                                                                                 \
+		*link = node;                                                                                                  \
+		++tree->count;                                                                                                 \
+                                                                                                                       \
+		/* repair red nodes with red parents, moving up the tree */                                                    \
+		BTREE_T##_node *inserted = node;                                                                               \
+		while ((parent = node->pparent) && parent->red) {                                                              \
+			BTREE_T##_node *grandparent = parent->pparent; /* exists, as the root is black */                          \
+			IterDirection side = grandparent->pchildren[BTREE_RIGHT] == parent ? BTREE_RIGHT : BTREE_LEFT;             \
+			BTREE_T##_node *uncle = grandparent->pchildren[!side];                                                     \
+			if (BTREE_T##_is_red(uncle)) {                                                                             \
+				parent->red = uncle->red = 0;                                                                          \
+				grandparent->red = 1;                                                                                  \
+				node = grandparent;                                                                                    \
+				continue;                                                                                              \
+			}                                                                                                          \
+			if (node == parent->pchildren[!side]) {                                                                    \
+				BTREE_T##_rotate(tree, parent, side);                                                                  \
+				parent = node;                                                                                         \
+			}                                                                                                          \
+			parent->red = 0;                                                                                           \
+			grandparent->red = 1;                                                                                      \
+			BTREE_T##_rotate(tree, grandparent, (IterDirection) !side);                                                \
+			break;                                                                                                     \
+		}                                                                                                              \
+		tree->root->red = 0;                                                                                           \
+		return inserted;                                                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* erase – unlink node from the tree; the caller still owns it */                                                  \
+	static inline void BTREE_T##_erase(BTREE_T *tree, BTREE_T##_node *node) {                                          \
+		BTREE_T##_node *child, *parent;                                                                                \
+		int				removed_red;                                                                                   \
+		if (!node->pchildren[BTREE_LEFT] || !node->pchildren[BTREE_RIGHT]) {                                           \
+			child = node->pchildren[node->pchildren[BTREE_LEFT] == NULL];                                              \
+			parent = node->pparent;                                                                                    \
+			removed_red = node->red;                                                                                   \
+			if (child)                                                                                                 \
+				child->pparent = parent;                                                                               \
+			BTREE_T##_replace_child(tree, parent, node, child);                                                        \
+		} else {                                                                                                       \
+			/* two children: the successor takes node's place and colour */                                            \
+			BTREE_T##_node *next = node->pchildren[BTREE_RIGHT];                                                       \
+			while (next->pchildren[BTREE_LEFT])                                                                        \
+				next = next->pchildren[BTREE_LEFT];                                                                    \
+			removed_red = next->red;                                                                                   \
+			child = next->pchildren[BTREE_RIGHT];                                                                      \
+			if (next->pparent == node) {                                                                               \
+				parent = next;                                                                                         \
+			} else {                                                                                                   \
+				parent = next->pparent;                                                                                \
+				parent->pchildren[BTREE_LEFT] = child;                                                                 \
+				if (child)                                                                                             \
+					child->pparent = parent;                                                                           \
+				next->pchildren[BTREE_RIGHT] = node->pchildren[BTREE_RIGHT];                                           \
+				next->pchildren[BTREE_RIGHT]->pparent = next;                                                          \
+			}                                                                                                          \
+			next->pchildren[BTREE_LEFT] = node->pchildren[BTREE_LEFT];                                                 \
+			next->pchildren[BTREE_LEFT]->pparent = next;                                                               \
+			next->pparent = node->pparent;                                                                             \
+			next->red = node->red;                                                                                     \
+			BTREE_T##_replace_child(tree, node->pparent, node, next);                                                  \
+		}                                                                                                              \
+		--tree->count;                                                                                                 \
+		node->pchildren[BTREE_LEFT] = node->pchildren[BTREE_RIGHT] = node->pparent = NULL;                             \
+		if (removed_red)                                                                                               \
+			return;                                                                                                    \
+                                                                                                                       \
+		/* a black node left its paths one black short: fix it with rotations or push the deficit up */                \
+		while (child != tree->root && !BTREE_T##_is_red(child)) {                                                      \
+			IterDirection side = parent->pchildren[BTREE_LEFT] != child ? BTREE_RIGHT : BTREE_LEFT;                    \
+			BTREE_T##_node *sibling = parent->pchildren[!side];                                                        \
+			if (sibling->red) {                                                                                        \
+				sibling->red = 0;                                                                                      \
+				parent->red = 1;                                                                                       \
+				BTREE_T##_rotate(tree, parent, side);                                                                  \
+				sibling = parent->pchildren[!side];                                                                    \
+			}                                                                                                          \
+			if (!BTREE_T##_is_red(sibling->pchildren[BTREE_LEFT]) &&                                                   \
+				!BTREE_T##_is_red(sibling->pchildren[BTREE_RIGHT])) {                                                  \
+				sibling->red = 1;                                                                                      \
+				child = parent;                                                                                        \
+				parent = child->pparent;                                                                               \
+				continue;                                                                                              \
+			}                                                                                                          \
+			if (!BTREE_T##_is_red(sibling->pchildren[!side])) {                                                        \
+				sibling->pchildren[side]->red = 0;                                                                     \
+				sibling->red = 1;                                                                                      \
+				BTREE_T##_rotate(tree, sibling, (IterDirection) !side);                                                \
+				sibling = parent->pchildren[!side];                                                                    \
+			}                                                                                                          \
+			sibling->red = parent->red;                                                                                \
+			parent->red = 0;                                                                                           \
+			sibling->pchildren[!side]->red = 0;                                                                        \
+			BTREE_T##_rotate(tree, parent, side);                                                                      \
+			child = tree->root;                                                                                        \
+		}                                                                                                              \
+		if (child)                                                                                                     \
+			child->red = 0;                                                                                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* find – the node whose value compares equal to value, or NULL */                                                 \
+	static inline BTREE_T##_node *BTREE_T##_find(const BTREE_T *tree, VAL_T value) {                                   \
+		BTREE_T##_node key;                                                                                            \
+		key.value = value;                                                                                             \
+		BTREE_T##_node *node = tree->root;                                                                             \
+		while (node) {                                                                                                 \
+			int cmp = BTREE_T##_node_cmp(&key, node);                                                                  \
+			if (cmp == 0)                                                                                              \
+				return node;                                                                                           \
+			node = node->pchildren[cmp > 0];                                                                           \
+		}                                                                                                              \
+		return NULL;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* lower_bound – the first node not less than value, or NULL */                                                    \
+	static inline BTREE_T##_node *BTREE_T##_lower_bound(const BTREE_T *tree, VAL_T value) {                            \
+		BTREE_T##_node key;                                                                                            \
+		key.value = value;                                                                                             \
+		BTREE_T##_node *node = tree->root, *bound = NULL;                                                              \
+		while (node) {                                                                                                 \
+			if (BTREE_T##_node_cmp(node, &key) >= 0) {                                                                 \
+				bound = node;                                                                                          \
+				node = node->pchildren[BTREE_LEFT];                                                                    \
+			} else {                                                                                                   \
+				node = node->pchildren[BTREE_RIGHT];                                                                   \
+			}                                                                                                          \
+		}                                                                                                              \
+		return bound;                                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* upper_bound – the first node greater than value, or NULL */                                                     \
+	static inline BTREE_T##_node *BTREE_T##_upper_bound(const BTREE_T *tree, VAL_T value) {                            \
+		BTREE_T##_node key;                                                                                            \
+		key.value = value;                                                                                             \
+		BTREE_T##_node *node = tree->root, *bound = NULL;                                                              \
+		while (node) {                                                                                                 \
+			if (BTREE_T##_node_cmp(node, &key) > 0) {                                                                  \
+				bound = node;                                                                                          \
+				node = node->pchildren[BTREE_LEFT];                                                                    \
+			} else {                                                                                                   \
+				node = node->pchildren[BTREE_RIGHT];                                                                   \
+			}                                                                                                          \
+		}                                                                                                              \
+		return bound;                                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* deepest node down the `dir` side of node */                                                                     \
+	static inline BTREE_T##_node *BTREE_T##_extreme(BTREE_T##_node *node, IterDirection dir) {                         \
+		if (node) {                                                                                                    \
+			while (node->pchildren[dir])                                                                               \
+				node = node->pchildren[dir];                                                                           \
+		}                                                                                                              \
+		return node;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* the node reached from node by preferring `dir` children, else the other ones, down to a leaf */                 \
+	static inline BTREE_T##_node *BTREE_T##_descend_to_leaf(BTREE_T##_node *node, IterDirection dir) {                 \
+		if (node) {                                                                                                    \
+			while (node->pchildren[dir] || node->pchildren[!dir])                                                      \
+				node = node->pchildren[dir] ? node->pchildren[dir] : node->pchildren[!dir];                            \
+		}                                                                                                              \
+		return node;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* in-order step to the `dir` side: the successor for BTREE_RIGHT, the predecessor for BTREE_LEFT */               \
+	static inline BTREE_T##_node *BTREE_T##_inorder_step(BTREE_T##_node *node, IterDirection dir) {                    \
+		if (node->pchildren[dir])                                                                                      \
+			return BTREE_T##_extreme(node->pchildren[dir], (IterDirection) !dir);                                      \
+		while (node->pparent && node->pparent->pchildren[dir] == node)                                                 \
+			node = node->pparent;                                                                                      \
+		return node->pparent;                                                                                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* the `first` child, else the other child, else the unvisited sibling of the nearest ancestor: */                 \
+	/* the pre-order successor for BTREE_LEFT and the post-order predecessor for BTREE_RIGHT */                        \
+	static inline BTREE_T##_node *BTREE_T##_down_first_step(BTREE_T##_node *node, IterDirection first) {               \
+		if (node->pchildren[first])                                                                                    \
+			return node->pchildren[first];                                                                             \
+		if (node->pchildren[!first])                                                                                   \
+			return node->pchildren[!first];                                                                            \
+		for (; node->pparent; node = node->pparent) {                                                                  \
+			if (node->pparent->pchildren[first] == node && node->pparent->pchildren[!first])                           \
+				return node->pparent->pchildren[!first];                                                               \
+		}                                                                                                              \
+		return NULL;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* the parent, or the subtree on the parent's `first` side when node is on the other side: */                      \
+	/* the pre-order predecessor for BTREE_LEFT and the post-order successor for BTREE_RIGHT */                        \
+	static inline BTREE_T##_node *BTREE_T##_up_first_step(BTREE_T##_node *node, IterDirection first) {                 \
+		BTREE_T##_node *parent = node->pparent;                                                                        \
+		if (parent && parent->pchildren[!first] == node && parent->pchildren[first])                                   \
+			return BTREE_T##_descend_to_leaf(parent->pchildren[first], (IterDirection) !first);                        \
+		return parent;                                                                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* in-order traversal; walking backwards from _last visits the nodes in reverse */                                 \
+	static inline BTREE_T##_node *BTREE_T##_first(const BTREE_T *tree) {                                               \
+		return BTREE_T##_extreme(tree->root, BTREE_LEFT);                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_last(const BTREE_T *tree) {                                                \
+		return BTREE_T##_extreme(tree->root, BTREE_RIGHT);                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_next(BTREE_T##_node *node) {                                               \
+		return BTREE_T##_inorder_step(node, BTREE_RIGHT);                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_prev(BTREE_T##_node *node) {                                               \
+		return BTREE_T##_inorder_step(node, BTREE_LEFT);                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* pre-order traversal: each node before its left, then its right subtree */                                       \
+	static inline BTREE_T##_node *BTREE_T##_preorder_first(const BTREE_T *tree) {                                      \
+		return tree->root;                                                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_preorder_last(const BTREE_T *tree) {                                       \
+		return BTREE_T##_descend_to_leaf(tree->root, BTREE_RIGHT);                                                     \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_preorder_next(BTREE_T##_node *node) {                                      \
+		return BTREE_T##_down_first_step(node, BTREE_LEFT);                                                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_preorder_prev(BTREE_T##_node *node) {                                      \
+		return BTREE_T##_up_first_step(node, BTREE_LEFT);                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* post-order traversal: each node after its left, then its right subtree */                                       \
+	static inline BTREE_T##_node *BTREE_T##_postorder_first(const BTREE_T *tree) {                                     \
+		return BTREE_T##_descend_to_leaf(tree->root, BTREE_LEFT);                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_postorder_last(const BTREE_T *tree) {                                      \
+		return tree->root;                                                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_postorder_next(BTREE_T##_node *node) {                                     \
+		return BTREE_T##_up_first_step(node, BTREE_RIGHT);                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline BTREE_T##_node *BTREE_T##_postorder_prev(BTREE_T##_node *node) {                                     \
+		return BTREE_T##_down_first_step(node, BTREE_RIGHT);                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* link the next n nodes of a list threaded through pchildren[BTREE_RIGHT] as a balanced subtree, */               \
+	/* colouring the nodes at red_depth (the deepest level) red so that the result is a valid red-black tree */        \
+	static inline BTREE_T##_node *BTREE_T##_build_list(BTREE_T##_node **head, size_t n, unsigned depth,                \
+													   unsigned red_depth) {                                           \
+		if (n == 0)                                                                                                    \
+			return NULL;                                                                                               \
+		size_t			left_n = (n - 1) / 2;                                                                          \
+		BTREE_T##_node *left = BTREE_T##_build_list(head, left_n, depth + 1, red_depth);                               \
+		BTREE_T##_node *node = *head;                                                                                  \
+		*head = node->pchildren[BTREE_RIGHT];                                                                          \
+		node->pchildren[BTREE_LEFT] = left;                                                                            \
+		if (left)                                                                                                      \
+			left->pparent = node;                                                                                      \
+		BTREE_T##_node *right = BTREE_T##_build_list(head, n - 1 - left_n, depth + 1, red_depth);                      \
+		node->pchildren[BTREE_RIGHT] = right;                                                                          \
+		if (right)                                                                                                     \
+			right->pparent = node;                                                                                     \
+		node->red = depth == red_depth && depth > 0;                                                                   \
+		return node;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* make tree a balanced tree of the n nodes listed in order at head */                                             \
+	static inline void BTREE_T##_link_list(BTREE_T *tree, BTREE_T##_node *head, size_t n) {                            \
+		unsigned red_depth = 0;                                                                                        \
+		while (((size_t) 2 << red_depth) <= n)                                                                         \
+			++red_depth; /* floor(log2(n)) */                                                                          \
+		tree->root = BTREE_T##_build_list(&head, n, 0, red_depth);                                                     \
+		if (tree->root)                                                                                                \
+			tree->root->pparent = NULL;                                                                                \
+		tree->count = n;                                                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* unlink every node of tree into a list in order, threaded through pchildren[BTREE_RIGHT] */                      \
+	static inline BTREE_T##_node *BTREE_T##_flatten(BTREE_T *tree) {                                                   \
+		BTREE_T##_node	head;                                                                                          \
+		head.pchildren[BTREE_RIGHT] = tree->root;                                                                      \
+		BTREE_T##_node *tail = &head;                                                                                  \
+		BTREE_T##_node *rest = tree->root;                                                                             \
+		while (rest) {                                                                                                 \
+			if (rest->pchildren[BTREE_LEFT]) {                                                                         \
+				/* rotate the left child up until rest has none */                                                     \
+				BTREE_T##_node *left = rest->pchildren[BTREE_LEFT];                                                    \
+				rest->pchildren[BTREE_LEFT] = left->pchildren[BTREE_RIGHT];                                            \
+				left->pchildren[BTREE_RIGHT] = rest;                                                                   \
+				rest = left;                                                                                           \
+				tail->pchildren[BTREE_RIGHT] = left;                                                                   \
+			} else {                                                                                                   \
+				tail = rest;                                                                                           \
+				rest = rest->pchildren[BTREE_RIGHT];                                                                   \
+			}                                                                                                          \
+		}                                                                                                              \
+		tree->root = NULL;                                                                                             \
+		tree->count = 0;                                                                                               \
+		return head.pchildren[BTREE_RIGHT];                                                                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* link_sorted – make tree a balanced tree of nodes[0..n), whose values must be strictly ascending; O(n) */        \
+	static inline void BTREE_T##_link_sorted(BTREE_T *tree, BTREE_T##_node *nodes, size_t n) {                         \
+		for (size_t i = 0; i < n; ++i)                                                                                 \
+			nodes[i].pchildren[BTREE_RIGHT] = i + 1 < n ? &nodes[i + 1] : NULL;                                        \
+		BTREE_T##_link_list(tree, n ? nodes : NULL, n);                                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* build_from_sorted – allocate one block of n nodes holding values (strictly ascending) and link them */          \
+	/* as a balanced tree in O(n); returns the block, which the caller frees once done with the tree, or */            \
+	/* NULL (leaving the tree empty) if n is 0 or allocation fails */                                                  \
+	static inline BTREE_T##_node *BTREE_T##_build_from_sorted(BTREE_T *tree, const VAL_T *values, size_t n) {          \
+		BTREE_T##_init(tree);                                                                                          \
+		if (n == 0 || n > SIZE_MAX / sizeof(BTREE_T##_node))                                                           \
+			return NULL;                                                                                               \
+		BTREE_T##_node *nodes = (BTREE_T##_node *) malloc(n * sizeof(BTREE_T##_node));                                 \
+		if (!nodes)                                                                                                    \
+			return NULL;                                                                                               \
+		for (size_t i = 0; i < n; ++i)                                                                                 \
+			nodes[i].value = values[i];                                                                                \
+		BTREE_T##_link_sorted(tree, nodes, n);                                                                         \
+		return nodes;                                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* count_range – number of nodes with lo <= value < hi; O(log n + result) */                                       \
+	static inline size_t BTREE_T##_count_range(const BTREE_T *tree, VAL_T lo, VAL_T hi) {                              \
+		BTREE_T##_node key;                                                                                            \
+		key.value = hi;                                                                                                \
+		size_t count = 0;                                                                                              \
+		for (BTREE_T##_node *node = BTREE_T##_lower_bound(tree, lo); node && BTREE_T##_node_cmp(node, &key) < 0;       \
+			 node = BTREE_T##_next(node))                                                                              \
+			++count;                                                                                                   \
+		return count;                                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* visit_range – call visit(ctx, node) for each node with lo <= value < hi, in order; */                           \
+	/* visit must not unlink nodes */                                                                                  \
+	static inline void BTREE_T##_visit_range(const BTREE_T *tree, VAL_T lo, VAL_T hi,                                  \
+											 void (*visit)(void *ctx, BTREE_T##_node *node), void *ctx) {              \
+		BTREE_T##_node key;                                                                                            \
+		key.value = hi;                                                                                                \
+		for (BTREE_T##_node *node = BTREE_T##_lower_bound(tree, lo); node && BTREE_T##_node_cmp(node, &key) < 0;       \
+			 node = BTREE_T##_next(node))                                                                              \
+			visit(ctx, node);                                                                                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* split – move the nodes with value >= key into right, which need not be initialised; */                          \
+	/* both trees come out balanced; O(n), without allocating */                                                       \
+	static inline void BTREE_T##_split(BTREE_T *tree, VAL_T key, BTREE_T *right) {                                     \
+		BTREE_T##_node bound;                                                                                          \
+		bound.value = key;                                                                                             \
+		size_t			total = tree->count;                                                                           \
+		BTREE_T##_node *head = BTREE_T##_flatten(tree);                                                                \
+		BTREE_T##_node *last_left = NULL;                                                                              \
+		size_t			left_n = 0;                                                                                    \
+		for (BTREE_T##_node *node = head; node && BTREE_T##_node_cmp(node, &bound) < 0;                                \
+			 node = node->pchildren[BTREE_RIGHT]) {                                                                    \
+			last_left = node;                                                                                          \
+			++left_n;                                                                                                  \
+		}                                                                                                              \
+		BTREE_T##_node *right_head = last_left ? last_left->pchildren[BTREE_RIGHT] : head;                             \
+		BTREE_T##_link_list(tree, left_n ? head : NULL, left_n);                                                       \
+		BTREE_T##_init(right);                                                                                         \
+		BTREE_T##_link_list(right, right_head, total - left_n);                                                        \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* join – move every node of right, whose values must all be greater than those in tree, into tree; */             \
+	/* right is left empty; O(n), without allocating */                                                                \
+	static inline void BTREE_T##_join(BTREE_T *tree, BTREE_T *right) {                                                 \
+		size_t			total = tree->count + right->count;                                                            \
+		BTREE_T##_node *head = BTREE_T##_flatten(tree);                                                                \
+		BTREE_T##_node *right_head = BTREE_T##_flatten(right);                                                         \
+		if (!head) {                                                                                                   \
+			head = right_head;                                                                                         \
+		} else {                                                                                                       \
+			BTREE_T##_node *tail = head;                                                                               \
+			while (tail->pchildren[BTREE_RIGHT])                                                                       \
+				tail = tail->pchildren[BTREE_RIGHT];                                                                   \
+			tail->pchildren[BTREE_RIGHT] = right_head;                                                                 \
+		}                                                                                                              \
+		BTREE_T##_link_list(tree, head, total);                                                                        \
 	}
 
 #endif /* BTREE_H */
@@ -24,4 +24,4 @@ static inline T NAME##_str_##T(const char *s) {                     \
         hash *= prime;                                              \
     }                                                                \
     return hash;                                                     \
-}
\ No newline at end of file
+}
@@ -0,0 +1,229 @@
+#ifndef FLAT_HASHTABLE_H
+#define FLAT_HASHTABLE_H
+
+#include "hashtable/htstats.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*  Generic open-addressing hash table macro
+ *
+ *  Usage:
+ *      size_t IntMap_hash_key(int key);    // defined by the user, like DEF_HASHTABLE
+ *      DEF_FLAT_HASHTABLE(int, float, IntMap)
+ *
+ *      bool Vec2_eq(const Vec2 *a, const Vec2 *b);
+ *      size_t Vec2Map_hash_key(Vec2 key);
+ *      DEF_FLAT_HASHTABLE_EQ(Vec2, int, Vec2Map, Vec2_eq)
+ *
+ *  Generates:
+ *      typedef struct { IntMap_slot *slots; size_t capacity; size_t count; HtCounters counters; } IntMap;
+ *      bool   IntMap_init(IntMap *ht, size_t capacity);
+ *      void   IntMap_deinit(IntMap *ht);
+ *      bool   IntMap_reserve(IntMap *ht, size_t count);
+ *      bool   IntMap_insert(IntMap *ht, int key, float value);
+ *      float *IntMap_get(IntMap *ht, int key);
+ *      bool   IntMap_delete(IntMap *ht, int key);
+ *      void   IntMap_stats(const IntMap *ht, HtStats *stats);
+ *
+ *  Key, value and hash live together in one slot array, so a lookup touches
+ *  no memory outside it. Collisions are resolved by linear probing with Robin
+ *  Hood ordering: an entry being placed takes the slot of any entry that is
+ *  closer to its home slot, which keeps probe sequences short and lets a
+ *  lookup stop as soon as it meets an entry closer to home than the key would
+ *  be. Deletion shifts the following entries back instead of leaving
+ *  tombstones. The capacity is a power of two, so slots are selected by
+ *  masking, and grows before the load exceeds 7/8.
+ *
+ *  DEF_FLAT_HASHTABLE compares keys with ==; DEF_FLAT_HASHTABLE_EQ takes a
+ *  function or macro EQ(const KEY_T *a, const KEY_T *b) for keys == cannot
+ *  compare, such as structs. Pointers returned by _get are invalidated by the
+ *  next _insert, _delete or _reserve.
+ */
+
+// Maximum load factor, as numerator / denominator
+#define FLAT_HASHTABLE_MAX_LOAD_NUM 7
+#define FLAT_HASHTABLE_MAX_LOAD_DEN 8
+
+// Smallest non-empty capacity
+#define FLAT_HASHTABLE_MIN_CAPACITY 8
+
+// Scrambles a user hash so that its low bits, which select the home slot, depend on all of its bits. Never returns 0,
+// which marks an empty slot.
+static inline size_t flat_ht_mix(size_t hash) {
+	uint64_t h = (uint64_t) hash;
+	h ^= h >> 32;
+	h *= 0x9e3779b97f4a7c15ull;
+	h ^= h >> 29;
+	return (size_t) h ? (size_t) h : 1;
+}
+
+#define DEF_FLAT_HASHTABLE(KEY_T, VAL_T, TNAME)                                                                        \
+	static inline bool TNAME##_key_eq(const KEY_T *a, const KEY_T *b) {                                                \
+		return *a == *b;                                                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	DEF_FLAT_HASHTABLE_EQ(KEY_T, VAL_T, TNAME, TNAME##_key_eq)
+
+#define DEF_FLAT_HASHTABLE_EQ(KEY_T, VAL_T, TNAME, EQ)                                                                 \
+	typedef struct TNAME##_slot {                                                                                      \
+		size_t hash;                                                                                                   \
+		KEY_T  key;                                                                                                    \
+		VAL_T  value;                                                                                                  \
+	} TNAME##_slot;                                                                                                    \
+                                                                                                                       \
+	typedef struct {                                                                                                   \
+		TNAME##_slot *slots;                                                                                           \
+		size_t		  capacity;                                                                                        \
+		size_t		  count;                                                                                           \
+		HtCounters	  counters;                                                                                        \
+	} TNAME;                                                                                                           \
+                                                                                                                       \
+	size_t TNAME##_hash_key(KEY_T key);                                                                                \
+                                                                                                                       \
+	/* distance of the entry in slot `index` from its home slot */                                                     \
+	static inline size_t TNAME##_distance(const TNAME *ht, size_t index) {                                             \
+		return (index - ht->slots[index].hash) & (ht->capacity - 1);                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* slot holding the key, or capacity if absent */                                                                  \
+	static inline size_t TNAME##_find(const TNAME *ht, const KEY_T *key, size_t hash) {                                \
+		if (ht->count == 0)                                                                                            \
+			return ht->capacity;                                                                                       \
+		size_t mask = ht->capacity - 1;                                                                                \
+		size_t index = hash & mask;                                                                                    \
+		for (size_t dist = 0;; ++dist, index = (index + 1) & mask) {                                                   \
+			TNAME##_slot *slot = &ht->slots[index];                                                                    \
+			if (slot->hash == 0 || TNAME##_distance(ht, index) < dist)                                                 \
+				return ht->capacity;                                                                                   \
+			if (slot->hash == hash && EQ(&slot->key, key))                                                             \
+				return index;                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* places an entry known to be absent, with room to spare; returns its slot */                                     \
+	static inline size_t TNAME##_place(TNAME *ht, TNAME##_slot entry) {                                                \
+		size_t mask = ht->capacity - 1;                                                                                \
+		size_t index = entry.hash & mask;                                                                              \
+		size_t placed = ht->capacity;                                                                                  \
+		for (size_t dist = 0;; ++dist, index = (index + 1) & mask) {                                                   \
+			TNAME##_slot *slot = &ht->slots[index];                                                                    \
+			if (slot->hash == 0) {                                                                                     \
+				*slot = entry;                                                                                         \
+				return placed == ht->capacity ? index : placed;                                                        \
+			}                                                                                                          \
+			size_t slot_dist = TNAME##_distance(ht, index);                                                            \
+			if (slot_dist < dist) {                                                                                    \
+				TNAME##_slot evicted = *slot;                                                                          \
+				*slot = entry;                                                                                         \
+				entry = evicted;                                                                                       \
+				dist = slot_dist;                                                                                      \
+				if (placed == ht->capacity)                                                                            \
+					placed = index;                                                                                    \
+			}                                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_stats_reset(TNAME *ht) {                                                                \
+		ht->counters.hits = 0;                                                                                         \
+		ht->counters.misses = 0;                                                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* grow so that `count` entries fit under the maximum load */                                                      \
+	static inline bool TNAME##_reserve(TNAME *ht, size_t count) {                                                      \
+		size_t capacity = FLAT_HASHTABLE_MIN_CAPACITY;                                                                 \
+		while (capacity / FLAT_HASHTABLE_MAX_LOAD_DEN * FLAT_HASHTABLE_MAX_LOAD_NUM < count)                           \
+			capacity *= 2;                                                                                             \
+		if (capacity <= ht->capacity)                                                                                  \
+			return true;                                                                                               \
+		TNAME##_slot *old_slots = ht->slots;                                                                           \
+		size_t		  old_capacity = ht->capacity;                                                                     \
+		TNAME##_slot *slots = calloc(capacity, sizeof(TNAME##_slot));                                                  \
+		if (!slots)                                                                                                    \
+			return false;                                                                                              \
+		ht->slots = slots;                                                                                             \
+		ht->capacity = capacity;                                                                                       \
+		for (size_t i = 0; i < old_capacity; ++i) {                                                                    \
+			if (old_slots[i].hash != 0)                                                                                \
+				TNAME##_place(ht, old_slots[i]);                                                                       \
+		}                                                                                                              \
+		free(old_slots);                                                                                               \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline bool TNAME##_init(TNAME *ht, size_t capacity) {                                                      \
+		ht->slots = NULL;                                                                                              \
+		ht->capacity = 0;                                                                                              \
+		ht->count = 0;                                                                                                 \
+		TNAME##_stats_reset(ht);                                                                                       \
+		return capacity == 0 || TNAME##_reserve(ht, capacity);                                                         \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* insert, or replace the value of an existing key */                                                              \
+	static inline bool TNAME##_insert(TNAME *ht, KEY_T key, VAL_T value) {                                             \
+		size_t hash = flat_ht_mix(TNAME##_hash_key(key));                                                              \
+		size_t index = TNAME##_find(ht, &key, hash);                                                                   \
+		if (index != ht->capacity) {                                                                                   \
+			ht->slots[index].value = value;                                                                            \
+			return true;                                                                                               \
+		}                                                                                                              \
+		if (!TNAME##_reserve(ht, ht->count + 1))                                                                       \
+			return false;                                                                                              \
+		TNAME##_slot entry = {hash, key, value};                                                                       \
+		TNAME##_place(ht, entry);                                                                                      \
+		ht->count++;                                                                                                   \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline VAL_T *TNAME##_get(TNAME *ht, KEY_T key) {                                                           \
+		size_t index = TNAME##_find(ht, &key, flat_ht_mix(TNAME##_hash_key(key)));                                     \
+		HT_STATS_COUNT(ht->counters, index != ht->capacity);                                                           \
+		return index != ht->capacity ? &ht->slots[index].value : NULL;                                                 \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* delete with backward shift: later entries of the run move one slot closer to home */                            \
+	static inline bool TNAME##_delete(TNAME *ht, KEY_T key) {                                                          \
+		size_t index = TNAME##_find(ht, &key, flat_ht_mix(TNAME##_hash_key(key)));                                     \
+		if (index == ht->capacity)                                                                                     \
+			return false;                                                                                              \
+		size_t mask = ht->capacity - 1;                                                                                \
+		size_t next = (index + 1) & mask;                                                                              \
+		while (ht->slots[next].hash != 0 && TNAME##_distance(ht, next) != 0) {                                         \
+			ht->slots[index] = ht->slots[next];                                                                        \
+			index = next;                                                                                              \
+			next = (next + 1) & mask;                                                                                  \
+		}                                                                                                              \
+		ht->slots[index].hash = 0;                                                                                     \
+		ht->count--;                                                                                                   \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_stats(const TNAME *ht, HtStats *stats) {                                                \
+		*stats = (HtStats){0};                                                                                         \
+		size_t visits = 0;                                                                                             \
+		for (size_t i = 0; i < ht->capacity; i++) {                                                                    \
+			if (ht->slots[i].hash == 0)                                                                                \
+				continue;                                                                                              \
+			size_t length = TNAME##_distance(ht, i) + 1;                                                               \
+			visits += length;                                                                                          \
+			++stats->histogram[length < HT_STATS_HISTOGRAM ? length : HT_STATS_HISTOGRAM - 1];                         \
+			stats->max_chain = length > stats->max_chain ? length : stats->max_chain;                                  \
+		}                                                                                                              \
+		stats->entries = ht->count;                                                                                    \
+		stats->buckets = ht->capacity;                                                                                 \
+		stats->load_factor = ht->capacity ? (double) ht->count / ht->capacity : 0;                                     \
+		stats->avg_probe = ht->count ? (double) visits / ht->count : 0;                                                \
+		stats->bytes = sizeof(TNAME##_slot) * ht->capacity;                                                            \
+		stats->bytes_per_entry = ht->count ? (double) stats->bytes / ht->count : 0;                                    \
+		stats->hits = ht->counters.hits;                                                                               \
+		stats->misses = ht->counters.misses;                                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_deinit(TNAME *ht) {                                                                     \
+		free(ht->slots);                                                                                               \
+		ht->slots = NULL;                                                                                              \
+		ht->capacity = ht->count = 0;                                                                                  \
+	}
+
+#endif // FLAT_HASHTABLE_H
@@ -0,0 +1,243 @@
+#ifndef HASH64_H
+#define HASH64_H
+
+/**
+ * @file hash64.h
+ * @brief Word-at-a-time 64-bit hash functions.
+ *
+ * Every function here shares the prototype
+ * @code
+ * uint64_t fn(const void *key, size_t len, uint64_t seed);
+ * @endcode
+ * reads its input 8 bytes at a time and mixes with 64x64->128-bit multiplies,
+ * so all 64 output bits depend on every input byte.
+ *
+ * - hash64_wy  : wyhash-style; the best choice for short keys (the default).
+ * - hash64_xxh : xxh3-style striped accumulator for long keys. Uses SSE2 or,
+ *                when compiled with AVX2, AVX2; all paths return identical
+ *                values.
+ * - hash64_crc : hardware CRC32C lanes when compiled with SSE4.2, otherwise
+ *                the same as hash64_wy. Its values therefore depend on build
+ *                flags and must not be persisted.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+// Mixing constants (wyhash's default secret)
+#define HASH64_S0 0xa0761d6478bd642full
+#define HASH64_S1 0xe7037ed1a0b428dbull
+#define HASH64_S2 0x8ebc6af09c88c6e3ull
+#define HASH64_S3 0x589965cc75374cc3ull
+
+// Replaces a and b with the low and high halves of their 128-bit product
+static inline void hash64_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t) *a * *b;
+	*a = (uint64_t) r;
+	*b = (uint64_t) (r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t) *a, lb = (uint32_t) *b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t carry = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+// Multiplies two 64-bit values and folds the 128-bit product into 64 bits
+static inline uint64_t hash64_mix(uint64_t a, uint64_t b) {
+	hash64_mum(&a, &b);
+	return a ^ b;
+}
+
+static inline uint64_t hash64_read64(const unsigned char *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t hash64_read32(const unsigned char *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+// Folds 0..16 bytes into two words without reading past the key
+static inline void hash64_read_short(const unsigned char *p, size_t len, uint64_t *a, uint64_t *b) {
+	if (len >= 4) {
+		size_t mid = (len >> 3) << 2; // 0 for 4..7 bytes, 4 for 8..15, 8 for 16
+		*a = (hash64_read32(p) << 32) | hash64_read32(p + mid);
+		*b = (hash64_read32(p + len - 4) << 32) | hash64_read32(p + len - 4 - mid);
+	} else if (len > 0) {
+		*a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+		*b = 0;
+	} else {
+		*a = *b = 0;
+	}
+}
+
+// Final avalanche shared by every function in the family
+static inline uint64_t hash64_finish(uint64_t a, uint64_t b, uint64_t seed, size_t len) {
+	a ^= HASH64_S1;
+	b ^= seed;
+	hash64_mum(&a, &b);
+	return hash64_mix(a ^ HASH64_S0 ^ len, b ^ HASH64_S1);
+}
+
+/**
+ * wyhash-style hash: 16 bytes per round, three independent lanes above 48
+ * bytes.
+ */
+static inline uint64_t hash64_wy(const void *key, size_t len, uint64_t seed) {
+	const unsigned char *p = (const unsigned char *) key;
+	uint64_t			 a, b;
+
+	seed ^= hash64_mix(seed ^ HASH64_S0, HASH64_S1);
+	if (len <= 16) {
+		hash64_read_short(p, len, &a, &b);
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = hash64_mix(hash64_read64(p) ^ HASH64_S1, hash64_read64(p + 8) ^ seed);
+				see1 = hash64_mix(hash64_read64(p + 16) ^ HASH64_S2, hash64_read64(p + 24) ^ see1);
+				see2 = hash64_mix(hash64_read64(p + 32) ^ HASH64_S3, hash64_read64(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = hash64_mix(hash64_read64(p) ^ HASH64_S1, hash64_read64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = hash64_read64(p + i - 16);
+		b = hash64_read64(p + i - 8);
+	}
+	return hash64_finish(a, b, seed, len);
+}
+
+// Bytes consumed per stripe by hash64_xxh
+#define HASH64_STRIPE 64
+
+// One xxh3-style stripe: every lane adds the neighbouring input word and the
+// product of the low and high halves of (input ^ secret)
+static inline void hash64_accumulate_scalar(uint64_t acc[8], const unsigned char *p, uint64_t seed) {
+	for (int i = 0; i < 8; ++i) {
+		uint64_t v = hash64_read64(p + 8 * i);
+		uint64_t k = v ^ (seed + (uint64_t) i * HASH64_S2);
+		acc[i ^ 1] += v;
+		acc[i] += (k & 0xffffffffu) * (k >> 32);
+	}
+}
+
+#if defined(__AVX2__)
+static inline void hash64_accumulate(uint64_t acc[8], const unsigned char *p, uint64_t seed) {
+	const __m256i lane_idx0 = _mm256_set_epi64x(3, 2, 1, 0);
+	const __m256i lane_idx1 = _mm256_set_epi64x(7, 6, 5, 4);
+	const __m256i s2 = _mm256_set1_epi64x((long long) HASH64_S2);
+	for (int half = 0; half < 2; ++half) {
+		__m256i idx = half ? lane_idx1 : lane_idx0;
+		// seed + i * S2, computed lane-wise with 32-bit multiplies
+		__m256i lo = _mm256_mul_epu32(idx, s2);
+		__m256i hi = _mm256_slli_epi64(_mm256_mul_epu32(idx, _mm256_srli_epi64(s2, 32)), 32);
+		__m256i secret = _mm256_add_epi64(_mm256_set1_epi64x((long long) seed), _mm256_add_epi64(lo, hi));
+
+		__m256i v = _mm256_loadu_si256((const __m256i *) (p + 32 * half));
+		__m256i k = _mm256_xor_si256(v, secret);
+		__m256i prod = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+		__m256i swapped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)); // Swap neighbouring words
+		__m256i a = _mm256_loadu_si256((const __m256i *) (acc + 4 * half));
+		a = _mm256_add_epi64(a, _mm256_add_epi64(prod, swapped));
+		_mm256_storeu_si256((__m256i *) (acc + 4 * half), a);
+	}
+}
+#elif defined(__SSE2__)
+static inline void hash64_accumulate(uint64_t acc[8], const unsigned char *p, uint64_t seed) {
+	for (int pair = 0; pair < 4; ++pair) {
+		uint64_t secret0 = seed + (uint64_t) (2 * pair) * HASH64_S2;
+		uint64_t secret1 = seed + (uint64_t) (2 * pair + 1) * HASH64_S2;
+		__m128i	 secret = _mm_set_epi64x((long long) secret1, (long long) secret0);
+
+		__m128i v = _mm_loadu_si128((const __m128i *) (p + 16 * pair));
+		__m128i k = _mm_xor_si128(v, secret);
+		__m128i prod = _mm_mul_epu32(k, _mm_srli_epi64(k, 32));
+		__m128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)); // Swap neighbouring words
+		__m128i a = _mm_loadu_si128((const __m128i *) (acc + 2 * pair));
+		a = _mm_add_epi64(a, _mm_add_epi64(prod, swapped));
+		_mm_storeu_si128((__m128i *) (acc + 2 * pair), a);
+	}
+}
+#else
+static inline void hash64_accumulate(uint64_t acc[8], const unsigned char *p, uint64_t seed) {
+	hash64_accumulate_scalar(acc, p, seed);
+}
+#endif
+
+/**
+ * xxh3-style hash: eight 64-bit accumulator lanes consume 64-byte stripes,
+ * vectorized with SSE2/AVX2. Keys up to 128 bytes take the hash64_wy path.
+ */
+static inline uint64_t hash64_xxh(const void *key, size_t len, uint64_t seed) {
+	if (len <= 128) {
+		return hash64_wy(key, len, seed);
+	}
+
+	const unsigned char *p = (const unsigned char *) key;
+	uint64_t acc[8] = {HASH64_S0, HASH64_S1, HASH64_S2, HASH64_S3, HASH64_S3, HASH64_S2, HASH64_S1, HASH64_S0};
+	size_t	 stripes = (len - 1) / HASH64_STRIPE;
+
+	for (size_t s = 0; s < stripes; ++s) {
+		hash64_accumulate(acc, p + s * HASH64_STRIPE, seed);
+	}
+	// The last stripe always ends at the last byte, overlapping if needed
+	hash64_accumulate(acc, p + len - HASH64_STRIPE, seed ^ HASH64_S3);
+
+	uint64_t h = seed ^ (len * HASH64_S0);
+	for (int i = 0; i < 8; i += 2) {
+		h = hash64_mix(acc[i] ^ HASH64_S1 ^ h, acc[i + 1] ^ HASH64_S2);
+	}
+	return hash64_finish(h, acc[0] ^ acc[7], seed, len);
+}
+
+/**
+ * CRC32C-based hash: two independent hardware CRC lanes over 8-byte words,
+ * finished with a multiply mix. Falls back to hash64_wy without SSE4.2.
+ */
+static inline uint64_t hash64_crc(const void *key, size_t len, uint64_t seed) {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+	const unsigned char *p = (const unsigned char *) key;
+	uint64_t			 c0 = (uint32_t) seed, c1 = (uint32_t) (seed >> 32) ^ 0x9e3779b9u;
+	size_t				 i = len;
+
+	while (i >= 16) {
+		c0 = _mm_crc32_u64(c0, hash64_read64(p));
+		c1 = _mm_crc32_u64(c1, hash64_read64(p + 8));
+		p += 16;
+		i -= 16;
+	}
+	uint64_t a, b;
+	hash64_read_short(p, i, &a, &b);
+	c0 = _mm_crc32_u64(c0, a);
+	c1 = _mm_crc32_u64(c1, b);
+	return hash64_mix(((c0 << 32) | c1) ^ HASH64_S0 ^ len, seed ^ HASH64_S1);
+#else
+	return hash64_wy(key, len, seed);
+#endif
+}
+
+#endif /* HASH64_H */
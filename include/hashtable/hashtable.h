@@ -1,41 +1,163 @@
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
-#include "stdbool.h" // bool type
+#include "hashtable/htalloc.h" // Per-table allocator hooks
+#include "hashtable/htbloom.h" // Optional negative-lookup filter
+#include "hashtable/htstats.h" // Occupancy report and lookup counters
+#include "stdbool.h"			 // bool type
 #include "stddef.h"	 // Standard definitions (e.g., size_t)
+#include "stdint.h"	 // Fixed-width integer types (uint64_t)
 #include "stdlib.h"	 // Memory allocation functions (malloc, free)
 #include "string.h"	 // String manipulation functions (strcpy)
 
-// Memory management macros for simplified allocation and deallocation
+// Memory management macros backing the default allocator, used by tables
+// initialized without an HtAllocator
 #define htmalloc(size) malloc(size)
 #define htfree(p) free(p)
 
+// Keys shorter than this many bytes are stored inside the entry itself, so the
+// entry needs no separate key allocation
+#define HT_INLINE_KEY_SIZE 24
+
+// Storage for an entry's key bytes, always followed by a null terminator
+typedef union HtKey {
+	char *heap;							  // Heap copy, used when keylen >= HT_INLINE_KEY_SIZE
+	char  inline_buf[HT_INLINE_KEY_SIZE]; // Inline copy, used for shorter keys
+} HtKey;
+
+// Returns the bytes of a key stored with the given length
+static inline char *ht_key_ptr(HtKey *key, size_t keylen) {
+	return keylen < HT_INLINE_KEY_SIZE ? key->inline_buf : key->heap;
+}
+
 // Struct definition for a node in the hash table's linked list
 typedef struct HtNode {
-	char		  *key;	  // Key for the hash table entry (null-terminated string)
-	void		  *value; // Pointer to the value associated with the key
-	struct HtNode *pnext; // Pointer to the next node for handling collisions
+	HtKey		   key;	   // Key for the hash table entry (see ht_key_ptr)
+	void		  *value;  // Pointer to the value associated with the key
+	struct HtNode *pnext;  // Pointer to the next node for handling collisions
+	size_t		   keylen; // Length of the key in bytes, excluding the null terminator
+	uint64_t	   hash;   // Full hash of the key, checked before comparing key bytes
 } HtNode;
 
+// Number of flat-mode slots whose control bytes are scanned together
+#define HT_GROUP_WIDTH 16
+
+// Storage layout used by a hash table
+typedef enum HtMode {
+	HT_MODE_CHAINED = 0, // Separate chaining through HtNode lists
+	HT_MODE_FLAT = 1,	 // Open addressing with SIMD-scanned control bytes
+} HtMode;
+
+// Struct definition for a slot in a flat (open-addressing) hash table
+typedef struct HtSlot {
+	HtKey	 key;	 // Key for the hash table entry (see ht_key_ptr)
+	void	*value;	 // Pointer to the value associated with the key
+	size_t	 keylen; // Length of the key in bytes
+	uint64_t hash;	 // Full hash of the key, kept so resizing never rehashes keys
+} HtSlot;
+
+/**
+ * Hash function used by a table. Receives the key bytes, their length and the
+ * table's seed, and must spread entropy over all 64 bits of the result: the
+ * flat mode takes its tag from the low bits and its group from the bits above.
+ */
+typedef uint64_t (*HtHashFn)(const void *key, size_t keylen, uint64_t seed);
+
 // Struct definition for the hash table itself
 typedef struct HtTable {
 	HtNode **buckets;		// Array of pointers to linked list heads representing
 							// hash table buckets
-	unsigned bucket_count;	// Total number of buckets in the hash table
+	unsigned bucket_count;	// Total number of buckets (slots in flat mode) in the hash table
 	unsigned element_count; // Current number of key-value pairs in the hash table
+	HtMode		mode;		// Storage layout selected at initialization
+	HtAllocator allocator;	// Allocator for all of the table's storage
+	HtHashFn	hash_fn;	// Hash function applied to every key, ht_hash_wy by default
+	uint64_t	hash_seed;	// Seed passed to hash_fn
+	HtCounters	counters;	// Lookup hits and misses, only counted with HT_ENABLE_STATS
+	HtBloom	   *bloom;		// Filter of the keys, consulted before every lookup; NULL unless attached
+
+	// Chained mode only: incremental rehash state
+	HtNode **rehash_buckets;	  // Bucket array entries are migrating into, NULL when not rehashing
+	unsigned rehash_bucket_count; // Number of buckets in rehash_buckets
+	unsigned rehash_index;		  // Next bucket of `buckets` to migrate
+
+	// Flat mode only
+	signed char *ctrl;			 // One control byte per slot: empty, deleted or a 7-bit hash tag
+	HtSlot		*slots;			 // Slot array, bucket_count entries
+	unsigned	 tombstone_count; // Number of slots marked deleted
 } HtTable;
 
+// Hash functions that can be selected with ht_set_hash_fn (see hash64.h)
+uint64_t ht_hash_wy(const void *key, size_t keylen, uint64_t seed);		   // Default; fastest on short keys
+uint64_t ht_hash_xxh(const void *key, size_t keylen, uint64_t seed);	   // SIMD stripes for keys over 128 bytes
+uint64_t ht_hash_crc(const void *key, size_t keylen, uint64_t seed);	   // CRC32C instructions with SSE4.2
+uint64_t ht_hash_fnv1a(const void *key, size_t keylen, uint64_t seed);	   // 64-bit FNV-1a, byte at a time
+uint64_t ht_hash_shift_add(const void *key, size_t keylen, uint64_t seed); // The old hash_key_s; poor distribution
+
 // Function prototypes for hash table operations
 
 /**
  * Initializes a hash table with the specified number of buckets. Allocates
  * memory for the buckets and sets the initial element count to zero.
  *
+ * The table grows on its own: once element_count exceeds bucket_count, a
+ * bucket array twice the size is allocated and every later operation migrates
+ * a few buckets into it, so no single call pays for a full rehash.
+ *
  * @param tab Pointer to the hash table to be initialized.
  * @param bucket_count Number of buckets to create in the hash table.
  */
 void ht_init_table(HtTable *tab, unsigned bucket_count);
 
+/**
+ * Initializes a hash table like ht_init_table, taking all of its storage from
+ * the given allocator, except an attached Bloom filter (see ht_attach_bloom).
+ * An allocator with a `release` callback (such as one from ht_pool_allocator)
+ * lets ht_deinit_table free everything in bulk.
+ *
+ * @param tab Pointer to the hash table to be initialized.
+ * @param bucket_count Number of buckets to create in the hash table.
+ * @param allocator Allocator to copy into the table, or NULL for htmalloc/htfree.
+ */
+void ht_init_table_with_allocator(HtTable *tab, unsigned bucket_count, const HtAllocator *allocator);
+
+/**
+ * Initializes a flat, open-addressing hash table able to hold at least
+ * `capacity` entries before it first grows. Entries live in a single slot
+ * array next to a control array of 1-byte hash tags, which lookups scan
+ * HT_GROUP_WIDTH slots at a time (with SSE2 where available). The table grows
+ * automatically, and every other ht_* function works on it unchanged.
+ *
+ * If the slot array cannot be allocated, the table starts without one: it
+ * reads as empty, and the first ht_emplace tries the allocation again.
+ *
+ * @param tab Pointer to the hash table to be initialized.
+ * @param capacity Number of entries to make room for up front.
+ */
+void ht_init_table_flat(HtTable *tab, unsigned capacity);
+
+/**
+ * Initializes a flat hash table like ht_init_table_flat, taking all of its
+ * storage from the given allocator, except an attached Bloom filter (see
+ * ht_attach_bloom).
+ *
+ * @param tab Pointer to the hash table to be initialized.
+ * @param capacity Number of entries to make room for up front.
+ * @param allocator Allocator to copy into the table, or NULL for htmalloc/htfree.
+ */
+void ht_init_table_flat_with_allocator(HtTable *tab, unsigned capacity, const HtAllocator *allocator);
+
+/**
+ * Selects the hash function and seed of a table. Only an empty table can
+ * change its hash function, since stored entries keep their hashes.
+ *
+ * @param tab Pointer to the hash table.
+ * @param hash_fn Hash function to use, or NULL for ht_hash_wy.
+ * @param seed Seed passed to every call of `hash_fn`.
+ * @return True on success, false if the table is not empty.
+ */
+bool ht_set_hash_fn(HtTable *tab, HtHashFn hash_fn, uint64_t seed);
+
 /**
  * Inserts a key-value pair into the hash table. If the key already exists, the
  * existing value will be updated.
@@ -70,6 +192,17 @@ bool ht_emplace_s(HtTable *tab, void *key, size_t keylen, void *value);
  */
 bool ht_delete(HtTable *tab, void *key);
 
+/**
+ * Deletes a key-value pair from the hash table using a specified key size.
+ * The key may contain any bytes, including embedded null characters.
+ *
+ * @param tab Pointer to the hash table.
+ * @param key Pointer to the key to delete.
+ * @param keylen The length in bytes of the key.
+ * @return True if the deletion is successful, false if the key was not found.
+ */
+bool ht_delete_s(HtTable *tab, void *key, size_t keylen);
+
 /**
  * Searches for a value associated with a given key in the hash table.
  * If the key is not found, NULL is returned.
@@ -83,24 +216,82 @@ void *ht_search(HtTable *tab, void *key);
 
 /**
  * Searches for a value associated with a given key in the hash table.
- * This function uses a specified key length for comparison. If the key
+ * This function uses a specified key length for hashing and comparison, so
+ * only a stored key of exactly `keylen` matching bytes is found. If the key
  * is not found, NULL is returned.
  *
  * @param tab Pointer to the hash table.
- * @param key Pointer to the key to search for (should be a string).
- * @param keylen Length of the key to be compared.
+ * @param key Pointer to the key to search for (any bytes).
+ * @param keylen Length of the key in bytes.
  * @return Pointer to the value associated with the key, or NULL if not found.
  */
 void *ht_search_s(HtTable *tab, void *key, size_t keylen);
 
+/**
+ * Looks up `n` null-terminated keys at once, storing the value of keys[i] (or
+ * NULL if it is absent) in out_values[i]. The keys are hashed and their
+ * buckets prefetched a batch at a time before any of them is resolved, so the
+ * cache misses of different keys overlap instead of being paid one after
+ * another. Worth it whenever a table is larger than the cache.
+ *
+ * @param tab Pointer to the hash table.
+ * @param keys Array of `n` keys to search for.
+ * @param n Number of keys.
+ * @param out_values Array of `n` results.
+ */
+void ht_search_batch(HtTable *tab, char *const *keys, size_t n, void **out_values);
+
+/**
+ * Looks up `n` sized keys at once, like ht_search_batch.
+ *
+ * @param tab Pointer to the hash table.
+ * @param keys Array of `n` pointers to keys (any bytes).
+ * @param keylens Array of `n` key lengths in bytes.
+ * @param n Number of keys.
+ * @param out_values Array of `n` results.
+ */
+void ht_search_batch_s(HtTable *tab, void *const *keys, const size_t *keylens, size_t n, void **out_values);
+
 /**
  * Deinitializes a hash table, freeing all allocated resources. This includes
- * the memory for keys, values, and the nodes in the linked lists.
+ * the memory for keys, values, and the nodes in the linked lists. When the
+ * table's allocator has a `release` callback, it is called once instead.
  *
  * @param tab Pointer to the hash table to deinitialize.
  */
 void ht_deinit_table(HtTable *tab);
 
+/**
+ * Migrates up to `n` buckets of an in-progress incremental rehash. Useful to
+ * finish a migration during idle time instead of spreading it over later
+ * operations. Flat tables never rehash incrementally.
+ *
+ * @param tab Pointer to the hash table.
+ * @param n Maximum number of non-empty buckets to migrate.
+ * @return True if buckets are still left to migrate, false otherwise.
+ */
+bool ht_rehash_step(HtTable *tab, unsigned n);
+
+/**
+ * Grows the table so that it holds at least `count` entries without growing
+ * again. Unlike automatic growth, the rehash completes before returning, so
+ * call it at load time rather than mid-frame.
+ *
+ * @param tab Pointer to the hash table.
+ * @param count Number of entries to make room for.
+ * @return True on success, false if the new storage could not be allocated.
+ */
+bool ht_reserve(HtTable *tab, unsigned count);
+
+/**
+ * Shrinks the table to the smallest size that holds its current entries
+ * under the maximum load factor. The rehash completes before returning.
+ *
+ * @param tab Pointer to the hash table.
+ * @return True on success, false if the new storage could not be allocated.
+ */
+bool ht_shrink_to_fit(HtTable *tab);
+
 /**
  * Checks if a key exists in the hash table.
  * This function returns true if the key is found, and false otherwise.
@@ -111,4 +302,69 @@ void ht_deinit_table(HtTable *tab);
  */
 bool ht_has(HtTable *tab, void *key);
 
+/**
+ * Returns the number of bytes the table has allocated: bucket or slot arrays,
+ * nodes, key copies too long to be stored inline and the attached filter.
+ * Allocator bookkeeping overhead is not included.
+ *
+ * @param tab Pointer to the hash table.
+ * @return Total bytes allocated for the table's storage.
+ */
+size_t ht_memory_usage(const HtTable *tab);
+
+/**
+ * Reports the table's load factor, chain-length histogram (probe lengths in
+ * groups for flat tables), longest chain, memory per entry and, when built
+ * with HT_ENABLE_STATS, the lookup hit/miss counters. Walks the whole table.
+ *
+ * @param tab Pointer to the hash table.
+ * @param stats Receives the report.
+ */
+void ht_stats(const HtTable *tab, HtStats *stats);
+
+/**
+ * Resets the lookup hit/miss counters.
+ *
+ * @param tab Pointer to the hash table.
+ */
+void ht_stats_reset(HtTable *tab);
+
+/**
+ * Attaches a blocked Bloom filter (see htbloom.h) holding the hash of every
+ * key. Lookups, deletes and inserts of keys the filter rules out then return
+ * after reading one filter block, without touching buckets or chains, which
+ * pays off for chained tables when many lookups miss. A flat table already
+ * settles most misses in its first control group, so a filter there mostly
+ * adds a second memory access (see bench_bloom). The table keeps the filter
+ * up to date and rebuilds it as the table grows or after many deletes.
+ * Attaching again replaces the filter.
+ *
+ * The filter does not come from the table's HtAllocator: its blocks need
+ * 32-byte alignment, which allocator callbacks do not promise, so the filter
+ * and its blocks are always allocated with htmalloc and aligned_alloc.
+ * ht_detach_bloom and ht_deinit_table free them.
+ *
+ * @param tab Pointer to the hash table.
+ * @param bits_per_key Bits of filter per entry, or 0 for HT_BLOOM_BITS_PER_KEY.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool ht_attach_bloom(HtTable *tab, unsigned bits_per_key);
+
+/**
+ * Frees the table's filter, if any. ht_deinit_table does this as well.
+ *
+ * @param tab Pointer to the hash table.
+ */
+void ht_detach_bloom(HtTable *tab);
+
+/**
+ * Checks if a key of the specified size exists in the hash table.
+ *
+ * @param tab Pointer to the hash table.
+ * @param key Pointer to the key to check (any bytes).
+ * @param keylen The length in bytes of the key.
+ * @return True if the key exists in the hash table, false otherwise.
+ */
+bool ht_has_s(HtTable *tab, void *key, size_t keylen);
+
 #endif // HASHTABLE_H
\ No newline at end of file
@@ -1,9 +1,17 @@
 #ifndef HASHTABLE2_H
 #define HASHTABLE2_H
 
+#include "hashtable/htbloom.h"
+#include "hashtable/htstats.h"
+#include "prefetch.h"
 #include "stddef.h"
 #include "stdlib.h"
 
+// Number of keys TNAME##_get_batch hashes and prefetches before resolving any
+#ifndef HASHTABLE_BATCH_SIZE
+#define HASHTABLE_BATCH_SIZE 16
+#endif
+
 #define DEF_HASHTABLE(KEY_T, VAL_T, TNAME)                                                                             \
 	typedef struct TNAME##_node {                                                                                      \
 		KEY_T				 key;                                                                                      \
@@ -15,11 +23,76 @@
 	typedef struct {                                                                                                   \
 		TNAME##_node **table;                                                                                          \
 		size_t		   size;                                                                                           \
+		HtCounters	   counters;                                                                                       \
+		HtBloom		  *bloom;                                                                                          \
 	} TNAME;                                                                                                           \
                                                                                                                        \
+	void TNAME##_stats_reset(TNAME *ht) {                                                                              \
+		ht->counters.hits = 0;                                                                                         \
+		ht->counters.misses = 0;                                                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
 	void TNAME##_init(TNAME *ht, size_t size) {                                                                        \
 		ht->size = size;                                                                                               \
 		ht->table = calloc(size, sizeof(TNAME##_node *));                                                              \
+		ht->bloom = NULL;                                                                                              \
+		TNAME##_stats_reset(ht);                                                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	size_t TNAME##_entry_count(const TNAME *ht) {                                                                      \
+		size_t count = 0;                                                                                              \
+		for (size_t i = 0; i < ht->size; i++) {                                                                        \
+			for (TNAME##_node *current = ht->table[i]; current != NULL; current = current->pnext) {                    \
+				count++;                                                                                               \
+			}                                                                                                          \
+		}                                                                                                              \
+		return count;                                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	void TNAME##_bloom_add_all(TNAME *ht) {                                                                            \
+		for (size_t i = 0; i < ht->size; i++) {                                                                        \
+			for (TNAME##_node *current = ht->table[i]; current != NULL; current = current->pnext) {                    \
+				ht_bloom_add_hash(ht->bloom, current->key_hash);                                                       \
+			}                                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	void TNAME##_bloom_rebuild(TNAME *ht) {                                                                            \
+		if (ht_bloom_reset(ht->bloom, TNAME##_entry_count(ht) * 2)) {                                                  \
+			TNAME##_bloom_add_all(ht);                                                                                 \
+		} else {                                                                                                       \
+			ht_bloom_postpone(ht->bloom);                                                                              \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_bloom_deleted(TNAME *ht) {                                                              \
+		if (!ht->bloom) {                                                                                              \
+			return;                                                                                                    \
+		}                                                                                                              \
+		++(ht->bloom->removed);                                                                                        \
+		if (ht_bloom_stale(ht->bloom)) {                                                                               \
+			TNAME##_bloom_rebuild(ht);                                                                                 \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	void TNAME##_detach_bloom(TNAME *ht) {                                                                             \
+		if (ht->bloom) {                                                                                               \
+			ht_bloom_deinit(ht->bloom);                                                                                \
+			free(ht->bloom);                                                                                           \
+			ht->bloom = NULL;                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	bool TNAME##_attach_bloom(TNAME *ht, unsigned bits_per_key) {                                                      \
+		HtBloom *bloom = malloc(sizeof(HtBloom));                                                                      \
+		if (!bloom || !ht_bloom_init(bloom, TNAME##_entry_count(ht) * 2, bits_per_key)) {                              \
+			free(bloom);                                                                                               \
+			return false;                                                                                              \
+		}                                                                                                              \
+		TNAME##_detach_bloom(ht);                                                                                      \
+		ht->bloom = bloom;                                                                                             \
+		TNAME##_bloom_add_all(ht);                                                                                     \
+		return true;                                                                                                   \
 	}                                                                                                                  \
                                                                                                                        \
 	size_t TNAME##_hash_key(KEY_T key);                                                                                \
@@ -35,6 +108,11 @@
 		newNode->key_hash = hashValue;                                                                                 \
 		newNode->pnext = ht->table[index];                                                                             \
 		ht->table[index] = newNode;                                                                                    \
+		if (ht->bloom) {                                                                                               \
+			ht_bloom_add_hash(ht->bloom, hashValue);                                                                   \
+			if (ht_bloom_stale(ht->bloom))                                                                             \
+				TNAME##_bloom_rebuild(ht);                                                                             \
+		}                                                                                                              \
 	}                                                                                                                  \
 	void TNAME##_delete(TNAME *ht, KEY_T key) {                                                                        \
 		size_t		  hashValue = TNAME##_hash_key(key);                                                               \
@@ -49,6 +127,7 @@
 					ht->table[index] = current->pnext;                                                                 \
 				}                                                                                                      \
 				free(current);                                                                                         \
+				TNAME##_bloom_deleted(ht);                                                                             \
 				return;                                                                                                \
 			}                                                                                                          \
 			prev = current;                                                                                            \
@@ -57,19 +136,77 @@
 	}                                                                                                                  \
                                                                                                                        \
 	VAL_T *TNAME##_get(TNAME *ht, KEY_T key) {                                                                         \
-		size_t		  hashValue = TNAME##_hash_key(key);                                                               \
+		size_t hashValue = TNAME##_hash_key(key);                                                                      \
+		if (ht->bloom && !ht_bloom_may_contain_hash(ht->bloom, hashValue)) {                                           \
+			HT_STATS_COUNT(ht->counters, 0);                                                                           \
+			return NULL;                                                                                               \
+		}                                                                                                              \
 		size_t		  index = hashValue % ht->size;                                                                    \
 		TNAME##_node *current = ht->table[index];                                                                      \
 		while (current != NULL) {                                                                                      \
 			if (current->key_hash == hashValue && current->key == key) {                                               \
+				HT_STATS_COUNT(ht->counters, 1);                                                                       \
 				return &(current->value);                                                                              \
 			}                                                                                                          \
 			current = current->pnext;                                                                                  \
 		}                                                                                                              \
+		HT_STATS_COUNT(ht->counters, 0);                                                                               \
 		return NULL;                                                                                                   \
 	}                                                                                                                  \
                                                                                                                        \
+	void TNAME##_get_batch(TNAME *ht, const KEY_T *keys, size_t n, VAL_T **out) {                                      \
+		size_t hashes[HASHTABLE_BATCH_SIZE];                                                                           \
+		bool   absent[HASHTABLE_BATCH_SIZE];                                                                           \
+		for (size_t base = 0; base < n; base += HASHTABLE_BATCH_SIZE) {                                                \
+			size_t count = n - base < HASHTABLE_BATCH_SIZE ? n - base : HASHTABLE_BATCH_SIZE;                          \
+			for (size_t i = 0; i < count; ++i) {                                                                       \
+				hashes[i] = TNAME##_hash_key(keys[base + i]);                                                          \
+				absent[i] = ht->bloom && !ht_bloom_may_contain_hash(ht->bloom, hashes[i]);                             \
+				if (!absent[i]) {                                                                                      \
+					PREFETCH(&ht->table[hashes[i] % ht->size]);                                                        \
+				}                                                                                                      \
+			}                                                                                                          \
+			for (size_t i = 0; i < count; ++i) {                                                                       \
+				TNAME##_node *head = absent[i] ? NULL : ht->table[hashes[i] % ht->size];                               \
+				if (head) {                                                                                            \
+					PREFETCH(head);                                                                                    \
+				}                                                                                                      \
+			}                                                                                                          \
+			for (size_t i = 0; i < count; ++i) {                                                                       \
+				TNAME##_node *current = absent[i] ? NULL : ht->table[hashes[i] % ht->size];                            \
+				while (current != NULL && !(current->key_hash == hashes[i] && current->key == keys[base + i])) {       \
+					current = current->pnext;                                                                          \
+				}                                                                                                      \
+				HT_STATS_COUNT(ht->counters, current != NULL);                                                         \
+				out[base + i] = current ? &(current->value) : NULL;                                                    \
+			}                                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	void TNAME##_stats(const TNAME *ht, HtStats *stats) {                                                              \
+		*stats = (HtStats){0};                                                                                         \
+		size_t visits = 0;                                                                                             \
+		for (size_t i = 0; i < ht->size; i++) {                                                                        \
+			size_t length = 0;                                                                                         \
+			for (TNAME##_node *current = ht->table[i]; current != NULL; current = current->pnext) {                    \
+				visits += ++length;                                                                                    \
+			}                                                                                                          \
+			++stats->histogram[length < HT_STATS_HISTOGRAM ? length : HT_STATS_HISTOGRAM - 1];                         \
+			stats->max_chain = length > stats->max_chain ? length : stats->max_chain;                                  \
+			stats->entries += length;                                                                                  \
+		}                                                                                                              \
+		stats->buckets = ht->size;                                                                                     \
+		stats->load_factor = ht->size ? (double) stats->entries / ht->size : 0;                                        \
+		stats->avg_probe = stats->entries ? (double) visits / stats->entries : 0;                                      \
+		stats->bytes = sizeof(TNAME##_node *) * ht->size + sizeof(TNAME##_node) * stats->entries +                     \
+					   ht_bloom_memory_usage(ht->bloom);                                                               \
+		stats->bytes_per_entry = stats->entries ? (double) stats->bytes / stats->entries : 0;                          \
+		stats->hits = ht->counters.hits;                                                                               \
+		stats->misses = ht->counters.misses;                                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
 	void TNAME##_deinit(TNAME *ht) {                                                                                   \
+		TNAME##_detach_bloom(ht);                                                                                      \
 		for (size_t i = 0; i < ht->size; i++) {                                                                        \
 			TNAME##_node *current = ht->table[i];                                                                      \
 			while (current != NULL) {                                                                                  \
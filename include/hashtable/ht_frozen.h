@@ -0,0 +1,139 @@
+#ifndef HT_FROZEN_H
+#define HT_FROZEN_H
+
+#include "hashtable/hashtable.h"
+#include <stdbool.h> // bool type
+#include <stddef.h>	 // Standard definitions (e.g., size_t)
+#include <stdint.h>	 // Fixed-width integer types
+
+/**
+ * @file ht_frozen.h
+ * @brief Read-only tables built from an HtTable with a minimal perfect hash.
+ *
+ * ht_freeze turns a populated HtTable into one contiguous image: a CHD
+ * (compress, hash and displace) perfect hash maps the n keys onto n slots
+ * without collisions, so a lookup costs two hash evaluations, one slot read
+ * and one key comparison, with no probing. The image needs no parsing: it can
+ * be written to a file, mapped with ht_frozen_open and queried in place.
+ *
+ * Values are copied into the image as `value_size` bytes each, since the
+ * HtTable's value pointers mean nothing in another process. Images use the
+ * host's byte order and are not portable across endianness.
+ */
+
+#define HT_FROZEN_MAGIC "HTFROZ1"
+
+// Header at the start of every image. Offsets are from the start of the image.
+typedef struct HtFrozenHeader {
+	char	 magic[8];		// HT_FROZEN_MAGIC, null-terminated
+	uint32_t value_size;	// Bytes stored per value
+	uint32_t reserved;		// Zero
+	uint64_t count;			// Number of keys, equal to the number of slots
+	uint64_t bucket_count;	// Number of displacement buckets
+	uint64_t seed;			// Seed of the key hash
+	uint64_t disp_offset;	// uint32_t[2] per bucket: displacement pair (d0, d1)
+	uint64_t slots_offset;	// HtFrozenSlot per slot
+	uint64_t values_offset; // value_size bytes per slot, 8-byte aligned
+	uint64_t keys_offset;	// Key bytes, each followed by a null terminator
+	uint64_t size;			// Total size of the image in bytes
+} HtFrozenHeader;
+
+// Slot of a frozen table, locating the one key that hashes to it
+typedef struct HtFrozenSlot {
+	uint32_t fingerprint; // Bits of the key hash, checked before the key bytes
+	uint32_t keylen;	  // Length of the key in bytes
+	uint64_t key_offset;  // Offset of the key bytes from keys_offset
+} HtFrozenSlot;
+
+// Frozen table opened for lookups
+typedef struct HtFrozen {
+	const HtFrozenHeader *header; // Start of the image
+	const uint32_t		 *disp;	  // Displacement pairs
+	const HtFrozenSlot	 *slots;  // Slot array
+	const unsigned char	 *values; // Value array
+	const char			 *keys;	  // Key blob
+	void				 *owned;  // Mapping or buffer released by ht_frozen_close, NULL if borrowed
+	size_t				  owned_size; // Size of `owned`
+	bool				  mapped;	  // True if `owned` is a memory mapping
+} HtFrozen;
+
+/**
+ * Encodes one value of the table into `value_size` bytes of the image.
+ *
+ * @param ctx Context passed to ht_freeze.
+ * @param key Key of the entry.
+ * @param keylen Length of the key in bytes.
+ * @param value Value pointer stored in the HtTable.
+ * @param out Destination of `value_size` bytes.
+ */
+typedef void (*HtFreezeValueFn)(void *ctx, const char *key, size_t keylen, void *value, void *out);
+
+/**
+ * Builds a frozen image of every entry in `tab`. The table is not modified.
+ *
+ * @param tab Pointer to the hash table to freeze (either mode).
+ * @param value_size Bytes stored per value, 0 to store keys only.
+ * @param encode Writes each value into the image, or NULL to copy `value_size`
+ *               bytes from the address each value pointer holds.
+ * @param ctx Context passed to `encode`.
+ * @param out_image Receives the image, allocated with htmalloc; free it with htfree.
+ * @param out_size Receives the size of the image in bytes.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool ht_freeze(HtTable *tab, size_t value_size, HtFreezeValueFn encode, void *ctx, void **out_image,
+			   size_t *out_size);
+
+/**
+ * Builds a frozen image like ht_freeze and writes it to a file.
+ *
+ * @param path Path of the file to create or replace.
+ * @return True on success, false on allocation or I/O failure.
+ */
+bool ht_freeze_to_file(HtTable *tab, size_t value_size, HtFreezeValueFn encode, void *ctx, const char *path);
+
+/**
+ * Opens a frozen image held in memory, without copying it. The memory must
+ * stay valid and 8-byte aligned while the table is in use.
+ *
+ * @param frozen Pointer to the frozen table to initialize.
+ * @param image Start of the image.
+ * @param size Size of the image in bytes.
+ * @return True on success, false if the image is malformed.
+ */
+bool ht_frozen_open_memory(HtFrozen *frozen, const void *image, size_t size);
+
+/**
+ * Opens a frozen image file by mapping it read-only into memory. Where
+ * mapping is unavailable, the file is read into a buffer instead.
+ *
+ * @param frozen Pointer to the frozen table to initialize.
+ * @param path Path of a file written by ht_freeze_to_file.
+ * @return True on success, false on I/O failure or a malformed file.
+ */
+bool ht_frozen_open(HtFrozen *frozen, const char *path);
+
+/**
+ * Releases the mapping or buffer of a frozen table opened from a file.
+ *
+ * @param frozen Pointer to the frozen table.
+ */
+void ht_frozen_close(HtFrozen *frozen);
+
+/**
+ * Searches a frozen table for a key.
+ *
+ * @param frozen Pointer to the frozen table.
+ * @param key Pointer to the key (any bytes).
+ * @param keylen Length of the key in bytes.
+ * @return Pointer to the key's `value_size` value bytes inside the image, or
+ *         NULL if the key is absent. With value_size 0, a non-NULL pointer
+ *         still marks a key that is present.
+ */
+const void *ht_frozen_search_s(const HtFrozen *frozen, const void *key, size_t keylen);
+
+/**
+ * Searches a frozen table for a null-terminated key, like ht_frozen_search_s.
+ */
+const void *ht_frozen_search(const HtFrozen *frozen, const char *key);
+
+#endif // HT_FROZEN_H
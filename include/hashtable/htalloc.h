@@ -0,0 +1,149 @@
+#ifndef HTALLOC_H
+#define HTALLOC_H
+
+#include "stddef.h" // Standard definitions (e.g., size_t)
+
+/**
+ * Allocator used by a hash table for all of its storage: bucket and slot
+ * arrays, nodes and long key copies.
+ *
+ * `free` receives the size that was passed to the matching `alloc`, so an
+ * allocator can route blocks by size without storing a header per block.
+ * `release` is optional; when set, it must free every block the allocator
+ * has handed out, and ht_deinit_table calls it instead of freeing entries one
+ * by one. An allocator with `release` must therefore serve a single table.
+ */
+typedef struct HtAllocator {
+	void *(*alloc)(void *ctx, size_t size);			// Returns NULL on failure
+	void  (*free)(void *ctx, void *p, size_t size); // Never called with NULL
+	void  (*release)(void *ctx);					// Optional bulk free, may be NULL
+	void *ctx;										// Passed to every callback
+} HtAllocator;
+
+/**
+ * Fixed-size object allocator. Objects are carved out of large chunks and
+ * freed objects are reused through an intrusive free list.
+ */
+typedef struct HtSlab {
+	size_t object_size;		  // Size of each object, rounded up for alignment
+	size_t objects_per_chunk; // Objects carved out of each chunk
+	void  *free_list;		  // Freed objects, linked through their first word
+	void  *chunks;			  // Allocated chunks, linked through their header
+	char  *bump;			  // Next never-used object in the newest chunk
+	char  *bump_end;		  // End of the newest chunk
+} HtSlab;
+
+/**
+ * Bump allocator. Allocation is a pointer increment inside the current block;
+ * individual frees are not supported and memory comes back all at once with
+ * ht_arena_release.
+ */
+typedef struct HtArena {
+	void  *blocks;	   // Allocated blocks, newest first, linked through their header
+	char  *bump;	   // Next free byte in the newest block
+	char  *bump_end;   // End of the newest block
+	size_t block_size; // Usable bytes in a regular block
+} HtArena;
+
+/**
+ * Per-table pool combining a slab for HtNodes, an arena for other small
+ * blocks (mostly long keys) and tracked heap blocks for large arrays.
+ * Deinitializing a table that uses the pool frees whole chunks and blocks
+ * instead of walking every chain.
+ *
+ * Small blocks freed before the table is deinitialized (deleted long keys)
+ * are only reclaimed by the release, so the pool suits tables that are built
+ * up and torn down as a whole.
+ */
+typedef struct HtPool {
+	HtSlab	nodes; // HtNode-sized blocks
+	HtArena small; // Other blocks up to HT_POOL_SMALL_MAX bytes
+	void   *large; // Larger blocks, individually malloc'd and doubly linked
+} HtPool;
+
+// Largest block an HtPool serves from its arena
+#define HT_POOL_SMALL_MAX 256
+
+/**
+ * Initializes a slab for objects of `object_size` bytes.
+ *
+ * @param slab Pointer to the slab to initialize.
+ * @param object_size Size in bytes of every object.
+ * @param objects_per_chunk Number of objects allocated together.
+ */
+void ht_slab_init(HtSlab *slab, size_t object_size, size_t objects_per_chunk);
+
+/**
+ * Allocates one object from the slab.
+ *
+ * @param slab Pointer to the slab.
+ * @return Pointer to the object, or NULL if a new chunk could not be allocated.
+ */
+void *ht_slab_alloc(HtSlab *slab);
+
+/**
+ * Returns an object to the slab for reuse.
+ *
+ * @param slab Pointer to the slab the object came from.
+ * @param p Pointer to the object.
+ */
+void ht_slab_free(HtSlab *slab, void *p);
+
+/**
+ * Frees every chunk of the slab. All objects become invalid; the slab stays
+ * initialized and can be used again.
+ *
+ * @param slab Pointer to the slab.
+ */
+void ht_slab_release(HtSlab *slab);
+
+/**
+ * Initializes an arena that allocates blocks of `block_size` bytes at a time.
+ *
+ * @param arena Pointer to the arena to initialize.
+ * @param block_size Usable bytes per block; larger requests get their own block.
+ */
+void ht_arena_init(HtArena *arena, size_t block_size);
+
+/**
+ * Allocates `size` bytes from the arena, aligned for any type.
+ *
+ * @param arena Pointer to the arena.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the memory, or NULL if a new block could not be allocated.
+ */
+void *ht_arena_alloc(HtArena *arena, size_t size);
+
+/**
+ * Frees every block of the arena. All allocations become invalid; the arena
+ * stays initialized and can be used again.
+ *
+ * @param arena Pointer to the arena.
+ */
+void ht_arena_release(HtArena *arena);
+
+/**
+ * Initializes a pool for use by one hash table.
+ *
+ * @param pool Pointer to the pool to initialize.
+ */
+void ht_pool_init(HtPool *pool);
+
+/**
+ * Frees everything the pool still holds. Call it after the table using the
+ * pool has been deinitialized (which already releases the pool) or abandoned.
+ *
+ * @param pool Pointer to the pool.
+ */
+void ht_pool_deinit(HtPool *pool);
+
+/**
+ * Returns an allocator that serves a table from the pool. Pass it to
+ * ht_init_table_with_allocator or ht_init_table_flat_with_allocator.
+ *
+ * @param pool Pointer to the pool, which must outlive the table.
+ * @return Allocator whose context is the pool.
+ */
+HtAllocator ht_pool_allocator(HtPool *pool);
+
+#endif // HTALLOC_H
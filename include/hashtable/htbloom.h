@@ -0,0 +1,248 @@
+#ifndef HTBLOOM_H
+#define HTBLOOM_H
+
+#include "hashtable/hash64.h" // Key hashing and hash remixing
+#include <stdbool.h>		  // bool type
+#include <stddef.h>			  // Standard definitions (e.g., size_t)
+#include <stdint.h>			  // Fixed-width integer types
+#include <stdlib.h>			  // aligned_alloc, free
+#include <string.h>			  // memset
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @file htbloom.h
+ * @brief Blocked Bloom filter answering "definitely absent" from one cache line.
+ *
+ * The filter is an array of 256-bit blocks. A key selects one block with the
+ * high bits of its hash and sets one bit in each of the block's eight 32-bit
+ * words, so adding or testing a key reads a single block (a split block
+ * Bloom filter). With AVX2 the eight bit positions are computed and tested
+ * in one vector; other builds loop over the words.
+ *
+ * At the default HT_BLOOM_BITS_PER_KEY a filter holding its full capacity
+ * answers about 0.6% of absent keys with a false "maybe"; the block count is
+ * rounded up to a power of two, so the real rate is often lower. Keys cannot be
+ * removed from a Bloom filter; owners that delete keys count the deletions and
+ * rebuild the filter from their live entries once ht_bloom_stale says so.
+ *
+ * A filter can be used on its own (ht_bloom_add / ht_bloom_may_contain) or
+ * attached to an HtTable (ht_attach_bloom) or a DEF_HASHTABLE
+ * (TNAME##_attach_bloom), whose lookups then skip the table for keys the
+ * filter rules out.
+ */
+
+// Bits of filter per key of capacity when 0 is passed to ht_bloom_init
+#define HT_BLOOM_BITS_PER_KEY 12
+
+// Capacity below which filters are not shrunk on rebuild
+#define HT_BLOOM_MIN_CAPACITY 64
+
+// One filter block: eight words, one bit set in each per key
+typedef struct HtBloomBlock {
+	_Alignas(32) uint32_t words[8];
+} HtBloomBlock;
+
+// Struct definition for the filter
+typedef struct HtBloom {
+	HtBloomBlock *blocks;		// Block array, 32-byte aligned
+	size_t		  block_mask;	// Number of blocks minus one; the count is a power of two
+	size_t		  capacity;		// Keys the filter was sized for
+	size_t		  count;		// Keys added since the last clear
+	size_t		  removed;		// Deletions reported by the owner since the last clear
+	unsigned	  bits_per_key; // Bits of filter per key of capacity
+} HtBloom;
+
+// Odd multipliers picking the bit of each word (from the Parquet split block filter)
+static const uint32_t ht_bloom_salts[8] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+										   0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+// Remixes a key hash so that weak hashes (such as the identity on integers)
+// still spread over blocks and bits
+static inline uint64_t ht_bloom_remix(uint64_t hash) {
+	return hash64_mix(hash ^ HASH64_S0, HASH64_S1);
+}
+
+static inline HtBloomBlock *ht_bloom_block(const HtBloom *bloom, uint64_t mixed) {
+	return &bloom->blocks[(size_t) (mixed >> 32) & bloom->block_mask];
+}
+
+/**
+ * Sizes an empty filter for `capacity` keys, keeping its bits per key.
+ *
+ * @param bloom Pointer to an initialized filter.
+ * @param capacity Number of keys to size the filter for.
+ * @return True on success, false if memory could not be allocated (the filter
+ *         is then unchanged).
+ */
+static inline bool ht_bloom_reset(HtBloom *bloom, size_t capacity) {
+	if (capacity < HT_BLOOM_MIN_CAPACITY) {
+		capacity = HT_BLOOM_MIN_CAPACITY;
+	}
+	size_t blocks = 1;
+	while (blocks * 256 < capacity * bloom->bits_per_key) {
+		blocks *= 2;
+	}
+	if (blocks != bloom->block_mask + 1 || !bloom->blocks) {
+		HtBloomBlock *fresh = aligned_alloc(_Alignof(HtBloomBlock), blocks * sizeof(HtBloomBlock));
+		if (!fresh) {
+			return false;
+		}
+		free(bloom->blocks);
+		bloom->blocks = fresh;
+		bloom->block_mask = blocks - 1;
+	}
+	memset(bloom->blocks, 0, blocks * sizeof(HtBloomBlock));
+	bloom->capacity = capacity;
+	bloom->count = 0;
+	bloom->removed = 0;
+	return true;
+}
+
+/**
+ * Initializes an empty filter.
+ *
+ * @param bloom Pointer to the filter to initialize.
+ * @param capacity Number of keys the filter should hold at its target
+ *                 false-positive rate; more can be added at a higher rate.
+ * @param bits_per_key Bits of filter per key of capacity, or 0 for
+ *                     HT_BLOOM_BITS_PER_KEY. 8 gives about 3% false
+ *                     positives, 16 about 0.15%.
+ * @return True on success, false if memory could not be allocated.
+ */
+static inline bool ht_bloom_init(HtBloom *bloom, size_t capacity, unsigned bits_per_key) {
+	bloom->blocks = NULL;
+	bloom->block_mask = 0;
+	bloom->bits_per_key = bits_per_key ? bits_per_key : HT_BLOOM_BITS_PER_KEY;
+	return ht_bloom_reset(bloom, capacity);
+}
+
+/**
+ * Frees the filter's blocks.
+ *
+ * @param bloom Pointer to the filter.
+ */
+static inline void ht_bloom_deinit(HtBloom *bloom) {
+	free(bloom->blocks);
+	bloom->blocks = NULL;
+	bloom->block_mask = 0;
+	bloom->capacity = bloom->count = bloom->removed = 0;
+}
+
+/**
+ * Removes every key from the filter, keeping its size.
+ *
+ * @param bloom Pointer to the filter.
+ */
+static inline void ht_bloom_clear(HtBloom *bloom) {
+	memset(bloom->blocks, 0, (bloom->block_mask + 1) * sizeof(HtBloomBlock));
+	bloom->count = 0;
+	bloom->removed = 0;
+}
+
+#if defined(__AVX2__)
+// One bit per 32-bit lane, selected by the salted low half of the hash
+static inline __m256i ht_bloom_mask(uint64_t mixed) {
+	__m256i salts = _mm256_loadu_si256((const __m256i *) ht_bloom_salts);
+	__m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int) (uint32_t) mixed), salts), 27);
+	return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+}
+#endif
+
+/**
+ * Adds a key to the filter by its 64-bit hash. Any hash works, including
+ * the identity on integer keys; the filter remixes it.
+ *
+ * @param bloom Pointer to the filter.
+ * @param hash Hash of the key.
+ */
+static inline void ht_bloom_add_hash(HtBloom *bloom, uint64_t hash) {
+	uint64_t	  mixed = ht_bloom_remix(hash);
+	HtBloomBlock *block = ht_bloom_block(bloom, mixed);
+#if defined(__AVX2__)
+	__m256i words = _mm256_load_si256((const __m256i *) block->words);
+	_mm256_store_si256((__m256i *) block->words, _mm256_or_si256(words, ht_bloom_mask(mixed)));
+#else
+	for (int i = 0; i < 8; ++i) {
+		block->words[i] |= 1u << (((uint32_t) mixed * ht_bloom_salts[i]) >> 27);
+	}
+#endif
+	++(bloom->count);
+}
+
+/**
+ * Tests a key by its 64-bit hash, as passed to ht_bloom_add_hash.
+ *
+ * @param bloom Pointer to the filter.
+ * @param hash Hash of the key.
+ * @return False if the key was definitely never added, true if it may have been.
+ */
+static inline bool ht_bloom_may_contain_hash(const HtBloom *bloom, uint64_t hash) {
+	uint64_t			mixed = ht_bloom_remix(hash);
+	const HtBloomBlock *block = ht_bloom_block(bloom, mixed);
+#if defined(__AVX2__)
+	return _mm256_testc_si256(_mm256_load_si256((const __m256i *) block->words), ht_bloom_mask(mixed));
+#else
+	uint32_t missing = 0;
+	for (int i = 0; i < 8; ++i) {
+		missing |= ~block->words[i] & (1u << (((uint32_t) mixed * ht_bloom_salts[i]) >> 27));
+	}
+	return missing == 0;
+#endif
+}
+
+/**
+ * Adds a key given as bytes, hashed with hash64_wy.
+ *
+ * @param bloom Pointer to the filter.
+ * @param key Pointer to the key (any bytes).
+ * @param keylen Length of the key in bytes.
+ */
+static inline void ht_bloom_add(HtBloom *bloom, const void *key, size_t keylen) {
+	ht_bloom_add_hash(bloom, hash64_wy(key, keylen, 0));
+}
+
+/**
+ * Tests a key given as bytes, like ht_bloom_may_contain_hash.
+ */
+static inline bool ht_bloom_may_contain(const HtBloom *bloom, const void *key, size_t keylen) {
+	return ht_bloom_may_contain_hash(bloom, hash64_wy(key, keylen, 0));
+}
+
+/**
+ * Tells an owner that deletes keys when to rebuild its filter: once more keys
+ * were added than the filter was sized for, or once over half of the keys
+ * added have since been deleted (their bits only raise the false-positive
+ * rate).
+ *
+ * @param bloom Pointer to the filter.
+ * @return True if the filter should be rebuilt from the live keys.
+ */
+static inline bool ht_bloom_stale(const HtBloom *bloom) {
+	return bloom->count > bloom->capacity || bloom->removed * 2 > bloom->count;
+}
+
+/**
+ * Puts off the next rebuild of a stale filter whose rebuild could not
+ * allocate memory, so that the owner does not retry on every operation. The
+ * filter stays correct, only less selective.
+ *
+ * @param bloom Pointer to the filter.
+ */
+static inline void ht_bloom_postpone(HtBloom *bloom) {
+	bloom->capacity = bloom->count * 2;
+	bloom->removed = 0;
+}
+
+/**
+ * Returns the number of bytes the filter has allocated, including the struct.
+ *
+ * @param bloom Pointer to the filter, or NULL.
+ */
+static inline size_t ht_bloom_memory_usage(const HtBloom *bloom) {
+	return bloom ? sizeof(HtBloom) + (bloom->block_mask + 1) * sizeof(HtBloomBlock) : 0;
+}
+
+#endif // HTBLOOM_H
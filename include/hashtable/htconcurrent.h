@@ -0,0 +1,166 @@
+#ifndef HTCONCURRENT_H
+#define HTCONCURRENT_H
+
+#include <pthread.h>   // Writer locks
+#include <stdatomic.h> // Lock-free reads
+#include <stdbool.h>   // bool type
+#include <stddef.h>	   // Standard definitions (e.g., size_t)
+#include <stdint.h>	   // Fixed-width integer types (uint64_t)
+
+/**
+ * @file htconcurrent.h
+ * @brief Hash table shared between threads.
+ *
+ * The key space is split into shards by hash. Writers lock the one shard
+ * they modify, so writers to different shards run in parallel. Readers take
+ * no lock at all: they walk the chains through atomic pointers while
+ * announcing themselves in an epoch slot, and memory unlinked by a writer is
+ * only freed once every reader that could still see it has left
+ * (epoch-based reclamation). A reader therefore never waits for a writer.
+ *
+ * Keys are copied into the table; values are opaque pointers owned by the
+ * caller. htc_search returns the value a key had at some point during the
+ * call.
+ */
+
+// Number of readers that can be inside the table at the same time; further
+// readers spin until a slot frees up
+#ifndef HTC_READER_SLOTS
+#define HTC_READER_SLOTS 128
+#endif
+
+#define HTC_CACHE_LINE 64
+
+// Entry of a concurrent table. Key bytes follow the struct and never change.
+typedef struct HtcNode {
+	struct HtcNode *_Atomic	next;	// Next node in the chain
+	void *_Atomic			value;	// Value associated with the key
+	uint64_t				hash;	// Full hash of the key
+	size_t					keylen;	// Length of the key in bytes
+	char					key[];	// Key bytes, followed by a null terminator
+} HtcNode;
+
+// Bucket array of a shard, replaced as a whole when the shard grows
+typedef struct HtcBuckets {
+	unsigned		 count;	  // Number of buckets, a power of two
+	HtcNode *_Atomic heads[]; // Chain heads
+} HtcBuckets;
+
+// Memory a writer has unlinked, waiting until no reader can still reach it
+typedef struct HtcRetired {
+	struct HtcRetired *next;	// Next retired block of the shard
+	void			  *p;		// HtcNode, or HtcBuckets freed together with its chains
+	bool			   buckets; // True if p is an HtcBuckets
+	uint64_t		   epoch;	// Epoch after which no new reader can reach p
+} HtcRetired;
+
+// One independently locked part of the table, kept on its own cache lines
+typedef struct HtcShard {
+	_Alignas(HTC_CACHE_LINE) pthread_mutex_t lock;			// Held by writers only
+	HtcBuckets *_Atomic						 buckets;		// Current bucket array
+	atomic_size_t							 element_count;	// Entries in this shard
+	HtcRetired								*retired;		// Blocks waiting to be freed, guarded by lock
+} HtcShard;
+
+// Epoch slot claimed by a reader for the duration of one lookup
+typedef struct HtcReaderSlot {
+	_Alignas(HTC_CACHE_LINE) atomic_uint_least64_t epoch; // Epoch the reader entered in, 0 when free
+} HtcReaderSlot;
+
+// Struct definition for the concurrent hash table
+typedef struct HtConcurrentTable {
+	HtcShard			 *shards;					 // Array of shard_count shards
+	unsigned			  shard_count;				 // Number of shards, a power of two
+	unsigned			  shard_bits;				 // log2(shard_count)
+	uint64_t			  seed;						 // Seed of the key hash
+	atomic_uint_least64_t epoch;					 // Global epoch, advanced on every retire
+	HtcReaderSlot		  readers[HTC_READER_SLOTS]; // Epochs of the readers inside the table
+} HtConcurrentTable;
+
+/**
+ * Initializes a concurrent hash table. Not thread-safe: the table must not be
+ * shared until this returns.
+ *
+ * @param tab Pointer to the table to initialize.
+ * @param shard_count Number of shards, rounded up to a power of two. A few
+ *                    times the number of writer threads keeps lock contention low.
+ * @param bucket_count Initial number of buckets per shard, rounded up to a power of two.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool htc_init_table(HtConcurrentTable *tab, unsigned shard_count, unsigned bucket_count);
+
+/**
+ * Frees the table and everything it holds. Not thread-safe: no other thread
+ * may use the table during or after this call.
+ *
+ * @param tab Pointer to the table.
+ */
+void htc_deinit_table(HtConcurrentTable *tab);
+
+/**
+ * Inserts a key-value pair, replacing the value if the key exists. Locks the
+ * key's shard; readers are not blocked.
+ *
+ * @param tab Pointer to the table.
+ * @param key Pointer to the key (any bytes).
+ * @param keylen Length of the key in bytes.
+ * @param value Pointer to the value associated with the key.
+ * @return True on success, false if memory could not be allocated.
+ */
+bool htc_emplace_s(HtConcurrentTable *tab, const void *key, size_t keylen, void *value);
+
+/**
+ * Inserts a null-terminated key, like htc_emplace_s.
+ */
+bool htc_emplace(HtConcurrentTable *tab, const char *key, void *value);
+
+/**
+ * Deletes a key. The entry's memory is reclaimed once no reader can still
+ * reach it.
+ *
+ * @param tab Pointer to the table.
+ * @param key Pointer to the key (any bytes).
+ * @param keylen Length of the key in bytes.
+ * @return True if the key was deleted, false if it was not found.
+ */
+bool htc_delete_s(HtConcurrentTable *tab, const void *key, size_t keylen);
+
+/**
+ * Deletes a null-terminated key, like htc_delete_s.
+ */
+bool htc_delete(HtConcurrentTable *tab, const char *key);
+
+/**
+ * Searches for a key without taking any lock.
+ *
+ * @param tab Pointer to the table.
+ * @param key Pointer to the key (any bytes).
+ * @param keylen Length of the key in bytes.
+ * @return The value associated with the key, or NULL if not found.
+ */
+void *htc_search_s(HtConcurrentTable *tab, const void *key, size_t keylen);
+
+/**
+ * Searches for a null-terminated key, like htc_search_s.
+ */
+void *htc_search(HtConcurrentTable *tab, const char *key);
+
+/**
+ * Returns the number of entries. With concurrent writers the result is only a
+ * snapshot.
+ *
+ * @param tab Pointer to the table.
+ * @return Number of entries in the table.
+ */
+size_t htc_count(HtConcurrentTable *tab);
+
+/**
+ * Frees retired memory that no reader can reach anymore. Writers already do
+ * this as they go; call it after a burst of deletes to give memory back
+ * without waiting for the next write.
+ *
+ * @param tab Pointer to the table.
+ */
+void htc_collect(HtConcurrentTable *tab);
+
+#endif // HTCONCURRENT_H
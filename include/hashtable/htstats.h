@@ -0,0 +1,48 @@
+#ifndef HTSTATS_H
+#define HTSTATS_H
+
+#include <stddef.h> // Standard definitions (e.g., size_t)
+#include <stdint.h> // Fixed-width integer types (uint64_t)
+
+/**
+ * @file htstats.h
+ * @brief Health report shared by HtTable (ht_stats) and DEF_HASHTABLE
+ *        (TNAME##_stats).
+ *
+ * The occupancy figures are computed by walking the table when a report is
+ * requested and cost nothing otherwise. The lookup hit/miss counters are
+ * updated on every lookup only when HT_ENABLE_STATS is defined (the
+ * CGAMELIBS_HT_STATS CMake option); otherwise they stay zero and the
+ * counting compiles away.
+ */
+
+// Number of histogram entries; the last one also counts longer chains/probes
+#define HT_STATS_HISTOGRAM 16
+
+// Lookup counters embedded in every table
+typedef struct HtCounters {
+	uint64_t hits;	 // Lookups that found their key
+	uint64_t misses; // Lookups that did not
+} HtCounters;
+
+#ifdef HT_ENABLE_STATS
+#define HT_STATS_COUNT(counters, found) ((found) ? ++(counters).hits : ++(counters).misses)
+#else
+#define HT_STATS_COUNT(counters, found) ((void) 0)
+#endif
+
+// Snapshot of a table's health
+typedef struct HtStats {
+	size_t	 entries;						// Number of entries
+	size_t	 buckets;						// Number of buckets (slots for a flat HtTable)
+	double	 load_factor;					// entries / buckets
+	size_t	 histogram[HT_STATS_HISTOGRAM];	// Chained: buckets per chain length; flat: entries per probe length
+	size_t	 max_chain;						// Longest chain, or longest probe sequence in groups
+	double	 avg_probe;						// Entries visited (groups for flat) by a successful lookup, on average
+	size_t	 bytes;							// Bytes allocated for the table (see ht_memory_usage)
+	double	 bytes_per_entry;				// bytes / entries
+	uint64_t hits;							// Successful lookups since the last reset, 0 without HT_ENABLE_STATS
+	uint64_t misses;						// Failed lookups since the last reset, 0 without HT_ENABLE_STATS
+} HtStats;
+
+#endif // HTSTATS_H
@@ -0,0 +1,320 @@
+#ifndef INT_HASHTABLE_H
+#define INT_HASHTABLE_H
+
+#include "hashtable/htstats.h"
+#include "prefetch.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*  Integer-key hash table macro
+ *
+ *  Usage:
+ *      DEF_INT_HASHTABLE(uint32_t, Entity *, EntityMap, UINT32_MAX)
+ *
+ *  Generates:
+ *      typedef struct { uint32_t *keys; Entity **values; size_t capacity; size_t count; unsigned bits;
+ *                       HtCounters counters; } EntityMap;
+ *      bool     EntityMap_init(EntityMap *ht, size_t capacity);
+ *      void     EntityMap_deinit(EntityMap *ht);
+ *      bool     EntityMap_reserve(EntityMap *ht, size_t count);
+ *      bool     EntityMap_insert(EntityMap *ht, uint32_t key, Entity *value);
+ *      Entity **EntityMap_get(EntityMap *ht, uint32_t key);
+ *      bool     EntityMap_delete(EntityMap *ht, uint32_t key);
+ *      void     EntityMap_get_batch(EntityMap *ht, const uint32_t *keys, size_t n, Entity ***out);
+ *      void     EntityMap_stats(const EntityMap *ht, HtStats *stats);
+ *
+ *  KEY_T is an integer type of 32 or 64 bits, which is checked at compile
+ *  time; the width selects the hash. Keys are hashed by Fibonacci
+ *  (multiply-shift) hashing, which takes the top bits of key * 2^w/phi and so
+ *  spreads strided IDs evenly, and no user hash function is needed. EMPTY_KEY marks free slots and cannot be
+ *  inserted; pick a value IDs never take, such as 0 or the type's maximum.
+ *
+ *  Keys and values live in two parallel arrays with linear probing, so a
+ *  probe scans consecutive keys only, several at a time with SSE2/AVX2.
+ *  Deletion shifts later entries back instead of leaving tombstones. Pointers
+ *  returned by _get are invalidated by the next _insert, _delete or _reserve.
+ */
+
+// Maximum load factor, as numerator / denominator
+#define INT_HASHTABLE_MAX_LOAD_NUM 3
+#define INT_HASHTABLE_MAX_LOAD_DEN 4
+
+// Smallest non-empty capacity; must hold at least one SIMD group
+#define INT_HASHTABLE_MIN_CAPACITY 16
+
+// Number of keys _get_batch hashes and prefetches before resolving any
+#ifndef INT_HASHTABLE_BATCH_SIZE
+#define INT_HASHTABLE_BATCH_SIZE 16
+#endif
+
+// Bytes of keys compared per probe step, 0 without SIMD
+#if defined(__AVX2__)
+#define INT_HASHTABLE_GROUP_BYTES 32
+#elif defined(__SSE2__)
+#define INT_HASHTABLE_GROUP_BYTES 16
+#else
+#define INT_HASHTABLE_GROUP_BYTES 0
+#endif
+
+// Fibonacci hashing: top `bits` bits of the key times 2^32/phi (2^64/phi)
+static inline size_t int_ht_fib32(uint32_t key, unsigned bits) {
+	return (uint32_t) (key * 2654435769u) >> (32 - bits);
+}
+
+static inline size_t int_ht_fib64(uint64_t key, unsigned bits) {
+	return (size_t) ((key * 0x9e3779b97f4a7c15ull) >> (64 - bits));
+}
+
+// Index of the lowest set bit of a non-zero mask
+static inline unsigned int_ht_ctz(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned) __builtin_ctz(mask);
+#else
+	unsigned i = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		++i;
+	}
+	return i;
+#endif
+}
+
+// Compares one group of INT_HASHTABLE_GROUP_BYTES key bytes with `key` and `empty`. Returns a byte mask of the
+// matching lanes in the low 32 bits and of the empty lanes in the high 32 bits.
+static inline uint64_t int_ht_match(const void *group, size_t key_size, uint64_t key, uint64_t empty) {
+#if defined(__AVX2__)
+	__m256i keys = _mm256_loadu_si256((const __m256i *) group);
+	__m256i hit, vacant;
+	if (key_size == 4) {
+		hit = _mm256_cmpeq_epi32(keys, _mm256_set1_epi32((int) key));
+		vacant = _mm256_cmpeq_epi32(keys, _mm256_set1_epi32((int) empty));
+	} else {
+		hit = _mm256_cmpeq_epi64(keys, _mm256_set1_epi64x((long long) key));
+		vacant = _mm256_cmpeq_epi64(keys, _mm256_set1_epi64x((long long) empty));
+	}
+	return (uint32_t) _mm256_movemask_epi8(hit) | (uint64_t) (uint32_t) _mm256_movemask_epi8(vacant) << 32;
+#elif defined(__SSE2__)
+	__m128i keys = _mm_loadu_si128((const __m128i *) group);
+	__m128i hit, vacant;
+	if (key_size == 4) {
+		hit = _mm_cmpeq_epi32(keys, _mm_set1_epi32((int) key));
+		vacant = _mm_cmpeq_epi32(keys, _mm_set1_epi32((int) empty));
+	} else {
+		// No 64-bit compare in SSE2: both 32-bit halves of a lane must match
+		hit = _mm_cmpeq_epi32(keys, _mm_set1_epi64x((long long) key));
+		vacant = _mm_cmpeq_epi32(keys, _mm_set1_epi64x((long long) empty));
+		hit = _mm_and_si128(hit, _mm_shuffle_epi32(hit, _MM_SHUFFLE(2, 3, 0, 1)));
+		vacant = _mm_and_si128(vacant, _mm_shuffle_epi32(vacant, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+	return (uint32_t) _mm_movemask_epi8(hit) | (uint64_t) (uint32_t) _mm_movemask_epi8(vacant) << 32;
+#else
+	(void) group;
+	(void) key_size;
+	(void) key;
+	(void) empty;
+	return 0;
+#endif
+}
+
+#define DEF_INT_HASHTABLE(KEY_T, VAL_T, TNAME, EMPTY_KEY)                                                              \
+	_Static_assert(sizeof(KEY_T) == 4 || sizeof(KEY_T) == 8, "DEF_INT_HASHTABLE keys must be 32 or 64 bits");          \
+	typedef struct {                                                                                                   \
+		KEY_T	  *keys;                                                                                               \
+		VAL_T	  *values;                                                                                             \
+		size_t	   capacity;                                                                                           \
+		size_t	   count;                                                                                              \
+		unsigned   bits;                                                                                               \
+		HtCounters counters;                                                                                           \
+	} TNAME;                                                                                                           \
+                                                                                                                       \
+	static inline size_t TNAME##_home(const TNAME *ht, KEY_T key) {                                                    \
+		return sizeof(KEY_T) <= 4 ? int_ht_fib32((uint32_t) key, ht->bits) : int_ht_fib64((uint64_t) key, ht->bits);   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* slot holding the key, or capacity if absent; probing starts at `index` */                                       \
+	static inline size_t TNAME##_probe(const TNAME *ht, KEY_T key, size_t index) {                                     \
+		const size_t lanes = INT_HASHTABLE_GROUP_BYTES / sizeof(KEY_T);                                                \
+		if (ht->count == 0 || key == (KEY_T) (EMPTY_KEY))                                                              \
+			return ht->capacity;                                                                                       \
+		if (ht->keys[index] == key) /* most hits sit in their home slot */                                             \
+			return index;                                                                                              \
+		for (;;) {                                                                                                     \
+			if (lanes && index + lanes <= ht->capacity) {                                                              \
+				const KEY_T *group = &ht->keys[index];                                                                 \
+				uint64_t	 match = int_ht_match(group, sizeof(KEY_T), (uint64_t) key, (uint64_t) (EMPTY_KEY));       \
+				uint32_t	 hit = (uint32_t) match;                                                                   \
+				uint32_t	 vacant = (uint32_t) (match >> 32);                                                        \
+				if (hit && (!vacant || int_ht_ctz(hit) < int_ht_ctz(vacant)))                                          \
+					return index + int_ht_ctz(hit) / sizeof(KEY_T);                                                    \
+				if (vacant)                                                                                            \
+					return ht->capacity;                                                                               \
+				index = (index + lanes) & (ht->capacity - 1);                                                          \
+			} else {                                                                                                   \
+				if (ht->keys[index] == key)                                                                            \
+					return index;                                                                                      \
+				if (ht->keys[index] == (KEY_T) (EMPTY_KEY))                                                            \
+					return ht->capacity;                                                                               \
+				index = (index + 1) & (ht->capacity - 1);                                                              \
+			}                                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_place(TNAME *ht, KEY_T key, VAL_T value) {                                              \
+		size_t index = TNAME##_home(ht, key);                                                                          \
+		while (ht->keys[index] != (KEY_T) (EMPTY_KEY))                                                                 \
+			index = (index + 1) & (ht->capacity - 1);                                                                  \
+		ht->keys[index] = key;                                                                                         \
+		ht->values[index] = value;                                                                                     \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_stats_reset(TNAME *ht) {                                                                \
+		ht->counters.hits = 0;                                                                                         \
+		ht->counters.misses = 0;                                                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* grow so that `count` entries fit under the maximum load */                                                      \
+	static inline bool TNAME##_reserve(TNAME *ht, size_t count) {                                                      \
+		size_t	 capacity = INT_HASHTABLE_MIN_CAPACITY;                                                                \
+		unsigned bits = 4;                                                                                             \
+		while (capacity / INT_HASHTABLE_MAX_LOAD_DEN * INT_HASHTABLE_MAX_LOAD_NUM < count) {                           \
+			capacity *= 2;                                                                                             \
+			bits++;                                                                                                    \
+		}                                                                                                              \
+		if (capacity <= ht->capacity)                                                                                  \
+			return true;                                                                                               \
+		KEY_T *keys = malloc(capacity * sizeof(KEY_T));                                                                \
+		VAL_T *values = malloc(capacity * sizeof(VAL_T));                                                              \
+		if (!keys || !values) {                                                                                        \
+			free(keys);                                                                                                \
+			free(values);                                                                                              \
+			return false;                                                                                              \
+		}                                                                                                              \
+		for (size_t i = 0; i < capacity; ++i)                                                                          \
+			keys[i] = (KEY_T) (EMPTY_KEY);                                                                             \
+		KEY_T *old_keys = ht->keys;                                                                                    \
+		VAL_T *old_values = ht->values;                                                                                \
+		size_t old_capacity = ht->capacity;                                                                            \
+		ht->keys = keys;                                                                                               \
+		ht->values = values;                                                                                           \
+		ht->capacity = capacity;                                                                                       \
+		ht->bits = bits;                                                                                               \
+		for (size_t i = 0; i < old_capacity; ++i) {                                                                    \
+			if (old_keys[i] != (KEY_T) (EMPTY_KEY))                                                                    \
+				TNAME##_place(ht, old_keys[i], old_values[i]);                                                         \
+		}                                                                                                              \
+		free(old_keys);                                                                                                \
+		free(old_values);                                                                                              \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline bool TNAME##_init(TNAME *ht, size_t capacity) {                                                      \
+		ht->keys = NULL;                                                                                               \
+		ht->values = NULL;                                                                                             \
+		ht->capacity = 0;                                                                                              \
+		ht->count = 0;                                                                                                 \
+		ht->bits = 0;                                                                                                  \
+		TNAME##_stats_reset(ht);                                                                                       \
+		return capacity == 0 || TNAME##_reserve(ht, capacity);                                                         \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* insert, or replace the value of an existing key; EMPTY_KEY is refused */                                        \
+	static inline bool TNAME##_insert(TNAME *ht, KEY_T key, VAL_T value) {                                             \
+		if (key == (KEY_T) (EMPTY_KEY))                                                                                \
+			return false;                                                                                              \
+		size_t index = ht->count ? TNAME##_probe(ht, key, TNAME##_home(ht, key)) : ht->capacity;                       \
+		if (index != ht->capacity) {                                                                                   \
+			ht->values[index] = value;                                                                                 \
+			return true;                                                                                               \
+		}                                                                                                              \
+		if (!TNAME##_reserve(ht, ht->count + 1))                                                                       \
+			return false;                                                                                              \
+		TNAME##_place(ht, key, value);                                                                                 \
+		ht->count++;                                                                                                   \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline VAL_T *TNAME##_get(TNAME *ht, KEY_T key) {                                                           \
+		size_t index = ht->count ? TNAME##_probe(ht, key, TNAME##_home(ht, key)) : ht->capacity;                       \
+		HT_STATS_COUNT(ht->counters, index != ht->capacity);                                                           \
+		return index != ht->capacity ? &ht->values[index] : NULL;                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* delete with backward shift: an entry after the hole moves into it unless its home lies past the hole */         \
+	static inline bool TNAME##_delete(TNAME *ht, KEY_T key) {                                                          \
+		size_t index = ht->count ? TNAME##_probe(ht, key, TNAME##_home(ht, key)) : ht->capacity;                       \
+		if (index == ht->capacity)                                                                                     \
+			return false;                                                                                              \
+		size_t mask = ht->capacity - 1;                                                                                \
+		for (size_t next = (index + 1) & mask; ht->keys[next] != (KEY_T) (EMPTY_KEY); next = (next + 1) & mask) {      \
+			size_t home = TNAME##_home(ht, ht->keys[next]);                                                            \
+			if (((next - home) & mask) >= ((next - index) & mask)) {                                                   \
+				ht->keys[index] = ht->keys[next];                                                                      \
+				ht->values[index] = ht->values[next];                                                                  \
+				index = next;                                                                                          \
+			}                                                                                                          \
+		}                                                                                                              \
+		ht->keys[index] = (KEY_T) (EMPTY_KEY);                                                                         \
+		ht->count--;                                                                                                   \
+		return true;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* look up n keys, writing a value pointer or NULL for each to out */                                              \
+	static inline void TNAME##_get_batch(TNAME *ht, const KEY_T *keys, size_t n, VAL_T **out) {                        \
+		size_t homes[INT_HASHTABLE_BATCH_SIZE];                                                                        \
+		for (size_t base = 0; base < n; base += INT_HASHTABLE_BATCH_SIZE) {                                            \
+			size_t count = n - base < INT_HASHTABLE_BATCH_SIZE ? n - base : INT_HASHTABLE_BATCH_SIZE;                  \
+			if (ht->count == 0) {                                                                                      \
+				for (size_t i = 0; i < count; ++i)                                                                     \
+					out[base + i] = NULL;                                                                              \
+				continue;                                                                                              \
+			}                                                                                                          \
+			for (size_t i = 0; i < count; ++i) {                                                                       \
+				homes[i] = TNAME##_home(ht, keys[base + i]);                                                           \
+				PREFETCH(&ht->keys[homes[i]]);                                                                         \
+			}                                                                                                          \
+			for (size_t i = 0; i < count; ++i) {                                                                       \
+				size_t index = TNAME##_probe(ht, keys[base + i], homes[i]);                                            \
+				HT_STATS_COUNT(ht->counters, index != ht->capacity);                                                   \
+				out[base + i] = index != ht->capacity ? &ht->values[index] : NULL;                                     \
+			}                                                                                                          \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_stats(const TNAME *ht, HtStats *stats) {                                                \
+		*stats = (HtStats){0};                                                                                         \
+		size_t visits = 0;                                                                                             \
+		for (size_t i = 0; i < ht->capacity; i++) {                                                                    \
+			if (ht->keys[i] == (KEY_T) (EMPTY_KEY))                                                                    \
+				continue;                                                                                              \
+			size_t length = ((i - TNAME##_home(ht, ht->keys[i])) & (ht->capacity - 1)) + 1;                            \
+			visits += length;                                                                                          \
+			++stats->histogram[length < HT_STATS_HISTOGRAM ? length : HT_STATS_HISTOGRAM - 1];                         \
+			stats->max_chain = length > stats->max_chain ? length : stats->max_chain;                                  \
+		}                                                                                                              \
+		stats->entries = ht->count;                                                                                    \
+		stats->buckets = ht->capacity;                                                                                 \
+		stats->load_factor = ht->capacity ? (double) ht->count / ht->capacity : 0;                                     \
+		stats->avg_probe = ht->count ? (double) visits / ht->count : 0;                                                \
+		stats->bytes = (sizeof(KEY_T) + sizeof(VAL_T)) * ht->capacity;                                                 \
+		stats->bytes_per_entry = ht->count ? (double) stats->bytes / ht->count : 0;                                    \
+		stats->hits = ht->counters.hits;                                                                               \
+		stats->misses = ht->counters.misses;                                                                           \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void TNAME##_deinit(TNAME *ht) {                                                                     \
+		free(ht->keys);                                                                                                \
+		free(ht->values);                                                                                              \
+		ht->keys = NULL;                                                                                               \
+		ht->values = NULL;                                                                                             \
+		ht->capacity = ht->count = 0;                                                                                  \
+	}
+
+#endif // INT_HASHTABLE_H
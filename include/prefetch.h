@@ -0,0 +1,20 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/**
+ * @file prefetch.h
+ * @brief Software prefetch hints.
+ *
+ * PREFETCH(addr) asks the CPU to start loading the cache line holding `addr`
+ * for reading. It is only a hint: it never faults, so `addr` may point past
+ * the end of an array, and it compiles to nothing on compilers without
+ * __builtin_prefetch.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define PREFETCH(addr) ((void) (addr))
+#endif
+
+#endif /* PREFETCH_H */
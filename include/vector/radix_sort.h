@@ -0,0 +1,61 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "vector/vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file radix_sort.h
+ * @brief LSD radix sorts for integer, float and 64-bit key/value arrays,
+ *        such as the storage of a DEF_VECTOR (pass VEC_SPAN(&vec)).
+ *
+ * The sorts process the key one byte at a time, least significant first,
+ * and are stable. Each takes one counting pass over the data plus one
+ * scatter pass per key byte, skipping bytes that are the same in every key,
+ * so sorting 32-bit keys reads the data at most five times whatever its
+ * order. They allocate a scratch copy of the array and return false, with
+ * the data unchanged, if that fails.
+ *
+ * Signed keys sort in numeric order. Float keys sort by value with -0.0
+ * before +0.0; NaNs sort below -inf or above +inf depending on their sign
+ * bit.
+ *
+ * The _parallel variants split every pass over several threads and pay off
+ * for arrays of a few million elements; with fewer than
+ * RADIX_SORT_PARALLEL_MIN_CHUNK elements per thread they use fewer threads.
+ */
+
+// Smallest number of elements worth giving a thread of its own
+#define RADIX_SORT_PARALLEL_MIN_CHUNK 65536
+
+// Element of a key/value sort, such as a 64-bit render-sort key and the index of what it draws
+typedef struct RadixPair64 {
+	uint64_t key;	// Sort key
+	uint64_t value; // Payload, moved with its key
+} RadixPair64;
+
+bool radix_sort_u32(uint32_t *data, size_t n);
+bool radix_sort_i32(int32_t *data, size_t n);
+bool radix_sort_f32(float *data, size_t n);
+bool radix_sort_u64(uint64_t *data, size_t n);
+bool radix_sort_i64(int64_t *data, size_t n);
+
+/**
+ * Sorts pairs by key; pairs with equal keys keep their order.
+ */
+bool radix_sort_pairs64(RadixPair64 *pairs, size_t n);
+
+/**
+ * Multi-threaded versions of radix_sort_u32, radix_sort_u64 and
+ * radix_sort_pairs64.
+ *
+ * @param threads Number of threads to use, including the calling one, or 0
+ *                for one per online CPU.
+ */
+bool radix_sort_u32_parallel(uint32_t *data, size_t n, unsigned threads);
+bool radix_sort_u64_parallel(uint64_t *data, size_t n, unsigned threads);
+bool radix_sort_pairs64_parallel(RadixPair64 *pairs, size_t n, unsigned threads);
+
+#endif // RADIX_SORT_H
@@ -0,0 +1,98 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include "vector/vector.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*  Small-buffer vector macro
+ *
+ *  Usage:
+ *      DEF_SMALL_VECTOR(int, 8, IntSmallVec)
+ *
+ *  Generates the DEF_VECTOR API on a vector that keeps up to N elements in
+ *  storage inside the struct and only moves them to the heap once it
+ *  overflows:
+ *      typedef struct { int *data; size_t capacity; size_t count; int inline_data[8]; } IntSmallVec;
+ *      void IntSmallVec_init(IntSmallVec *vec, size_t initial_capacity);
+ *      void IntSmallVec_deinit(IntSmallVec *vec);
+ *      int  IntSmallVec_is_inline(const IntSmallVec *vec);
+ *      ... and every other DEF_VECTOR function, with the same semantics.
+ *
+ *  capacity is never below N. Shrinking to N elements or fewer (_realloc,
+ *  _shrink_to_fit) moves the elements back inline and frees the heap block;
+ *  _deinit leaves an empty, usable vector.
+ *
+ *  While the elements are inline, `data` points into the struct itself, so a
+ *  small vector must not be copied or moved with plain assignment or memcpy.
+ */
+#define DEF_SMALL_VECTOR(ELEM_T, N, VEC_T)                                                                             \
+	typedef struct {                                                                                                   \
+		ELEM_T *data;                                                                                                  \
+		size_t	capacity;                                                                                              \
+		size_t	count;                                                                                                 \
+		ELEM_T	inline_data[N];                                                                                        \
+	} VEC_T;                                                                                                           \
+                                                                                                                       \
+	static inline int VEC_T##_is_inline(const VEC_T *vec) {                                                            \
+		return vec->data == vec->inline_data;                                                                          \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* reallocate to new_capacity, or back to the inline storage when it fits */                                       \
+	static inline int VEC_T##_realloc_exact(VEC_T *vec, size_t new_capacity) {                                         \
+		if (new_capacity <= (N)) {                                                                                     \
+			if (!VEC_T##_is_inline(vec)) {                                                                             \
+				size_t keep = vec->count < new_capacity ? vec->count : new_capacity;                                   \
+				memcpy(vec->inline_data, vec->data, keep * sizeof(ELEM_T));                                            \
+				free(vec->data);                                                                                       \
+				vec->data = vec->inline_data;                                                                          \
+				vec->count = keep;                                                                                     \
+			} else if (vec->count > new_capacity) {                                                                    \
+				vec->count = new_capacity;                                                                             \
+			}                                                                                                          \
+			vec->capacity = (N);                                                                                       \
+			return 1;                                                                                                  \
+		}                                                                                                              \
+		if (new_capacity > SIZE_MAX / sizeof(ELEM_T))                                                                  \
+			return 0;                                                                                                  \
+		ELEM_T *new_data;                                                                                              \
+		if (VEC_T##_is_inline(vec)) {                                                                                  \
+			/* count never exceeds N while inline; the clamp tells the compiler so */                                  \
+			size_t keep = vec->count < (N) ? vec->count : (N);                                                         \
+			new_data = (ELEM_T *) malloc(new_capacity * sizeof(ELEM_T));                                               \
+			if (new_data)                                                                                              \
+				memcpy(new_data, vec->inline_data, keep * sizeof(ELEM_T));                                             \
+		} else {                                                                                                       \
+			new_data = (ELEM_T *) realloc(vec->data, new_capacity * sizeof(ELEM_T));                                   \
+		}                                                                                                              \
+		if (!new_data)                                                                                                 \
+			return 0;                                                                                                  \
+		vec->data = new_data;                                                                                          \
+		vec->capacity = new_capacity;                                                                                  \
+		if (vec->count > new_capacity)                                                                                 \
+			vec->count = new_capacity;                                                                                 \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* initialise; initial capacities up to N need no allocation */                                                    \
+	static inline void VEC_T##_init(VEC_T *vec, size_t initial_capacity) {                                             \
+		vec->data = vec->inline_data;                                                                                  \
+		vec->capacity = (N);                                                                                           \
+		vec->count = 0;                                                                                                \
+		if (initial_capacity > (N))                                                                                    \
+			VEC_T##_realloc_exact(vec, initial_capacity);                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* de‑initialise: free any heap block and return to the empty inline state */                                      \
+	static inline void VEC_T##_deinit(VEC_T *vec) {                                                                    \
+		if (!VEC_T##_is_inline(vec))                                                                                   \
+			free(vec->data);                                                                                           \
+		vec->data = vec->inline_data;                                                                                  \
+		vec->capacity = (N);                                                                                           \
+		vec->count = 0;                                                                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	DEF_VECTOR_OPS(ELEM_T, VEC_T)
+
+#endif /* SMALL_VECTOR_H */
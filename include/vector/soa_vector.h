@@ -0,0 +1,197 @@
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*  Structure-of-arrays vector macro
+ *
+ *  Usage:
+ *      #define PARTICLE_FIELDS(X) X(float, x) X(float, y) X(float, vx) X(float, vy) X(int, id)
+ *      DEF_SOA_VECTOR(PARTICLE_FIELDS, Particles)
+ *
+ *  Generates:
+ *      typedef struct { float x; float y; float vx; float vy; int id; } Particles_elem;
+ *      typedef struct { size_t capacity; size_t count; void *block; float *x; ...; int *id; } Particles;
+ *      void Particles_init(Particles *vec, size_t initial_capacity);
+ *      void Particles_deinit(Particles *vec);
+ *      int  Particles_reserve(Particles *vec, size_t capacity);
+ *      int  Particles_resize_uninit(Particles *vec, size_t count);
+ *      void Particles_clear(Particles *vec);
+ *      int  Particles_push_back(Particles *vec, Particles_elem value);
+ *      int  Particles_pop_back(Particles *vec, Particles_elem *out);
+ *      int  Particles_swap_remove(Particles *vec, size_t index);
+ *      Particles_elem Particles_get(const Particles *vec, size_t index);
+ *      void Particles_set(Particles *vec, size_t index, Particles_elem value);
+ *
+ *  Each field lives in its own array, so a loop over one or two fields only
+ *  loads those fields' cache lines. All arrays share one count and capacity
+ *  and are carved out of a single allocation. Every array starts on a
+ *  SOA_VECTOR_ALIGN boundary and the capacity is a multiple of
+ *  SOA_VECTOR_LANES, so a SIMD kernel may read (and write) whole vectors up to
+ *  the next multiple of SOA_VECTOR_LANES past `count`; those padding slots
+ *  hold indeterminate values.
+ *
+ *  Loops get a field's array through SOA_VECTOR_SPAN(vec, field), which tells
+ *  the compiler about the alignment; together with `count` it is the span of
+ *  that field:
+ *      float *x = SOA_VECTOR_SPAN(&particles, x), *vx = SOA_VECTOR_SPAN(&particles, vx);
+ *      for (size_t i = 0; i < particles.count; ++i)
+ *          x[i] += vx[i] * dt;
+ *
+ *  Functions returning int return 1 on success and 0 on failure, leaving the
+ *  vector unchanged. Growth moves every array, invalidating spans. The names
+ *  capacity, count and block are taken by the struct and cannot be fields.
+ */
+
+// Alignment of every field array (one cache line, and the widest vector register)
+#define SOA_VECTOR_ALIGN 64
+
+// The capacity is a multiple of this many elements
+#define SOA_VECTOR_LANES 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SOA_VECTOR_SPAN(vec, field)                                                                                    \
+	((__typeof__((vec)->field)) __builtin_assume_aligned((vec)->field, SOA_VECTOR_ALIGN))
+#else
+#define SOA_VECTOR_SPAN(vec, field) ((vec)->field)
+#endif
+
+static inline size_t soa_vector_round(size_t bytes) {
+	return (bytes + SOA_VECTOR_ALIGN - 1) & ~(size_t) (SOA_VECTOR_ALIGN - 1);
+}
+
+// Per-field expansions used by DEF_SOA_VECTOR; they refer to the locals of the generated functions
+#define SOA_VECTOR_MEMBER(T, NAME) T NAME;
+#define SOA_VECTOR_ARRAY(T, NAME) T *NAME;
+#define SOA_VECTOR_BYTES(T, NAME) +soa_vector_round(soa_capacity * sizeof(T))
+#define SOA_VECTOR_CARVE(T, NAME)                                                                                      \
+	soa_fresh.NAME = (T *) (soa_block + soa_offset);                                                                   \
+	soa_offset += soa_vector_round(soa_capacity * sizeof(T));
+#define SOA_VECTOR_COPY(T, NAME) memcpy(soa_fresh.NAME, vec->NAME, vec->count * sizeof(T));
+#define SOA_VECTOR_LOAD(T, NAME) soa_value.NAME = vec->NAME[index];
+#define SOA_VECTOR_STORE(T, NAME) vec->NAME[index] = soa_value.NAME;
+#define SOA_VECTOR_MOVE(T, NAME) vec->NAME[index] = vec->NAME[soa_last];
+
+#define DEF_SOA_VECTOR(FIELDS, VEC_T)                                                                                  \
+	typedef struct {                                                                                                   \
+		FIELDS(SOA_VECTOR_MEMBER)                                                                                      \
+	} VEC_T##_elem;                                                                                                    \
+                                                                                                                       \
+	typedef struct {                                                                                                   \
+		size_t capacity;                                                                                               \
+		size_t count;                                                                                                  \
+		void  *block;                                                                                                  \
+		FIELDS(SOA_VECTOR_ARRAY)                                                                                       \
+	} VEC_T;                                                                                                           \
+                                                                                                                       \
+	/* reallocate every array to hold exactly soa_capacity elements (a multiple of SOA_VECTOR_LANES) */                \
+	static inline int VEC_T##_realloc_exact(VEC_T *vec, size_t soa_capacity) {                                         \
+		if (soa_capacity > SIZE_MAX / 2 / sizeof(VEC_T##_elem))                                                        \
+			return 0;                                                                                                  \
+		size_t soa_bytes = 0 FIELDS(SOA_VECTOR_BYTES);                                                                 \
+		char  *soa_block = (char *) aligned_alloc(SOA_VECTOR_ALIGN, soa_bytes ? soa_bytes : SOA_VECTOR_ALIGN);         \
+		if (!soa_block)                                                                                                \
+			return 0;                                                                                                  \
+		if (vec->count > soa_capacity)                                                                                 \
+			vec->count = soa_capacity;                                                                                 \
+		VEC_T  soa_fresh = *vec;                                                                                       \
+		size_t soa_offset = 0;                                                                                         \
+		FIELDS(SOA_VECTOR_CARVE)                                                                                       \
+		if (vec->count) {                                                                                              \
+			FIELDS(SOA_VECTOR_COPY)                                                                                    \
+		}                                                                                                              \
+		void *soa_old = vec->block;                                                                                    \
+		soa_fresh.block = soa_block;                                                                                   \
+		soa_fresh.capacity = soa_capacity;                                                                             \
+		*vec = soa_fresh;                                                                                              \
+		free(soa_old);                                                                                                 \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* reserve – make room for at least `capacity` elements */                                                         \
+	static inline int VEC_T##_reserve(VEC_T *vec, size_t capacity) {                                                   \
+		if (capacity <= vec->capacity)                                                                                 \
+			return 1;                                                                                                  \
+		if (capacity > SIZE_MAX - SOA_VECTOR_LANES)                                                                    \
+			return 0;                                                                                                  \
+		return VEC_T##_realloc_exact(vec, (capacity + SOA_VECTOR_LANES - 1) & ~(size_t) (SOA_VECTOR_LANES - 1));       \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* grow geometrically until at least min_capacity elements fit */                                                  \
+	static inline int VEC_T##_grow(VEC_T *vec, size_t min_capacity) {                                                  \
+		if (min_capacity <= vec->capacity)                                                                             \
+			return 1;                                                                                                  \
+		size_t new_cap = vec->capacity < SIZE_MAX / 2 ? vec->capacity * 2 : SIZE_MAX;                                  \
+		return VEC_T##_reserve(vec, new_cap > min_capacity ? new_cap : min_capacity);                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* initialise */                                                                                                   \
+	static inline void VEC_T##_init(VEC_T *vec, size_t initial_capacity) {                                             \
+		memset(vec, 0, sizeof(*vec));                                                                                  \
+		if (initial_capacity)                                                                                          \
+			VEC_T##_reserve(vec, initial_capacity);                                                                    \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* de‑initialise */                                                                                                \
+	static inline void VEC_T##_deinit(VEC_T *vec) {                                                                    \
+		free(vec->block);                                                                                              \
+		memset(vec, 0, sizeof(*vec));                                                                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* resize_uninit – set count, leaving any new elements uninitialised */                                            \
+	static inline int VEC_T##_resize_uninit(VEC_T *vec, size_t count) {                                                \
+		if (!VEC_T##_grow(vec, count))                                                                                 \
+			return 0;                                                                                                  \
+		vec->count = count;                                                                                            \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void VEC_T##_clear(VEC_T *vec) {                                                                     \
+		vec->count = 0;                                                                                                \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* get – gather the fields of element `index` */                                                                   \
+	static inline VEC_T##_elem VEC_T##_get(const VEC_T *vec, size_t index) {                                           \
+		VEC_T##_elem soa_value;                                                                                        \
+		FIELDS(SOA_VECTOR_LOAD)                                                                                        \
+		return soa_value;                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* set – scatter a value into the fields of element `index` */                                                     \
+	static inline void VEC_T##_set(VEC_T *vec, size_t index, VEC_T##_elem soa_value) {                                 \
+		FIELDS(SOA_VECTOR_STORE)                                                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* push_back – append a value, growing if necessary */                                                             \
+	static inline int VEC_T##_push_back(VEC_T *vec, VEC_T##_elem value) {                                              \
+		if (vec->count == vec->capacity && !VEC_T##_grow(vec, vec->count + 1))                                         \
+			return 0;                                                                                                  \
+		VEC_T##_set(vec, vec->count++, value);                                                                         \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* pop_back – remove last element; optionally retrieve it */                                                       \
+	static inline int VEC_T##_pop_back(VEC_T *vec, VEC_T##_elem *out) {                                                \
+		if (vec->count == 0)                                                                                           \
+			return 0; /* nothing to pop */                                                                             \
+		vec->count--;                                                                                                  \
+		if (out)                                                                                                       \
+			*out = VEC_T##_get(vec, vec->count);                                                                       \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* swap_remove – remove element `index` by moving the last element into it (order is not kept) */                  \
+	static inline int VEC_T##_swap_remove(VEC_T *vec, size_t index) {                                                  \
+		if (index >= vec->count)                                                                                       \
+			return 0;                                                                                                  \
+		size_t soa_last = --vec->count;                                                                                \
+		if (index != soa_last) {                                                                                       \
+			FIELDS(SOA_VECTOR_MOVE)                                                                                    \
+		}                                                                                                              \
+		return 1;                                                                                                      \
+	}
+
+#endif /* SOA_VECTOR_H */
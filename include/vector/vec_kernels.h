@@ -0,0 +1,121 @@
+#ifndef VEC_KERNELS_H
+#define VEC_KERNELS_H
+
+#include "vector/vector.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file vec_kernels.h
+ * @brief SIMD loops over arrays of float and int32_t, such as the storage of
+ *        a DEF_VECTOR(float, ...) or DEF_VECTOR(int32_t, ...).
+ *
+ * Every kernel has a scalar, an SSE2 and an AVX2 version. The first call
+ * picks the widest one the CPU (and OS) supports through CPUID; builds for
+ * other architectures use the scalar versions. Kernels take a pointer and an
+ * element count, so a vector is passed as `vec.data, vec.count` (or
+ * VEC_SPAN(&vec)); no alignment is required.
+ *
+ * Float kernels assume the data holds no NaNs. The SIMD versions of
+ * vec_sum_f32, vec_dot_f32 and vec_prefix_sum_f32 add in a different order
+ * than a plain loop, so their results can differ from it by rounding.
+ * Integer sums, dots and prefix sums wrap around on overflow.
+ */
+
+// Instruction sets the kernels can use, from narrowest to widest
+typedef enum VecSimdLevel {
+	VEC_SIMD_SCALAR = 0,
+	VEC_SIMD_SSE2 = 1,
+	VEC_SIMD_AVX2 = 2,
+} VecSimdLevel;
+
+/**
+ * Returns the widest instruction set the CPU supports.
+ */
+VecSimdLevel vec_simd_detect(void);
+
+/**
+ * Returns the instruction set the kernels currently use.
+ */
+VecSimdLevel vec_simd_level(void);
+
+/**
+ * Makes the kernels use `level`, or the widest supported level below it.
+ * Meant for tests and benchmarks comparing the versions; not thread-safe
+ * against concurrent kernel calls.
+ *
+ * @param level Requested instruction set.
+ * @return The level now in use.
+ */
+VecSimdLevel vec_simd_set_level(VecSimdLevel level);
+
+/**
+ * Returns the index of the first element equal to `value`, or `n` if there
+ * is none.
+ */
+size_t vec_find_f32(const float *data, size_t n, float value);
+size_t vec_find_i32(const int32_t *data, size_t n, int32_t value);
+
+/**
+ * Returns the number of elements equal to `value`.
+ */
+size_t vec_count_f32(const float *data, size_t n, float value);
+size_t vec_count_i32(const int32_t *data, size_t n, int32_t value);
+
+/**
+ * Returns the smallest or largest element. `n` must not be 0.
+ */
+float	vec_min_f32(const float *data, size_t n);
+float	vec_max_f32(const float *data, size_t n);
+int32_t vec_min_i32(const int32_t *data, size_t n);
+int32_t vec_max_i32(const int32_t *data, size_t n);
+
+/**
+ * Returns the index of the first smallest element, or `n` if `n` is 0.
+ */
+size_t vec_argmin_f32(const float *data, size_t n);
+size_t vec_argmin_i32(const int32_t *data, size_t n);
+
+/**
+ * Returns the sum of the elements; 0 if `n` is 0.
+ */
+float	vec_sum_f32(const float *data, size_t n);
+int64_t vec_sum_i32(const int32_t *data, size_t n);
+
+/**
+ * Returns the sum of a[i] * b[i].
+ */
+float	vec_dot_f32(const float *a, const float *b, size_t n);
+int32_t vec_dot_i32(const int32_t *a, const int32_t *b, size_t n);
+
+/**
+ * Sets every element to `value`.
+ */
+void vec_fill_f32(float *data, size_t n, float value);
+void vec_fill_i32(int32_t *data, size_t n, int32_t value);
+
+/**
+ * Clamps every element, in place, to [lo, hi]. Requires lo <= hi.
+ */
+void vec_clamp_f32(float *data, size_t n, float lo, float hi);
+void vec_clamp_i32(int32_t *data, size_t n, int32_t lo, int32_t hi);
+
+/**
+ * Copies the elements of `src` whose `mask` byte is non-zero to the front of
+ * `dst`, keeping their order. `dst` may equal `src` (in-place filtering) but
+ * must not otherwise overlap it, and must have room for `n` elements: the
+ * SIMD versions write whole vectors past the last kept element.
+ *
+ * @return Number of elements kept.
+ */
+size_t vec_compact_f32(float *dst, const float *src, const uint8_t *mask, size_t n);
+size_t vec_compact_i32(int32_t *dst, const int32_t *src, const uint8_t *mask, size_t n);
+
+/**
+ * Writes the inclusive prefix sums of `src` to `dst`: dst[i] = src[0] + ... +
+ * src[i]. `dst` may equal `src` but must not otherwise overlap it.
+ */
+void vec_prefix_sum_f32(float *dst, const float *src, size_t n);
+void vec_prefix_sum_i32(int32_t *dst, const int32_t *src, size_t n);
+
+#endif // VEC_KERNELS_H
@@ -2,6 +2,7 @@
 #define VECTOR_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,9 +16,26 @@
  *      void IntVec_init(IntVec *vec, size_t initial_capacity);
  *      void IntVec_deinit(IntVec *vec);
  *      void IntVec_realloc(IntVec *vec, size_t new_capacity);
- *      void IntVec_push_back(IntVec *vec, int value);
+ *      int  IntVec_reserve(IntVec *vec, size_t capacity);
+ *      int  IntVec_shrink_to_fit(IntVec *vec);
+ *      int  IntVec_push_back(IntVec *vec, int value);
+ *      int *IntVec_emplace_back(IntVec *vec);
  *      int  IntVec_pop_back(IntVec *vec, int *out);
+ *      int  IntVec_resize_uninit(IntVec *vec, size_t count);
+ *      int  IntVec_append_n(IntVec *vec, const int *values, size_t n);
+ *      int  IntVec_insert_range(IntVec *vec, size_t index, const int *values, size_t n);
+ *      int  IntVec_erase_range(IntVec *vec, size_t index, size_t n);
+ *
+ *  Functions returning int return 1 on success and 0 on failure (allocation
+ *  failure or an out-of-range index), leaving the vector unchanged on failure.
+ *  Storage grows geometrically through realloc and is never zero-filled:
+ *  slots past `count`, and slots added by _resize_uninit or _emplace_back,
+ *  hold indeterminate values until written. The vector never shrinks on its
+ *  own; call _shrink_to_fit (or _realloc) to give memory back.
  */
+// Expands a vector pointer into the `data, count` arguments of functions over plain arrays
+#define VEC_SPAN(vec) (vec)->data, (vec)->count
+
 #define DEF_VECTOR(ELEM_T, VEC_T)                                                                                      \
                                                                                                                        \
 	/* vector struct */                                                                                                \
@@ -29,20 +47,14 @@
                                                                                                                        \
 	/* initialise */                                                                                                   \
 	static inline void VEC_T##_init(VEC_T *vec, size_t initial_capacity) {                                             \
-		if (initial_capacity == 0) {                                                                                   \
-			vec->data = NULL;                                                                                          \
-			vec->capacity = 0;                                                                                         \
-			vec->count = 0;                                                                                            \
+		vec->data = NULL;                                                                                              \
+		vec->capacity = 0;                                                                                             \
+		vec->count = 0;                                                                                                \
+		if (initial_capacity == 0 || initial_capacity > SIZE_MAX / sizeof(ELEM_T))                                     \
 			return;                                                                                                    \
-		}                                                                                                              \
 		vec->data = (ELEM_T *) malloc(initial_capacity * sizeof(ELEM_T));                                              \
-		if (!vec->data) {                                                                                              \
-			vec->capacity = vec->count = 0;                                                                            \
-			return;                                                                                                    \
-		}                                                                                                              \
-		vec->capacity = initial_capacity;                                                                              \
-		vec->count = 0;                                                                                                \
-		memset(vec->data, 0, initial_capacity * sizeof(ELEM_T));                                                       \
+		if (vec->data)                                                                                                 \
+			vec->capacity = initial_capacity;                                                                          \
 	}                                                                                                                  \
                                                                                                                        \
 	/* de‑initialise */                                                                                                \
@@ -54,34 +66,74 @@
 		vec->capacity = vec->count = 0;                                                                                \
 	}                                                                                                                  \
                                                                                                                        \
-	/* reallocate */                                                                                                   \
-	static inline void VEC_T##_realloc(VEC_T *vec, size_t new_capacity) {                                              \
+	/* reallocate to exactly new_capacity, in place when the allocator can */                                          \
+	static inline int VEC_T##_realloc_exact(VEC_T *vec, size_t new_capacity) {                                         \
 		if (new_capacity == 0) {                                                                                       \
 			VEC_T##_deinit(vec);                                                                                       \
-			return;                                                                                                    \
+			return 1;                                                                                                  \
 		}                                                                                                              \
-		ELEM_T *new_data = (ELEM_T *) malloc(new_capacity * sizeof(ELEM_T));                                           \
+		if (new_capacity > SIZE_MAX / sizeof(ELEM_T))                                                                  \
+			return 0;                                                                                                  \
+		ELEM_T *new_data = (ELEM_T *) realloc(vec->data, new_capacity * sizeof(ELEM_T));                               \
 		if (!new_data)                                                                                                 \
-			return;                                                                                                    \
-		size_t copy_cnt = (new_capacity < vec->count) ? new_capacity : vec->count;                                     \
-		if (vec->data) {                                                                                               \
-			memcpy(new_data, vec->data, copy_cnt * sizeof(ELEM_T));                                                    \
-			free(vec->data);                                                                                           \
-		}                                                                                                              \
-		memset(new_data + copy_cnt, 0, (new_capacity - copy_cnt) * sizeof(ELEM_T));                                    \
+			return 0;                                                                                                  \
 		vec->data = new_data;                                                                                          \
 		vec->capacity = new_capacity;                                                                                  \
 		if (vec->count > new_capacity)                                                                                 \
 			vec->count = new_capacity;                                                                                 \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	DEF_VECTOR_OPS(ELEM_T, VEC_T)
+
+/*  Operations shared by DEF_VECTOR and DEF_SMALL_VECTOR, written against
+ *  data/capacity/count and the container's own VEC_T##_realloc_exact.
+ */
+#define DEF_VECTOR_OPS(ELEM_T, VEC_T)                                                                                  \
+                                                                                                                       \
+	/* reallocate */                                                                                                   \
+	static inline void VEC_T##_realloc(VEC_T *vec, size_t new_capacity) {                                              \
+		VEC_T##_realloc_exact(vec, new_capacity);                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* grow geometrically until at least min_capacity elements fit */                                                  \
+	static inline int VEC_T##_grow(VEC_T *vec, size_t min_capacity) {                                                  \
+		if (min_capacity <= vec->capacity)                                                                             \
+			return 1;                                                                                                  \
+		size_t new_cap = vec->capacity < SIZE_MAX / 2 ? vec->capacity * 2 : SIZE_MAX;                                  \
+		if (new_cap < 4)                                                                                               \
+			new_cap = 4;                                                                                               \
+		if (new_cap < min_capacity)                                                                                    \
+			new_cap = min_capacity;                                                                                    \
+		/* if doubling does not fit (memory, or a reservation limit), settle for what is needed */                     \
+		return VEC_T##_realloc_exact(vec, new_cap) ||                                                                  \
+			   (new_cap > min_capacity && VEC_T##_realloc_exact(vec, min_capacity));                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* reserve – make room for at least `capacity` elements */                                                         \
+	static inline int VEC_T##_reserve(VEC_T *vec, size_t capacity) {                                                   \
+		return capacity <= vec->capacity || VEC_T##_realloc_exact(vec, capacity);                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* shrink_to_fit – release the capacity beyond count */                                                            \
+	static inline int VEC_T##_shrink_to_fit(VEC_T *vec) {                                                              \
+		return vec->count == vec->capacity || VEC_T##_realloc_exact(vec, vec->count);                                  \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* emplace_back – append an uninitialised element and return it, or NULL */                                        \
+	static inline ELEM_T *VEC_T##_emplace_back(VEC_T *vec) {                                                           \
+		if (vec->count == vec->capacity && !VEC_T##_grow(vec, vec->count + 1))                                         \
+			return NULL;                                                                                               \
+		return &vec->data[vec->count++];                                                                               \
 	}                                                                                                                  \
                                                                                                                        \
 	/* push_back – append a value, growing if necessary */                                                             \
-	static inline void VEC_T##_push_back(VEC_T *vec, ELEM_T value) {                                                   \
-		if (vec->count == vec->capacity) {                                                                             \
-			size_t new_cap = (vec->capacity == 0) ? 1 : vec->capacity * 2;                                             \
-			VEC_T##_realloc(vec, new_cap);                                                                             \
-		}                                                                                                              \
-		vec->data[vec->count++] = value;                                                                               \
+	static inline int VEC_T##_push_back(VEC_T *vec, ELEM_T value) {                                                    \
+		ELEM_T *slot = VEC_T##_emplace_back(vec);                                                                      \
+		if (!slot)                                                                                                     \
+			return 0;                                                                                                  \
+		*slot = value;                                                                                                 \
+		return 1;                                                                                                      \
 	}                                                                                                                  \
                                                                                                                        \
 	/* pop_back – remove last element; optionally retrieve it */                                                       \
@@ -91,14 +143,46 @@
 		vec->count--;                                                                                                  \
 		if (out)                                                                                                       \
 			*out = vec->data[vec->count];                                                                              \
-		/* optional shrink when usage drops below 1/4 of capacity */                                                   \
-		if (vec->capacity > 1 && vec->count < vec->capacity / 4) {                                                     \
-			size_t new_cap = vec->capacity / 2;                                                                        \
-			if (new_cap < vec->count)                                                                                  \
-				new_cap = vec->count;                                                                                  \
-			VEC_T##_realloc(vec, new_cap);                                                                             \
-		}                                                                                                              \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* resize_uninit – set count, leaving any new elements uninitialised */                                            \
+	static inline int VEC_T##_resize_uninit(VEC_T *vec, size_t count) {                                                \
+		if (!VEC_T##_grow(vec, count))                                                                                 \
+			return 0;                                                                                                  \
+		vec->count = count;                                                                                            \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* insert_range – copy n values in before element `index` (index == count appends); */                             \
+	/* the values must not point into the vector itself */                                                             \
+	static inline int VEC_T##_insert_range(VEC_T *vec, size_t index, const ELEM_T *values, size_t n) {                 \
+		if (index > vec->count || n > SIZE_MAX - vec->count)                                                           \
+			return 0;                                                                                                  \
+		if (n == 0)                                                                                                    \
+			return 1;                                                                                                  \
+		if (!VEC_T##_grow(vec, vec->count + n))                                                                        \
+			return 0;                                                                                                  \
+		memmove(vec->data + index + n, vec->data + index, (vec->count - index) * sizeof(ELEM_T));                      \
+		memcpy(vec->data + index, values, n * sizeof(ELEM_T));                                                         \
+		vec->count += n;                                                                                               \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* append_n – copy n values to the end */                                                                          \
+	static inline int VEC_T##_append_n(VEC_T *vec, const ELEM_T *values, size_t n) {                                   \
+		return VEC_T##_insert_range(vec, vec->count, values, n);                                                       \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* erase_range – remove n elements starting at `index`, keeping the order of the rest */                           \
+	static inline int VEC_T##_erase_range(VEC_T *vec, size_t index, size_t n) {                                        \
+		if (index > vec->count || n > vec->count - index)                                                              \
+			return 0;                                                                                                  \
+		if (n == 0)                                                                                                    \
+			return 1;                                                                                                  \
+		memmove(vec->data + index, vec->data + index + n, (vec->count - index - n) * sizeof(ELEM_T));                  \
+		vec->count -= n;                                                                                               \
 		return 1;                                                                                                      \
 	}
 
-#endif /* VECTOR_H */
\ No newline at end of file
+#endif /* VECTOR_H */
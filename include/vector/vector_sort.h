@@ -0,0 +1,139 @@
+#ifndef VECTOR_SORT_H
+#define VECTOR_SORT_H
+
+#include <stddef.h>
+
+/*  Comparison sort for DEF_VECTOR
+ *
+ *  Usage:
+ *      DEF_VECTOR(Sprite, SpriteVec)
+ *      #define SPRITE_LESS(a, b) ((a)->depth < (b)->depth)
+ *      DEF_VECTOR_SORT(Sprite, SpriteVec, SPRITE_LESS)
+ *
+ *  Generates:
+ *      void SpriteVec_sort(SpriteVec *vec);
+ *      void SpriteVec_sort_range(Sprite *data, size_t n);
+ *      int  SpriteVec_is_sorted(const Sprite *data, size_t n);
+ *
+ *  LESS(const ELEM_T *a, const ELEM_T *b) is a function or macro returning
+ *  non-zero when a orders before b (a strict weak ordering). It is expanded
+ *  into the generated code, so unlike qsort there is no call through a
+ *  function pointer per comparison.
+ *
+ *  The sort is an introsort: quicksort with a median-of-three pivot,
+ *  insertion sort for short ranges and heapsort once the recursion gets too
+ *  deep, so it takes O(n log n) time in the worst case and O(log n) stack. It
+ *  is not stable. For integer, float or 64-bit key/value data, the radix
+ *  sorts of radix_sort.h are faster on large arrays.
+ */
+
+// Ranges of at most this many elements are finished by insertion sort
+#define VECTOR_SORT_INSERTION_MAX 16
+
+#define DEF_VECTOR_SORT(ELEM_T, VEC_T, LESS)                                                                           \
+	static inline void VEC_T##_sort_swap(ELEM_T *a, ELEM_T *b) {                                                       \
+		ELEM_T tmp = *a;                                                                                               \
+		*a = *b;                                                                                                       \
+		*b = tmp;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void VEC_T##_insertion_sort(ELEM_T *data, size_t n) {                                                \
+		for (size_t i = 1; i < n; ++i) {                                                                               \
+			ELEM_T value = data[i];                                                                                    \
+			size_t j = i;                                                                                              \
+			while (j > 0 && LESS(&value, &data[j - 1])) {                                                              \
+				data[j] = data[j - 1];                                                                                 \
+				--j;                                                                                                   \
+			}                                                                                                          \
+			data[j] = value;                                                                                           \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void VEC_T##_sift_down(ELEM_T *data, size_t root, size_t n) {                                        \
+		for (;;) {                                                                                                     \
+			size_t child = 2 * root + 1;                                                                               \
+			if (child >= n)                                                                                            \
+				return;                                                                                                \
+			if (child + 1 < n && LESS(&data[child], &data[child + 1]))                                                 \
+				++child;                                                                                               \
+			if (!LESS(&data[root], &data[child]))                                                                      \
+				return;                                                                                                \
+			VEC_T##_sort_swap(&data[root], &data[child]);                                                              \
+			root = child;                                                                                              \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	static inline void VEC_T##_heap_sort(ELEM_T *data, size_t n) {                                                     \
+		for (size_t i = n / 2; i-- > 0;)                                                                               \
+			VEC_T##_sift_down(data, i, n);                                                                             \
+		for (size_t end = n; end-- > 1;) {                                                                             \
+			VEC_T##_sort_swap(&data[0], &data[end]);                                                                   \
+			VEC_T##_sift_down(data, 0, end);                                                                           \
+		}                                                                                                              \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* quicksort the larger side in a loop and recurse into the smaller, until depth runs out */                       \
+	static void VEC_T##_introsort(ELEM_T *data, size_t n, size_t depth) {                                              \
+		while (n > VECTOR_SORT_INSERTION_MAX) {                                                                        \
+			if (depth-- == 0) {                                                                                        \
+				VEC_T##_heap_sort(data, n);                                                                            \
+				return;                                                                                                \
+			}                                                                                                          \
+			/* median of three; data[0] <= pivot <= data[n - 1] then bound both scans */                               \
+			ELEM_T *lo = data, *mid = data + n / 2, *hi = data + n - 1;                                                \
+			if (LESS(mid, lo))                                                                                         \
+				VEC_T##_sort_swap(mid, lo);                                                                            \
+			if (LESS(hi, mid)) {                                                                                       \
+				VEC_T##_sort_swap(hi, mid);                                                                            \
+				if (LESS(mid, lo))                                                                                     \
+					VEC_T##_sort_swap(mid, lo);                                                                        \
+			}                                                                                                          \
+			ELEM_T pivot = *mid;                                                                                       \
+			size_t i = 0, j = n - 1;                                                                                   \
+			for (;;) {                                                                                                 \
+				while (LESS(&data[i], &pivot))                                                                         \
+					++i;                                                                                               \
+				while (LESS(&pivot, &data[j]))                                                                         \
+					--j;                                                                                               \
+				if (i >= j)                                                                                            \
+					break;                                                                                             \
+				VEC_T##_sort_swap(&data[i], &data[j]);                                                                 \
+				++i;                                                                                                   \
+				--j;                                                                                                   \
+			}                                                                                                          \
+			size_t left = j + 1;                                                                                       \
+			if (left < n - left) {                                                                                     \
+				VEC_T##_introsort(data, left, depth);                                                                  \
+				data += left;                                                                                          \
+				n -= left;                                                                                             \
+			} else {                                                                                                   \
+				VEC_T##_introsort(data + left, n - left, depth);                                                       \
+				n = left;                                                                                              \
+			}                                                                                                          \
+		}                                                                                                              \
+		VEC_T##_insertion_sort(data, n);                                                                               \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* sort_range – sort n elements in place */                                                                        \
+	static inline void VEC_T##_sort_range(ELEM_T *data, size_t n) {                                                    \
+		size_t depth = 0;                                                                                              \
+		for (size_t m = n; m > 1; m >>= 1)                                                                             \
+			depth += 2;                                                                                                \
+		VEC_T##_introsort(data, n, depth);                                                                             \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* sort – sort the elements of the vector in place */                                                              \
+	static inline void VEC_T##_sort(VEC_T *vec) {                                                                      \
+		VEC_T##_sort_range(vec->data, vec->count);                                                                     \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* is_sorted – 1 if no element orders before its predecessor */                                                    \
+	static inline int VEC_T##_is_sorted(const ELEM_T *data, size_t n) {                                                \
+		for (size_t i = 1; i < n; ++i) {                                                                               \
+			if (LESS(&data[i], &data[i - 1]))                                                                          \
+				return 0;                                                                                              \
+		}                                                                                                              \
+		return 1;                                                                                                      \
+	}
+
+#endif /* VECTOR_SORT_H */
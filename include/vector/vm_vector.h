@@ -0,0 +1,165 @@
+#ifndef VM_VECTOR_H
+#define VM_VECTOR_H
+
+// MAP_ANONYMOUS, MAP_NORESERVE, madvise and mincore are not part of strict
+// ISO C builds; this only takes effect when no system header came first
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "vector/vector.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*  Virtual-memory-reserved vector macro (Linux / POSIX mmap)
+ *
+ *  Usage:
+ *      DEF_VM_VECTOR(Particle, ParticleVmVec)
+ *
+ *      ParticleVmVec particles;
+ *      if (!ParticleVmVec_init(&particles, 50000000, VM_VECTOR_HUGE_PAGES))
+ *          ...
+ *
+ *  Generates:
+ *      typedef struct { Particle *data; size_t capacity; size_t count; size_t max_count; ... } ParticleVmVec;
+ *      int  ParticleVmVec_init(ParticleVmVec *vec, size_t max_count, unsigned flags);
+ *      void ParticleVmVec_deinit(ParticleVmVec *vec);
+ *      ... and the other DEF_VECTOR functions, with the same semantics.
+ *
+ *  _init reserves address space for max_count elements without committing
+ *  memory (mmap with PROT_NONE). Growing makes more of the range accessible
+ *  in place, so it never copies, never needs twice the memory, and `data` and
+ *  every element address stay the same for the life of the vector. Growing
+ *  past max_count fails like an allocation failure. Shrinking (_realloc,
+ *  _shrink_to_fit) returns the pages past the new capacity to the OS.
+ *
+ *  Memory is committed in whole pages, so capacity may exceed what was asked
+ *  for. With VM_VECTOR_HUGE_PAGES the range is aligned to and committed in
+ *  2 MiB steps and marked MADV_HUGEPAGE, so transparent huge pages can back
+ *  it and cut TLB misses on large arrays; where the kernel does not support
+ *  them the vector works with normal pages.
+ *
+ *  Reserving costs only address space (and a little kernel bookkeeping), so
+ *  max_count can be generous; on 64-bit systems reserving many GiB is fine.
+ *
+ *  The header needs the BSD/SVID mmap flags. It defines _DEFAULT_SOURCE for
+ *  strict -std=c11 builds, which works only when it is included before any
+ *  system header; otherwise define _DEFAULT_SOURCE (or _GNU_SOURCE) for the
+ *  translation unit.
+ */
+
+// _init flag: align and commit in huge-page steps and ask for transparent huge pages
+#define VM_VECTOR_HUGE_PAGES 1u
+
+// Huge page size on x86-64 and arm64 with 4 KiB base pages
+#define VM_VECTOR_HUGE_PAGE_SIZE ((size_t) 2 << 20)
+
+static inline size_t vm_vector_round(size_t bytes, size_t granule) {
+	return (bytes + granule - 1) / granule * granule;
+}
+
+// Reserves `bytes` (a multiple of `align`) of inaccessible address space aligned to `align`; NULL on failure
+static inline void *vm_vector_reserve(size_t bytes, size_t align) {
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+	size_t slack = align > page ? align : 0;
+	if (bytes > SIZE_MAX - slack)
+		return NULL;
+	char *base = (char *) mmap(NULL, bytes + slack, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == (char *) MAP_FAILED)
+		return NULL;
+	if (slack) {
+		// Over-reserve, then unmap the misaligned head and the rest of the tail
+		char *aligned = (char *) (((uintptr_t) base + align - 1) & ~(uintptr_t) (align - 1));
+		if (aligned > base)
+			munmap(base, (size_t) (aligned - base));
+		size_t tail = (size_t) (base + bytes + slack - (aligned + bytes));
+		if (tail)
+			munmap(aligned + bytes, tail);
+		base = aligned;
+	}
+	return base;
+}
+
+// Makes [from, to) of a reservation readable and writable
+static inline int vm_vector_commit(char *base, size_t from, size_t to, int huge) {
+	if (mprotect(base + from, to - from, PROT_READ | PROT_WRITE) != 0)
+		return 0;
+#ifdef MADV_HUGEPAGE
+	if (huge)
+		madvise(base + from, to - from, MADV_HUGEPAGE); // only a hint; ignored where unsupported
+#else
+	(void) huge;
+#endif
+	return 1;
+}
+
+// Returns [from, to) of a reservation to the OS and makes it inaccessible again
+static inline int vm_vector_decommit(char *base, size_t from, size_t to) {
+	void *p = mmap(base + from, to - from, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+	return p != MAP_FAILED;
+}
+
+#define DEF_VM_VECTOR(ELEM_T, VEC_T)                                                                                   \
+	typedef struct {                                                                                                   \
+		ELEM_T *data;                                                                                                  \
+		size_t	capacity;                                                                                              \
+		size_t	count;                                                                                                 \
+		size_t	max_count;	/* elements the reservation holds */                                                       \
+		size_t	reserved;	/* bytes of address space reserved */                                                      \
+		size_t	committed;	/* bytes made accessible, from the start */                                                \
+		size_t	granule;	/* commit step in bytes */                                                                 \
+		int		huge;                                                                                                  \
+	} VEC_T;                                                                                                           \
+                                                                                                                       \
+	/* de‑initialise: release the whole reservation */                                                                 \
+	static inline void VEC_T##_deinit(VEC_T *vec) {                                                                    \
+		if (vec->data)                                                                                                 \
+			munmap(vec->data, vec->reserved);                                                                          \
+		vec->data = NULL;                                                                                              \
+		vec->capacity = vec->count = vec->max_count = 0;                                                               \
+		vec->reserved = vec->committed = 0;                                                                            \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* commit or release pages so that new_capacity elements (rounded up to whole steps) are accessible */             \
+	static inline int VEC_T##_realloc_exact(VEC_T *vec, size_t new_capacity) {                                         \
+		if (new_capacity > vec->max_count)                                                                             \
+			return 0;                                                                                                  \
+		size_t bytes = vm_vector_round(new_capacity * sizeof(ELEM_T), vec->granule);                                   \
+		if (bytes > vec->committed) {                                                                                  \
+			if (!vm_vector_commit((char *) vec->data, vec->committed, bytes, vec->huge))                               \
+				return 0;                                                                                              \
+		} else if (bytes < vec->committed) {                                                                           \
+			if (!vm_vector_decommit((char *) vec->data, bytes, vec->committed))                                        \
+				return 0;                                                                                              \
+		}                                                                                                              \
+		vec->committed = bytes;                                                                                        \
+		vec->capacity = bytes / sizeof(ELEM_T);                                                                        \
+		if (vec->capacity > vec->max_count)                                                                            \
+			vec->capacity = vec->max_count;                                                                            \
+		if (vec->count > vec->capacity)                                                                                \
+			vec->count = vec->capacity;                                                                                \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	/* initialise: reserve room for max_count elements, committing none; 1 on success */                               \
+	static inline int VEC_T##_init(VEC_T *vec, size_t max_count, unsigned flags) {                                     \
+		vec->data = NULL;                                                                                              \
+		vec->capacity = vec->count = vec->max_count = 0;                                                               \
+		vec->committed = 0;                                                                                            \
+		vec->huge = (flags & VM_VECTOR_HUGE_PAGES) != 0;                                                               \
+		vec->granule = vec->huge ? VM_VECTOR_HUGE_PAGE_SIZE : (size_t) sysconf(_SC_PAGESIZE);                          \
+		if (max_count == 0 || max_count > (SIZE_MAX - VM_VECTOR_HUGE_PAGE_SIZE) / sizeof(ELEM_T) / 2)                  \
+			return 0;                                                                                                  \
+		vec->reserved = vm_vector_round(max_count * sizeof(ELEM_T), vec->granule);                                     \
+		vec->data = (ELEM_T *) vm_vector_reserve(vec->reserved, vec->granule);                                         \
+		if (!vec->data)                                                                                                \
+			return 0;                                                                                                  \
+		vec->max_count = max_count;                                                                                    \
+		return 1;                                                                                                      \
+	}                                                                                                                  \
+                                                                                                                       \
+	DEF_VECTOR_OPS(ELEM_T, VEC_T)
+
+#endif /* VM_VECTOR_H */
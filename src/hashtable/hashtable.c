@@ -1,12 +1,253 @@
 #include "hashtable/hashtable.h"
+#include "fnv1a.h"
 #include "hashtable/hash.h"
+#include "hashtable/hash64.h"
+#include "ht_internal.h"
 #include "string.h"
 
-DEF_HASH_FN_NULLTERM(unsigned, hash_key);
+// Chained tables start growing once element_count exceeds bucket_count times
+// this factor
+#ifndef HT_MAX_LOAD_FACTOR
+#define HT_MAX_LOAD_FACTOR 1
+#endif
+
+// Number of non-empty buckets migrated by each operation while an incremental
+// rehash is in progress
+#ifndef HT_REHASH_STEP
+#define HT_REHASH_STEP 4
+#endif
+
 DEF_HASH_FN_SIZED(unsigned, hash_key_s);
+DEF_FNV1A(uint64_t, 0xcbf29ce484222325ull, 0x100000001b3ull, ht_fnv1a)
+
+uint64_t ht_hash_wy(const void *key, size_t keylen, uint64_t seed) {
+	return hash64_wy(key, keylen, seed);
+}
+
+uint64_t ht_hash_xxh(const void *key, size_t keylen, uint64_t seed) {
+	return hash64_xxh(key, keylen, seed);
+}
+
+uint64_t ht_hash_crc(const void *key, size_t keylen, uint64_t seed) {
+	return hash64_crc(key, keylen, seed);
+}
+
+uint64_t ht_hash_fnv1a(const void *key, size_t keylen, uint64_t seed) {
+	return ht_fnv1a_buf_uint64_t(key, keylen) ^ seed;
+}
+
+uint64_t ht_hash_shift_add(const void *key, size_t keylen, uint64_t seed) {
+	return hash_key_s((void *) key, keylen) ^ seed;
+}
+
+void ht_set_default_hash(HtTable *tab) {
+	tab->hash_fn = ht_hash_wy;
+	tab->hash_seed = 0;
+}
+
+bool ht_set_hash_fn(HtTable *tab, HtHashFn hash_fn, uint64_t seed) {
+	if (tab->element_count != 0) {
+		return false;
+	}
+	tab->hash_fn = hash_fn ? hash_fn : ht_hash_wy;
+	tab->hash_seed = seed;
+	return true;
+}
+
+// Sizes the filter for twice the live entries and refills it from them. On
+// failure the filter is left as it was, which still holds every live key.
+static bool ht_bloom_rebuild(HtTable *tab) {
+	if (!ht_bloom_reset(tab->bloom, (size_t) tab->element_count * 2)) {
+		return false;
+	}
+	if (tab->mode == HT_MODE_FLAT) {
+		for (unsigned i = 0; i < tab->bucket_count; ++i) {
+			if (tab->ctrl[i] >= 0) {
+				ht_bloom_add_hash(tab->bloom, tab->slots[i].hash);
+			}
+		}
+		return true;
+	}
+	// Mid-rehash, both arrays hold part of the entries
+	for (int table = 0; table < 2; ++table) {
+		HtNode **buckets = table ? tab->rehash_buckets : tab->buckets;
+		unsigned count = table ? tab->rehash_bucket_count : tab->bucket_count;
+		for (unsigned i = 0; buckets && i < count; ++i) {
+			for (HtNode *node = buckets[i]; node != NULL; node = node->pnext) {
+				ht_bloom_add_hash(tab->bloom, node->hash);
+			}
+		}
+	}
+	return true;
+}
+
+void ht_bloom_inserted(HtTable *tab, uint64_t hash) {
+	if (!tab->bloom) {
+		return;
+	}
+	ht_bloom_add_hash(tab->bloom, hash);
+	if (ht_bloom_stale(tab->bloom) && !ht_bloom_rebuild(tab)) {
+		ht_bloom_postpone(tab->bloom);
+	}
+}
+
+void ht_bloom_deleted(HtTable *tab) {
+	if (!tab->bloom) {
+		return;
+	}
+	++(tab->bloom->removed);
+	if (ht_bloom_stale(tab->bloom) && !ht_bloom_rebuild(tab)) {
+		ht_bloom_postpone(tab->bloom);
+	}
+}
+
+bool ht_attach_bloom(HtTable *tab, unsigned bits_per_key) {
+	HtBloom *bloom = htmalloc(sizeof(HtBloom));
+	if (!bloom || !ht_bloom_init(bloom, (size_t) tab->element_count * 2, bits_per_key)) {
+		htfree(bloom);
+		return false;
+	}
+	ht_detach_bloom(tab);
+	tab->bloom = bloom;
+	ht_bloom_rebuild(tab); // Cannot fail: the filter already has this size
+	return true;
+}
+
+void ht_detach_bloom(HtTable *tab) {
+	if (tab->bloom) {
+		ht_bloom_deinit(tab->bloom);
+		htfree(tab->bloom);
+		tab->bloom = NULL;
+	}
+}
+
+// Returns the head of the chain that may hold a key with this hash in one of
+// the bucket arrays (0 = buckets, 1 = rehash_buckets), or NULL when that array
+// cannot hold it: buckets below rehash_index have already been migrated.
+static HtNode **ht_chain(HtTable *tab, uint64_t hash, int table) {
+	if (table == 0) {
+		unsigned idx = (unsigned) (hash % tab->bucket_count);
+		return (tab->rehash_buckets && idx < tab->rehash_index) ? NULL : &tab->buckets[idx];
+	}
+	return tab->rehash_buckets ? &tab->rehash_buckets[hash % tab->rehash_bucket_count] : NULL;
+}
+
+// Returns the link (bucket head or pnext field) pointing at the node that holds
+// the key, or NULL if the key is absent
+static HtNode **ht_find_link(HtTable *tab, const void *key, size_t keylen, uint64_t hash) {
+	for (int table = 0; table < 2; ++table) {
+		HtNode **link = ht_chain(tab, hash, table);
+		if (link == NULL) {
+			continue;
+		}
+		for (; *link != NULL; link = &(*link)->pnext) {
+			HtNode *node = *link;
+			// Reject on the cached hash and length before touching key bytes
+			if (node->hash == hash && node->keylen == keylen &&
+				memcmp(ht_key_ptr(&node->key, keylen), key, keylen) == 0) {
+				return link;
+			}
+		}
+	}
+	return NULL;
+}
+
+// Chain that receives new keys: the rehash target while rehashing
+static HtNode **ht_insert_chain(HtTable *tab, uint64_t hash) {
+	return tab->rehash_buckets ? ht_chain(tab, hash, 1) : ht_chain(tab, hash, 0);
+}
+
+// Chain a lookup of this hash visits first, for prefetching
+static HtNode **ht_first_chain(HtTable *tab, uint64_t hash) {
+	HtNode **chain = ht_chain(tab, hash, 0);
+	return chain ? chain : ht_chain(tab, hash, 1);
+}
+
+static void ht_free_chains(HtTable *tab, HtNode **buckets, unsigned bucket_count) {
+	for (unsigned int i = 0; i < bucket_count; ++i) {
+		HtNode *currNode = buckets[i];
+		while (currNode != NULL) {
+			HtNode *tempNode = currNode; // Keep track of the current node to free it afterwards
+			currNode = currNode->pnext;	 // Move to the next node
+			ht_key_release(tab, &tempNode->key, tempNode->keylen); // Free the key
+			ht_dealloc(tab, tempNode, sizeof(HtNode));				// Free the current node
+		}
+	}
+	ht_dealloc(tab, buckets, sizeof(HtNode *) * bucket_count); // Free the array of buckets
+}
+
+static void *ht_default_alloc(void *ctx, size_t size) {
+	(void) ctx;
+	return htmalloc(size);
+}
+
+static void ht_default_free(void *ctx, void *p, size_t size) {
+	(void) ctx;
+	(void) size;
+	htfree(p);
+}
+
+void ht_set_allocator(HtTable *tab, const HtAllocator *allocator) {
+	if (allocator) {
+		tab->allocator = *allocator;
+	} else {
+		HtAllocator fallback = {ht_default_alloc, ht_default_free, NULL, NULL};
+		tab->allocator = fallback;
+	}
+}
+
+// Starts migrating every entry into a new array of `bucket_count` buckets.
+// The migration itself happens in ht_rehash_step.
+static bool ht_rehash_begin(HtTable *tab, unsigned bucket_count) {
+	HtNode **buckets = ht_alloc(tab, sizeof(HtNode *) * bucket_count);
+	if (!buckets) {
+		return false;
+	}
+	for (unsigned i = 0; i < bucket_count; ++i) {
+		buckets[i] = NULL;
+	}
+
+	tab->rehash_buckets = buckets;
+	tab->rehash_bucket_count = bucket_count;
+	tab->rehash_index = 0;
+	return true;
+}
+
+// Moves the whole table into `bucket_count` buckets before returning
+static bool ht_rehash_now(HtTable *tab, unsigned bucket_count) {
+	// Finish any migration already underway first
+	while (ht_rehash_step(tab, tab->bucket_count)) {
+	}
+	if (!ht_rehash_begin(tab, bucket_count)) {
+		return false;
+	}
+	while (ht_rehash_step(tab, tab->bucket_count)) {
+	}
+	return true;
+}
+
+// Grows the table once the load factor is exceeded; the entries then move over
+// a few buckets at a time as later operations run
+static void ht_maybe_grow(HtTable *tab) {
+	if (tab->rehash_buckets || tab->element_count <= (size_t) tab->bucket_count * HT_MAX_LOAD_FACTOR) {
+		return;
+	}
+	unsigned target = tab->bucket_count ? tab->bucket_count * 2 : 1;
+	if (target > tab->bucket_count) {
+		ht_rehash_begin(tab, target); // On failure the table just stays at its current size
+	}
+}
 
 void ht_init_table(HtTable *tab, unsigned bucket_count) {
-	tab->buckets = htmalloc(sizeof(HtNode *) * bucket_count);
+	ht_init_table_with_allocator(tab, bucket_count, NULL);
+}
+
+void ht_init_table_with_allocator(HtTable *tab, unsigned bucket_count, const HtAllocator *allocator) {
+	ht_set_allocator(tab, allocator);
+	ht_set_default_hash(tab);
+	ht_stats_reset(tab);
+	tab->bloom = NULL;
+	tab->buckets = ht_alloc(tab, sizeof(HtNode *) * bucket_count);
 
 	for (unsigned i = 0; i < bucket_count; ++i) {
 		tab->buckets[i] = NULL;
@@ -14,154 +255,336 @@ void ht_init_table(HtTable *tab, unsigned bucket_count) {
 
 	tab->bucket_count = bucket_count;
 	tab->element_count = 0;
+	tab->mode = HT_MODE_CHAINED;
+	tab->rehash_buckets = NULL;
+	tab->rehash_bucket_count = 0;
+	tab->rehash_index = 0;
+	tab->ctrl = NULL;
+	tab->slots = NULL;
+	tab->tombstone_count = 0;
+}
+
+void ht_init_table_flat(HtTable *tab, unsigned capacity) {
+	htf_init_table(tab, capacity, NULL);
+}
+
+void ht_init_table_flat_with_allocator(HtTable *tab, unsigned capacity, const HtAllocator *allocator) {
+	htf_init_table(tab, capacity, allocator);
 }
 
 void ht_deinit_table(HtTable *tab) {
-	for (unsigned int i = 0; i < tab->bucket_count; ++i) {
-		HtNode *currNode = tab->buckets[i];
-		while (currNode != NULL) {
-			HtNode *tempNode = currNode; // Keep track of the current node to free it afterwards
-			currNode = currNode->pnext;	 // Move to the next node
-			htfree(tempNode->key);		 // Free the key
-			htfree(tempNode);			 // Free the current node
+	ht_detach_bloom(tab);
+	if (tab->mode == HT_MODE_FLAT) {
+		htf_deinit_table(tab);
+		return;
+	}
+
+	if (tab->allocator.release) {
+		// Every node, key and bucket array came from the allocator, so drop it
+		// all at once instead of walking the chains
+		tab->allocator.release(tab->allocator.ctx);
+	} else {
+		ht_free_chains(tab, tab->buckets, tab->bucket_count);
+		if (tab->rehash_buckets) {
+			ht_free_chains(tab, tab->rehash_buckets, tab->rehash_bucket_count);
 		}
 	}
 
-	htfree(tab->buckets);	// Free the array of buckets
 	tab->buckets = NULL;	// Avoid dangling pointer
 	tab->bucket_count = 0;	// Reset bucket count
 	tab->element_count = 0; // Reset element count
+	tab->rehash_buckets = NULL;
+	tab->rehash_bucket_count = 0;
+	tab->rehash_index = 0;
 }
 
-bool ht_has(HtTable *tab, void *key) {
-	// Calculate the bucket index using the hash function
-	unsigned int idx = hash_key(key) % tab->bucket_count;
+bool ht_rehash_step(HtTable *tab, unsigned n) {
+	if (tab->mode == HT_MODE_FLAT || !tab->rehash_buckets) {
+		return false;
+	}
 
-	// Get the head of the linked list at the calculated bucket index
-	HtNode *currNode = tab->buckets[idx];
+	// Like Redis, bound the number of empty buckets visited as well so one
+	// step stays cheap on a sparse table
+	unsigned empty_visits = n * 10;
+	while (n > 0 && tab->rehash_index < tab->bucket_count) {
+		HtNode *currNode = tab->buckets[tab->rehash_index];
+		if (currNode == NULL) {
+			++(tab->rehash_index);
+			if (--empty_visits == 0) {
+				break;
+			}
+			continue;
+		}
 
-	// Traverse the linked list to check for the key
-	while (currNode != NULL) {
-		if (strcmp((const char *) currNode->key, (const char *) key) == 0) {
-			return true; // Key found
+		// Move the whole chain, node by node, to the heads of its new buckets
+		while (currNode != NULL) {
+			HtNode	*next = currNode->pnext;
+			unsigned idx = (unsigned) (currNode->hash % tab->rehash_bucket_count); // Cached, not rehashed
+			currNode->pnext = tab->rehash_buckets[idx];
+			tab->rehash_buckets[idx] = currNode;
+			currNode = next;
 		}
-		currNode = currNode->pnext; // Move to the next node
+		tab->buckets[tab->rehash_index++] = NULL;
+		--n;
+	}
+
+	if (tab->rehash_index < tab->bucket_count) {
+		return true;
+	}
+
+	// Migration complete: the target array becomes the table
+	ht_dealloc(tab, tab->buckets, sizeof(HtNode *) * tab->bucket_count);
+	tab->buckets = tab->rehash_buckets;
+	tab->bucket_count = tab->rehash_bucket_count;
+	tab->rehash_buckets = NULL;
+	tab->rehash_bucket_count = 0;
+	tab->rehash_index = 0;
+	return false;
+}
+
+bool ht_reserve(HtTable *tab, unsigned count) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_reserve(tab, count);
+	}
+
+	unsigned target = (count + HT_MAX_LOAD_FACTOR - 1) / HT_MAX_LOAD_FACTOR;
+	unsigned current = tab->rehash_buckets ? tab->rehash_bucket_count : tab->bucket_count;
+	if (target <= current) {
+		return true;
+	}
+	return ht_rehash_now(tab, target);
+}
+
+bool ht_shrink_to_fit(HtTable *tab) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_shrink_to_fit(tab);
+	}
+
+	unsigned target = (tab->element_count + HT_MAX_LOAD_FACTOR - 1) / HT_MAX_LOAD_FACTOR;
+	if (target == 0) {
+		target = 1;
+	}
+	unsigned current = tab->rehash_buckets ? tab->rehash_bucket_count : tab->bucket_count;
+	if (target >= current) {
+		return true;
+	}
+	return ht_rehash_now(tab, target);
+}
+
+bool ht_has_s(HtTable *tab, void *key, size_t keylen) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_has_s(tab, key, keylen);
 	}
 
-	return false; // Key not found
+	ht_rehash_step(tab, HT_REHASH_STEP);
+	uint64_t hash = ht_hash(tab, key, keylen);
+	bool	 found = !ht_bloom_rejects(tab, hash) && ht_find_link(tab, key, keylen, hash) != NULL;
+	HT_STATS_COUNT(tab->counters, found);
+	return found;
+}
+
+bool ht_has(HtTable *tab, void *key) {
+	return ht_has_s(tab, key, strlen(key));
 }
 
 bool ht_emplace_s(HtTable *tab, void *key, size_t keylen, void *value) {
-	unsigned int idx = hash_key_s(key, keylen) % tab->bucket_count;
-
-	// Check for duplicates by traversing the linked list in the bucket
-	HtNode *currNode = tab->buckets[idx];
-	while (currNode != NULL) {
-		// Compare the keys
-		if (strncmp(currNode->key, key, keylen) == 0) {
-			// Key already exists, update the value
-			currNode->value = value; // Update the existing value
-			return true;			 // Insertion successful
-		}
-		currNode = currNode->pnext; // Move to next node
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_emplace_s(tab, key, keylen, value);
+	}
+
+	ht_rehash_step(tab, HT_REHASH_STEP);
+
+	uint64_t hash = ht_hash(tab, key, keylen);
+
+	// Check for duplicates in the linked lists that may hold the key
+	HtNode **link = ht_bloom_rejects(tab, hash) ? NULL : ht_find_link(tab, key, keylen, hash);
+	if (link != NULL) {
+		// Key already exists, update the value
+		(*link)->value = value; // Update the existing value
+		return true;			// Insertion successful
 	}
 
 	// Create a new node since the key is unique
-	HtNode *new_node = htmalloc(sizeof(HtNode));
+	HtNode *new_node = ht_alloc(tab, sizeof(HtNode));
 	if (!new_node) {
 		// Handle allocation failure
 		return false;
 	}
 
-	new_node->key = htmalloc(keylen + 1);
-	if (!new_node->key) {
+	// Short keys live inside the node; only long ones need a second allocation
+	if (!ht_key_store(tab, &new_node->key, key, keylen)) {
 		// Handle key allocation failure
-		htfree(new_node); // Free the node allocated
+		ht_dealloc(tab, new_node, sizeof(HtNode)); // Free the node allocated
 		return false;
 	}
+	new_node->keylen = keylen;
+	new_node->hash = hash;
 
-#ifdef strcpy_s
-	strcpy_s(new_node->key, keylen + 1, key);
-#else
-	strncpy(new_node->key, key, keylen);
-	new_node->key[keylen] = '\0'; // Ensure null-termination
-#endif
-
-	new_node->value = value;			 // Assign the new value
-	new_node->pnext = tab->buckets[idx]; // Insert at the head of the list
-	tab->buckets[idx] = new_node;		 // Update the bucket
+	HtNode **chain = ht_insert_chain(tab, hash);
+	new_node->value = value;  // Assign the new value
+	new_node->pnext = *chain; // Insert at the head of the list
+	*chain = new_node;		  // Update the bucket
 
 	++(tab->element_count); // Increase the count of elements
+	ht_bloom_inserted(tab, hash);
+	ht_maybe_grow(tab);
 
 	return true; // Insertion successful
 }
 
+static size_t ht_chains_memory_usage(HtNode **buckets, unsigned bucket_count) {
+	size_t bytes = sizeof(HtNode *) * (size_t) bucket_count;
+	for (unsigned i = 0; i < bucket_count; ++i) {
+		for (HtNode *node = buckets[i]; node != NULL; node = node->pnext) {
+			bytes += sizeof(HtNode) + ht_key_heap_bytes(node->keylen);
+		}
+	}
+	return bytes;
+}
+
+size_t ht_memory_usage(const HtTable *tab) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_memory_usage(tab) + ht_bloom_memory_usage(tab->bloom);
+	}
+
+	size_t bytes = ht_chains_memory_usage(tab->buckets, tab->bucket_count);
+	if (tab->rehash_buckets) {
+		bytes += ht_chains_memory_usage(tab->rehash_buckets, tab->rehash_bucket_count);
+	}
+	return bytes + ht_bloom_memory_usage(tab->bloom);
+}
+
 bool ht_emplace(HtTable *tab, char *key, void *value) {
 	size_t len = strlen(key);
 	return ht_emplace_s(tab, key, len, value);
 }
 
+bool ht_delete_s(HtTable *tab, void *key, size_t keylen) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_delete_s(tab, key, keylen);
+	}
+
+	ht_rehash_step(tab, HT_REHASH_STEP);
+
+	uint64_t hash = ht_hash(tab, key, keylen);
+	HtNode **link = ht_bloom_rejects(tab, hash) ? NULL : ht_find_link(tab, key, keylen, hash);
+	if (link == NULL) {
+		return false;
+	}
+
+	HtNode *currNode = *link;
+	*link = currNode->pnext; // Bypass the node to delete
+	ht_key_release(tab, &currNode->key, keylen); // Free the key
+	ht_dealloc(tab, currNode, sizeof(HtNode));	  // Free the node itself
+	tab->element_count--;	 // Decrement the element count
+	ht_bloom_deleted(tab);
+	return true;
+}
+
 bool ht_delete(HtTable *tab, void *key) {
-	// Calculate the bucket index using the hash function
-	unsigned int idx = hash_key(key) % tab->bucket_count;
-
-	HtNode *prevNode = NULL;
-	HtNode *currNode = tab->buckets[idx];
-
-	while (currNode != NULL) {
-		// Check if the current node's key matches the key to delete
-		if (strcmp((const char *) currNode->key, (const char *) key) == 0) {
-			// If the node to delete is the head of the list
-			if (currNode == tab->buckets[idx]) {
-				tab->buckets[idx] = currNode->pnext; // Update head to the next node
-			} else {
-				// If it's a middle or last node
-				prevNode->pnext = currNode->pnext; // Bypass the current node
+	return ht_delete_s(tab, key, strlen(key));
+}
+
+void *ht_search(HtTable *tab, void *key) {
+	return ht_search_s(tab, key, strlen(key));
+}
+
+void *ht_search_s(HtTable *tab, void *key, size_t keylen) {
+	if (tab->mode == HT_MODE_FLAT) {
+		return htf_search_s(tab, key, keylen);
+	}
+
+	ht_rehash_step(tab, HT_REHASH_STEP);
+
+	uint64_t hash = ht_hash(tab, key, keylen);
+	HtNode **link = ht_bloom_rejects(tab, hash) ? NULL : ht_find_link(tab, key, keylen, hash);
+	HT_STATS_COUNT(tab->counters, link != NULL);
+	return link ? (*link)->value : NULL; // Return NULL if the key is not found
+}
+
+void ht_search_batch_s(HtTable *tab, void *const *keys, const size_t *keylens, size_t n, void **out_values) {
+	if (tab->mode == HT_MODE_FLAT) {
+		htf_search_batch_s(tab, keys, keylens, n, out_values);
+		return;
+	}
+
+	ht_rehash_step(tab, HT_REHASH_STEP);
+
+	uint64_t hashes[HT_BATCH_SIZE];
+	bool	 absent[HT_BATCH_SIZE];
+	for (size_t base = 0; base < n; base += HT_BATCH_SIZE) {
+		size_t count = n - base < HT_BATCH_SIZE ? n - base : HT_BATCH_SIZE;
+
+		// Hash every key of the batch and start loading its bucket, unless
+		// the filter already rules the key out
+		for (size_t i = 0; i < count; ++i) {
+			hashes[i] = ht_hash(tab, keys[base + i], keylens[base + i]);
+			absent[i] = ht_bloom_rejects(tab, hashes[i]);
+			if (!absent[i]) {
+				PREFETCH(ht_first_chain(tab, hashes[i]));
+			}
+		}
+		// By now the first buckets have arrived: start loading the chain heads
+		for (size_t i = 0; i < count; ++i) {
+			HtNode *head = absent[i] ? NULL : *ht_first_chain(tab, hashes[i]);
+			if (head) {
+				PREFETCH(head);
 			}
-			htfree(currNode->key); // Free the key
-			htfree(currNode);	   // Free the node itself
-			tab->element_count--;  // Decrement the element count
-			return true;		   // Exit the function
 		}
-		prevNode = currNode;		// Move to next node
-		currNode = currNode->pnext; // Continue traversal
+		for (size_t i = 0; i < count; ++i) {
+			HtNode **link = absent[i] ? NULL : ht_find_link(tab, keys[base + i], keylens[base + i], hashes[i]);
+			HT_STATS_COUNT(tab->counters, link != NULL);
+			out_values[base + i] = link ? (*link)->value : NULL;
+		}
 	}
-
-	return false;
 }
 
-void *ht_search(HtTable *tab, void *key) {
-	// Getting the bucket index for the given key
-	unsigned int bucketIndex = hash_key(key) % tab->bucket_count;
-
-	// Head of the linked list present at bucket index
-	HtNode *bucketHead = tab->buckets[bucketIndex];
-	while (bucketHead != NULL) {
-		// Compare the actual string values
-		if (strcmp((const char *) bucketHead->key, (const char *) key) == 0) {
-			// Key is found in the hashMap
-			return bucketHead->value; // Return the associated value
+void ht_search_batch(HtTable *tab, char *const *keys, size_t n, void **out_values) {
+	size_t keylens[HT_BATCH_SIZE];
+	for (size_t base = 0; base < n; base += HT_BATCH_SIZE) {
+		size_t count = n - base < HT_BATCH_SIZE ? n - base : HT_BATCH_SIZE;
+		for (size_t i = 0; i < count; ++i) {
+			keylens[i] = strlen(keys[base + i]);
 		}
-		bucketHead = bucketHead->pnext; // Move to the next node
+		ht_search_batch_s(tab, (void *const *) (keys + base), keylens, count, out_values + base);
 	}
+}
 
-	return NULL; // Return NULL if the key is not found
+void ht_stats_reset(HtTable *tab) {
+	tab->counters.hits = 0;
+	tab->counters.misses = 0;
 }
 
-void *ht_search_s(HtTable *tab, void *key, size_t keylen) {
-	// Getting the bucket index for the given key
-	unsigned int bucketIndex = hash_key(key) % tab->bucket_count;
-
-	// Head of the linked list present at the bucket index
-	HtNode *bucketHead = tab->buckets[bucketIndex];
-	while (bucketHead != NULL) {
-		// Compare the actual string values using strncmp
-		if (strncmp((const char *) bucketHead->key, (const char *) key, keylen) == 0) {
-			// Key is found in the hashMap
-			return bucketHead->value; // Return the associated value
+void ht_stats(const HtTable *tab, HtStats *stats) {
+	memset(stats, 0, sizeof(*stats));
+	if (tab->mode == HT_MODE_FLAT) {
+		htf_stats(tab, stats);
+	} else {
+		// Mid-rehash, both arrays hold part of the entries
+		size_t visits = 0;
+		for (int table = 0; table < 2; ++table) {
+			HtNode **buckets = table ? tab->rehash_buckets : tab->buckets;
+			unsigned count = table ? tab->rehash_bucket_count : tab->bucket_count;
+			for (unsigned i = 0; buckets && i < count; ++i) {
+				size_t length = 0;
+				for (HtNode *node = buckets[i]; node != NULL; node = node->pnext) {
+					visits += ++length; // Finding the k-th node of a chain visits k nodes
+				}
+				if (table == 0 && tab->rehash_buckets && i < tab->rehash_index) {
+					continue; // Already migrated, always empty
+				}
+				++stats->histogram[length < HT_STATS_HISTOGRAM ? length : HT_STATS_HISTOGRAM - 1];
+				stats->max_chain = length > stats->max_chain ? length : stats->max_chain;
+			}
 		}
-		bucketHead = bucketHead->pnext; // Move to the next node
+		stats->buckets = tab->rehash_buckets ? tab->rehash_bucket_count : tab->bucket_count;
+		stats->avg_probe = tab->element_count ? (double) visits / tab->element_count : 0;
 	}
 
-	return NULL; // Return NULL if the key is not found
+	stats->entries = tab->element_count;
+	stats->load_factor = stats->buckets ? (double) stats->entries / stats->buckets : 0;
+	stats->bytes = ht_memory_usage(tab);
+	stats->bytes_per_entry = stats->entries ? (double) stats->bytes / stats->entries : 0;
+	stats->hits = tab->counters.hits;
+	stats->misses = tab->counters.misses;
 }
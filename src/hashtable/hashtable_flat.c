@@ -0,0 +1,314 @@
+#include "ht_internal.h"
+#include "string.h"
+
+// Flat tables keep at most 7/8 of their slots in use (full or deleted)
+#define HTF_MAX_LOAD(slot_count) ((slot_count) - (slot_count) / 8)
+
+static inline signed char htf_tag(uint64_t hash) {
+	return (signed char) (hash & 0x7f);
+}
+
+static inline unsigned htf_home_group(const HtTable *tab, uint64_t hash) {
+	return (unsigned) (hash >> 7) & (tab->bucket_count / HT_GROUP_WIDTH - 1);
+}
+
+// Smallest power-of-two number of slots (at least one group) that holds
+// `count` entries under the maximum load factor
+static unsigned htf_slots_for(unsigned count) {
+	unsigned slots = HT_GROUP_WIDTH;
+	while (HTF_MAX_LOAD(slots) < count) {
+		slots *= 2;
+	}
+	return slots;
+}
+
+static bool htf_alloc_slots(HtTable *tab, unsigned slot_count) {
+	signed char *ctrl = ht_alloc(tab, slot_count);
+	HtSlot		*slots = ht_alloc(tab, sizeof(HtSlot) * slot_count);
+	if (!ctrl || !slots) {
+		ht_dealloc(tab, ctrl, slot_count);
+		ht_dealloc(tab, slots, sizeof(HtSlot) * slot_count);
+		return false;
+	}
+	memset(ctrl, HT_CTRL_EMPTY, slot_count);
+
+	tab->ctrl = ctrl;
+	tab->slots = slots;
+	tab->bucket_count = slot_count;
+	tab->tombstone_count = 0;
+	return true;
+}
+
+// Returns the slot index holding the key, or -1 if the key is absent
+static long htf_find(HtTable *tab, const void *key, size_t keylen, uint64_t hash) {
+	unsigned	group_mask = tab->bucket_count / HT_GROUP_WIDTH - 1;
+	unsigned	group = htf_home_group(tab, hash);
+	signed char tag = htf_tag(hash);
+
+	// Triangular probing over groups visits every group once the group count
+	// is a power of two
+	for (unsigned step = 1;; ++step) {
+		const signed char *ctrl = tab->ctrl + (size_t) group * HT_GROUP_WIDTH;
+
+		unsigned match = ht_group_match(ctrl, tag);
+		while (match) {
+			size_t		  idx = (size_t) group * HT_GROUP_WIDTH + ht_ctz(match);
+			HtSlot *slot = &tab->slots[idx];
+			if (slot->hash == hash && slot->keylen == keylen &&
+				memcmp(ht_key_ptr(&slot->key, keylen), key, keylen) == 0) {
+				return (long) idx;
+			}
+			match &= match - 1;
+		}
+
+		// An empty slot ends every probe sequence that could contain the key
+		if (ht_group_match(ctrl, HT_CTRL_EMPTY)) {
+			return -1;
+		}
+		group = (group + step) & group_mask;
+	}
+}
+
+// Returns the first empty or deleted slot along the probe sequence of `hash`
+static size_t htf_find_free(const HtTable *tab, uint64_t hash) {
+	unsigned group_mask = tab->bucket_count / HT_GROUP_WIDTH - 1;
+	unsigned group = htf_home_group(tab, hash);
+
+	for (unsigned step = 1;; ++step) {
+		unsigned free_mask = ht_group_match_free(tab->ctrl + (size_t) group * HT_GROUP_WIDTH);
+		if (free_mask) {
+			return (size_t) group * HT_GROUP_WIDTH + ht_ctz(free_mask);
+		}
+		group = (group + step) & group_mask;
+	}
+}
+
+// Moves every entry into a fresh slot array of `slot_count` slots. Stored
+// hashes are reused, so no key is hashed or compared again.
+static bool htf_resize(HtTable *tab, unsigned slot_count) {
+	signed char *old_ctrl = tab->ctrl;
+	HtSlot		*old_slots = tab->slots;
+	unsigned	 old_count = tab->bucket_count;
+
+	if (!htf_alloc_slots(tab, slot_count)) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < old_count; ++i) {
+		if (old_ctrl[i] >= 0) {
+			size_t idx = htf_find_free(tab, old_slots[i].hash);
+			tab->ctrl[idx] = old_ctrl[i];
+			tab->slots[idx] = old_slots[i];
+		}
+	}
+
+	ht_dealloc(tab, old_ctrl, old_count);
+	ht_dealloc(tab, old_slots, sizeof(HtSlot) * old_count);
+	return true;
+}
+
+void htf_init_table(HtTable *tab, unsigned capacity, const HtAllocator *allocator) {
+	tab->buckets = NULL;
+	tab->bucket_count = 0;
+	tab->element_count = 0;
+	tab->mode = HT_MODE_FLAT;
+	tab->ctrl = NULL;
+	tab->slots = NULL;
+	tab->tombstone_count = 0;
+	ht_set_allocator(tab, allocator);
+	ht_set_default_hash(tab);
+	ht_stats_reset(tab);
+	tab->bloom = NULL;
+
+	// On failure the table is left without slots; it reads as empty and the
+	// first emplace tries the allocation again
+	htf_alloc_slots(tab, htf_slots_for(capacity));
+}
+
+void htf_deinit_table(HtTable *tab) {
+	if (tab->allocator.release) {
+		// Everything came from the allocator, so drop it all at once
+		tab->allocator.release(tab->allocator.ctx);
+	} else {
+		for (unsigned i = 0; i < tab->bucket_count; ++i) {
+			if (tab->ctrl[i] >= 0) {
+				ht_key_release(tab, &tab->slots[i].key, tab->slots[i].keylen); // Free the key
+			}
+		}
+		ht_dealloc(tab, tab->ctrl, tab->bucket_count);
+		ht_dealloc(tab, tab->slots, sizeof(HtSlot) * tab->bucket_count);
+	}
+
+	tab->ctrl = NULL;
+	tab->slots = NULL;
+	tab->bucket_count = 0;
+	tab->element_count = 0;
+	tab->tombstone_count = 0;
+}
+
+bool htf_reserve(HtTable *tab, unsigned count) {
+	unsigned slot_count = htf_slots_for(count);
+	return slot_count <= tab->bucket_count || htf_resize(tab, slot_count);
+}
+
+bool htf_shrink_to_fit(HtTable *tab) {
+	unsigned slot_count = htf_slots_for(tab->element_count);
+	return slot_count >= tab->bucket_count || htf_resize(tab, slot_count);
+}
+
+bool htf_emplace_s(HtTable *tab, void *key, size_t keylen, void *value) {
+	if (tab->bucket_count == 0 && !htf_resize(tab, htf_slots_for(1))) {
+		return false;
+	}
+	uint64_t hash = ht_hash(tab, key, keylen);
+
+	long found = ht_bloom_rejects(tab, hash) ? -1 : htf_find(tab, key, keylen, hash);
+	if (found >= 0) {
+		tab->slots[found].value = value; // Key already exists, update the value
+		return true;
+	}
+
+	size_t idx = htf_find_free(tab, hash);
+	if (tab->ctrl[idx] == HT_CTRL_EMPTY &&
+		tab->element_count + tab->tombstone_count + 1 > HTF_MAX_LOAD(tab->bucket_count)) {
+		// Out of empty slots: grow when live entries fill over half of the
+		// usable slots, otherwise rebuild in place to drop the tombstones
+		unsigned slot_count = tab->bucket_count;
+		if (tab->element_count + 1 > HTF_MAX_LOAD(slot_count) / 2) {
+			slot_count *= 2;
+		}
+		if (!htf_resize(tab, slot_count)) {
+			return false;
+		}
+		idx = htf_find_free(tab, hash);
+	}
+
+	if (!ht_key_store(tab, &tab->slots[idx].key, key, keylen)) {
+		return false;
+	}
+
+	if (tab->ctrl[idx] == HT_CTRL_DELETED) {
+		--(tab->tombstone_count);
+	}
+	tab->ctrl[idx] = htf_tag(hash);
+	tab->slots[idx].value = value;
+	tab->slots[idx].keylen = keylen;
+	tab->slots[idx].hash = hash;
+
+	++(tab->element_count);
+	ht_bloom_inserted(tab, hash);
+	return true;
+}
+
+// Returns the slot index holding the key, or -1 if the key is absent; keys the
+// filter rules out are not looked for
+static long htf_lookup(HtTable *tab, const void *key, size_t keylen) {
+	if (tab->bucket_count == 0) {
+		return -1;
+	}
+	uint64_t hash = ht_hash(tab, key, keylen);
+	return ht_bloom_rejects(tab, hash) ? -1 : htf_find(tab, key, keylen, hash);
+}
+
+bool htf_delete_s(HtTable *tab, void *key, size_t keylen) {
+	long found = htf_lookup(tab, key, keylen);
+	if (found < 0) {
+		return false;
+	}
+
+	size_t idx = (size_t) found;
+	ht_key_release(tab, &tab->slots[idx].key, keylen);
+
+	// Lookups stop at the first group that has an empty slot, so if this
+	// group already has one, no probe sequence continues past it and the slot
+	// can be emptied outright instead of leaving a tombstone.
+	const signed char *group = tab->ctrl + idx / HT_GROUP_WIDTH * HT_GROUP_WIDTH;
+	if (ht_group_match(group, HT_CTRL_EMPTY)) {
+		tab->ctrl[idx] = HT_CTRL_EMPTY;
+	} else {
+		tab->ctrl[idx] = HT_CTRL_DELETED;
+		++(tab->tombstone_count);
+	}
+
+	--(tab->element_count);
+	ht_bloom_deleted(tab);
+	return true;
+}
+
+void *htf_search_s(HtTable *tab, void *key, size_t keylen) {
+	long found = htf_lookup(tab, key, keylen);
+	HT_STATS_COUNT(tab->counters, found >= 0);
+	return found >= 0 ? tab->slots[found].value : NULL;
+}
+
+bool htf_has_s(HtTable *tab, void *key, size_t keylen) {
+	bool found = htf_lookup(tab, key, keylen) >= 0;
+	HT_STATS_COUNT(tab->counters, found);
+	return found;
+}
+
+void htf_search_batch_s(HtTable *tab, void *const *keys, const size_t *keylens, size_t n, void **out_values) {
+	uint64_t hashes[HT_BATCH_SIZE];
+	bool	 absent[HT_BATCH_SIZE];
+	for (size_t base = 0; base < n; base += HT_BATCH_SIZE) {
+		size_t count = n - base < HT_BATCH_SIZE ? n - base : HT_BATCH_SIZE;
+
+		// Hash every key of the batch and start loading its home group, unless
+		// the filter already rules the key out
+		for (size_t i = 0; i < count; ++i) {
+			hashes[i] = ht_hash(tab, keys[base + i], keylens[base + i]);
+			absent[i] = tab->bucket_count == 0 || ht_bloom_rejects(tab, hashes[i]);
+			if (!absent[i]) {
+				PREFETCH(tab->ctrl + (size_t) htf_home_group(tab, hashes[i]) * HT_GROUP_WIDTH);
+			}
+		}
+		// Start loading the first slot whose tag matches
+		for (size_t i = 0; i < count; ++i) {
+			if (absent[i]) {
+				continue;
+			}
+			size_t	 first = (size_t) htf_home_group(tab, hashes[i]) * HT_GROUP_WIDTH;
+			unsigned match = ht_group_match(tab->ctrl + first, htf_tag(hashes[i]));
+			if (match) {
+				PREFETCH(&tab->slots[first + ht_ctz(match)]);
+			}
+		}
+		for (size_t i = 0; i < count; ++i) {
+			long found = absent[i] ? -1 : htf_find(tab, keys[base + i], keylens[base + i], hashes[i]);
+			HT_STATS_COUNT(tab->counters, found >= 0);
+			out_values[base + i] = found >= 0 ? tab->slots[found].value : NULL;
+		}
+	}
+}
+
+size_t htf_memory_usage(const HtTable *tab) {
+	size_t bytes = (sizeof(HtSlot) + 1) * (size_t) tab->bucket_count;
+	for (unsigned i = 0; i < tab->bucket_count; ++i) {
+		if (tab->ctrl[i] >= 0) {
+			bytes += ht_key_heap_bytes(tab->slots[i].keylen);
+		}
+	}
+	return bytes;
+}
+
+void htf_stats(const HtTable *tab, HtStats *stats) {
+	unsigned group_mask = tab->bucket_count / HT_GROUP_WIDTH - 1;
+	size_t	 visits = 0;
+	for (unsigned i = 0; i < tab->bucket_count; ++i) {
+		if (tab->ctrl[i] < 0) {
+			continue;
+		}
+		// Replay the probe sequence from the home group to the entry's group
+		unsigned group = htf_home_group(tab, tab->slots[i].hash);
+		size_t	 length = 1;
+		while (group != i / HT_GROUP_WIDTH) {
+			group = (group + (unsigned) length) & group_mask;
+			++length;
+		}
+		visits += length;
+		++stats->histogram[length < HT_STATS_HISTOGRAM ? length : HT_STATS_HISTOGRAM - 1];
+		stats->max_chain = length > stats->max_chain ? length : stats->max_chain;
+	}
+	stats->buckets = tab->bucket_count;
+	stats->avg_probe = tab->element_count ? (double) visits / tab->element_count : 0;
+}
@@ -0,0 +1,398 @@
+#include "hashtable/ht_frozen.h"
+#include "hashtable/hash64.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HT_FROZEN_MMAP 1
+#endif
+
+// Average number of keys per displacement bucket
+#define HT_FROZEN_KEYS_PER_BUCKET 4
+
+// Displacement pairs tried for one bucket before giving up on a seed
+#define HT_FROZEN_MAX_TRIALS (1u << 22)
+
+// Seeds tried before ht_freeze fails
+#define HT_FROZEN_MAX_SEEDS 16
+
+// Key hashes derived from one 64-bit hash: the bucket picks a displacement
+// pair, f1 and f2 combine with it into the slot, and the fingerprint rejects
+// most absent keys before their bytes are compared.
+typedef struct HtFrozenHash {
+	uint64_t bucket;
+	uint64_t f1;
+	uint64_t f2;
+	uint32_t fingerprint;
+} HtFrozenHash;
+
+static HtFrozenHash ht_frozen_hash(const void *key, size_t keylen, uint64_t seed, uint64_t count, uint64_t buckets) {
+	uint64_t	 h = hash64_wy(key, keylen, seed);
+	uint64_t	 g = hash64_mix(h ^ HASH64_S2, HASH64_S3);
+	HtFrozenHash fh = {h % buckets, (uint32_t) g % count, (g >> 32) % count, (uint32_t) (h >> 32)};
+	return fh;
+}
+
+static uint64_t ht_frozen_slot(const HtFrozenHash *fh, const uint32_t *disp, uint64_t count) {
+	const uint32_t *d = disp + 2 * fh->bucket;
+	return (fh->f1 + (uint64_t) d[0] * fh->f2 + d[1]) % count;
+}
+
+static size_t ht_frozen_align8(size_t size) {
+	return (size + 7) & ~(size_t) 7;
+}
+
+// Entry gathered from the source table
+typedef struct HtFrozenEntry {
+	const char	*key;
+	size_t		 keylen;
+	void		*value;
+	HtFrozenHash hash;
+} HtFrozenEntry;
+
+static void ht_frozen_gather_chains(HtNode **buckets, unsigned bucket_count, HtFrozenEntry *entries, size_t *n) {
+	for (unsigned i = 0; buckets && i < bucket_count; ++i) {
+		for (HtNode *node = buckets[i]; node != NULL; node = node->pnext) {
+			entries[*n].key = ht_key_ptr(&node->key, node->keylen);
+			entries[*n].keylen = node->keylen;
+			entries[*n].value = node->value;
+			++(*n);
+		}
+	}
+}
+
+// Collects every entry of the table, in either mode
+static size_t ht_frozen_gather(HtTable *tab, HtFrozenEntry *entries) {
+	size_t n = 0;
+	if (tab->mode == HT_MODE_FLAT) {
+		for (unsigned i = 0; i < tab->bucket_count; ++i) {
+			if (tab->ctrl[i] >= 0) {
+				HtSlot *slot = &tab->slots[i];
+				entries[n].key = ht_key_ptr(&slot->key, slot->keylen);
+				entries[n].keylen = slot->keylen;
+				entries[n].value = slot->value;
+				++n;
+			}
+		}
+	} else {
+		ht_frozen_gather_chains(tab->buckets, tab->bucket_count, entries, &n);
+		ht_frozen_gather_chains(tab->rehash_buckets, tab->rehash_bucket_count, entries, &n);
+	}
+	return n;
+}
+
+// Finds a displacement pair for every bucket so that the n keys land on n
+// distinct slots. Buckets are placed largest first, while most slots are
+// still free; single-key buckets are then pointed straight at the remaining
+// free slots. Returns false if this seed does not work.
+static bool ht_frozen_place(HtFrozenEntry *entries, uint64_t n, uint64_t bucket_count, uint32_t *disp) {
+	bool	 ok = false;
+	size_t	*start = calloc(bucket_count + 1, sizeof(size_t)); // Bucket b owns order[start[b]..start[b+1])
+	size_t	*order = malloc(sizeof(size_t) * n);
+	size_t	*by_size = malloc(sizeof(size_t) * bucket_count);
+	uint8_t *taken = calloc(n, 1);
+	uint64_t positions[64];
+	if (!start || !order || !by_size || !taken) {
+		goto done;
+	}
+
+	// Counting sort of the entries by bucket
+	for (uint64_t i = 0; i < n; ++i) {
+		++start[entries[i].hash.bucket + 1];
+	}
+	size_t max_size = 0;
+	for (uint64_t b = 0; b < bucket_count; ++b) {
+		max_size = start[b + 1] > max_size ? start[b + 1] : max_size;
+		start[b + 1] += start[b];
+	}
+	if (max_size > sizeof(positions) / sizeof(positions[0])) {
+		goto done; // Pathologically unbalanced seed
+	}
+	size_t *fill = by_size; // Borrowed as per-bucket insertion cursors first
+	memcpy(fill, start, sizeof(size_t) * bucket_count);
+	for (uint64_t i = 0; i < n; ++i) {
+		order[fill[entries[i].hash.bucket]++] = i;
+	}
+
+	// Buckets by decreasing size, again with a counting sort
+	size_t *size_start = calloc(max_size + 2, sizeof(size_t));
+	if (!size_start) {
+		goto done;
+	}
+	for (uint64_t b = 0; b < bucket_count; ++b) {
+		++size_start[max_size - (start[b + 1] - start[b]) + 1];
+	}
+	for (size_t s = 0; s <= max_size; ++s) {
+		size_start[s + 1] += size_start[s];
+	}
+	for (uint64_t b = 0; b < bucket_count; ++b) {
+		by_size[size_start[max_size - (start[b + 1] - start[b])]++] = b;
+	}
+	free(size_start);
+
+	uint64_t next_free = 0;
+	for (uint64_t k = 0; k < bucket_count; ++k) {
+		uint64_t b = by_size[k];
+		size_t	 size = start[b + 1] - start[b];
+		uint32_t *d = disp + 2 * b;
+		d[0] = d[1] = 0;
+		if (size == 0) {
+			continue;
+		}
+
+		if (size == 1) {
+			const HtFrozenHash *fh = &entries[order[start[b]]].hash;
+			while (taken[next_free]) {
+				++next_free;
+			}
+			d[1] = (uint32_t) ((next_free + n - fh->f1) % n);
+			taken[next_free] = 1;
+			continue;
+		}
+
+		bool placed = false;
+		for (uint64_t trial = 0; trial < HT_FROZEN_MAX_TRIALS && !placed; ++trial) {
+			d[0] = (uint32_t) (trial / n);
+			d[1] = (uint32_t) (trial % n);
+			placed = true;
+			for (size_t i = 0; i < size && placed; ++i) {
+				uint64_t pos = ht_frozen_slot(&entries[order[start[b] + i]].hash, disp, n);
+				placed = !taken[pos];
+				for (size_t j = 0; j < i && placed; ++j) {
+					placed = positions[j] != pos;
+				}
+				positions[i] = pos;
+			}
+		}
+		if (!placed) {
+			goto done;
+		}
+		for (size_t i = 0; i < size; ++i) {
+			taken[positions[i]] = 1;
+		}
+	}
+	ok = true;
+
+done:
+	free(start);
+	free(order);
+	free(by_size);
+	free(taken);
+	return ok;
+}
+
+bool ht_freeze(HtTable *tab, size_t value_size, HtFreezeValueFn encode, void *ctx, void **out_image,
+			   size_t *out_size) {
+	uint64_t	   n = tab->element_count;
+	uint64_t	   bucket_count = n / HT_FROZEN_KEYS_PER_BUCKET + 1;
+	HtFrozenEntry *entries = malloc(sizeof(HtFrozenEntry) * (n ? n : 1));
+	uint32_t	  *disp = malloc(sizeof(uint32_t) * 2 * bucket_count);
+	bool		   ok = false;
+	if (!entries || !disp) {
+		goto done;
+	}
+	ht_frozen_gather(tab, entries);
+
+	uint64_t seed = 0;
+	for (; seed < HT_FROZEN_MAX_SEEDS; ++seed) {
+		for (uint64_t i = 0; i < n; ++i) {
+			entries[i].hash = ht_frozen_hash(entries[i].key, entries[i].keylen, seed, n, bucket_count);
+		}
+		if (n == 0 || ht_frozen_place(entries, n, bucket_count, disp)) {
+			break;
+		}
+	}
+	if (seed == HT_FROZEN_MAX_SEEDS) {
+		goto done;
+	}
+	if (n == 0) {
+		disp[0] = disp[1] = 0;
+	}
+
+	// Lay out the image
+	size_t keys_size = 0;
+	for (uint64_t i = 0; i < n; ++i) {
+		keys_size += entries[i].keylen + 1;
+	}
+	HtFrozenHeader header = {HT_FROZEN_MAGIC, (uint32_t) value_size, 0, n, bucket_count, seed, 0, 0, 0, 0, 0};
+	header.disp_offset = ht_frozen_align8(sizeof(HtFrozenHeader));
+	header.slots_offset = ht_frozen_align8(header.disp_offset + sizeof(uint32_t) * 2 * bucket_count);
+	header.values_offset = ht_frozen_align8(header.slots_offset + sizeof(HtFrozenSlot) * n);
+	header.keys_offset = ht_frozen_align8(header.values_offset + value_size * n);
+	header.size = ht_frozen_align8(header.keys_offset + keys_size);
+
+	unsigned char *image = htmalloc(header.size);
+	if (!image) {
+		goto done;
+	}
+	memset(image, 0, header.size);
+	memcpy(image, &header, sizeof(header));
+	memcpy(image + header.disp_offset, disp, sizeof(uint32_t) * 2 * bucket_count);
+
+	HtFrozenSlot *slots = (HtFrozenSlot *) (image + header.slots_offset);
+	size_t		  key_offset = 0;
+	for (uint64_t i = 0; i < n; ++i) {
+		HtFrozenEntry *e = &entries[i];
+		uint64_t	   pos = ht_frozen_slot(&e->hash, disp, n);
+		slots[pos].fingerprint = e->hash.fingerprint;
+		slots[pos].keylen = (uint32_t) e->keylen;
+		slots[pos].key_offset = key_offset;
+		memcpy(image + header.keys_offset + key_offset, e->key, e->keylen);
+		key_offset += e->keylen + 1; // The null terminator is already zeroed
+
+		void *value_out = image + header.values_offset + value_size * pos;
+		if (encode) {
+			encode(ctx, e->key, e->keylen, e->value, value_out);
+		} else if (value_size) {
+			memcpy(value_out, e->value, value_size);
+		}
+	}
+
+	*out_image = image;
+	*out_size = header.size;
+	ok = true;
+
+done:
+	free(entries);
+	free(disp);
+	return ok;
+}
+
+bool ht_freeze_to_file(HtTable *tab, size_t value_size, HtFreezeValueFn encode, void *ctx, const char *path) {
+	void  *image;
+	size_t size;
+	if (!ht_freeze(tab, value_size, encode, ctx, &image, &size)) {
+		return false;
+	}
+
+	FILE *file = fopen(path, "wb");
+	bool  ok = file && fwrite(image, 1, size, file) == size;
+	if (file && fclose(file) != 0) {
+		ok = false;
+	}
+	htfree(image);
+	return ok;
+}
+
+// Whether `count` elements of `elem_size` bytes starting at `offset` lie inside an image of `size` bytes
+static bool ht_frozen_region_fits(uint64_t offset, uint64_t count, uint64_t elem_size, uint64_t size) {
+	return offset <= size && (elem_size == 0 || count <= (size - offset) / elem_size);
+}
+
+bool ht_frozen_open_memory(HtFrozen *frozen, const void *image, size_t size) {
+	const HtFrozenHeader *header = image;
+	if (size < sizeof(HtFrozenHeader) || ((uintptr_t) image & 7) != 0 ||
+		memcmp(header->magic, HT_FROZEN_MAGIC, sizeof(header->magic)) != 0 || header->size > size ||
+		header->bucket_count == 0) {
+		return false;
+	}
+	// Reject truncated or corrupt images whose regions would reach past the end
+	if (((header->disp_offset | header->slots_offset) & 7) != 0 ||
+		!ht_frozen_region_fits(header->disp_offset, header->bucket_count, sizeof(uint32_t) * 2, header->size) ||
+		!ht_frozen_region_fits(header->slots_offset, header->count, sizeof(HtFrozenSlot), header->size) ||
+		!ht_frozen_region_fits(header->values_offset, header->count, header->value_size, header->size) ||
+		header->keys_offset > header->size) {
+		return false;
+	}
+
+	const unsigned char *base = image;
+	frozen->header = header;
+	frozen->disp = (const uint32_t *) (base + header->disp_offset);
+	frozen->slots = (const HtFrozenSlot *) (base + header->slots_offset);
+	frozen->values = base + header->values_offset;
+	frozen->keys = (const char *) (base + header->keys_offset);
+	frozen->owned = NULL;
+	frozen->owned_size = 0;
+	frozen->mapped = false;
+	return true;
+}
+
+bool ht_frozen_open(HtFrozen *frozen, const char *path) {
+#ifdef HT_FROZEN_MMAP
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	size_t size = (size_t) st.st_size;
+	void  *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // The mapping keeps the file referenced
+	if (map == MAP_FAILED) {
+		return false;
+	}
+	if (!ht_frozen_open_memory(frozen, map, size)) {
+		munmap(map, size);
+		return false;
+	}
+	frozen->owned = map;
+	frozen->owned_size = size;
+	frozen->mapped = true;
+	return true;
+#else
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	void *buffer = size > 0 ? htmalloc((size_t) size) : NULL;
+	bool  ok = buffer && fread(buffer, 1, (size_t) size, file) == (size_t) size &&
+			  ht_frozen_open_memory(frozen, buffer, (size_t) size);
+	fclose(file);
+	if (!ok) {
+		htfree(buffer);
+		return false;
+	}
+	frozen->owned = buffer;
+	frozen->owned_size = (size_t) size;
+	return true;
+#endif
+}
+
+void ht_frozen_close(HtFrozen *frozen) {
+	if (frozen->owned) {
+#ifdef HT_FROZEN_MMAP
+		if (frozen->mapped) {
+			munmap(frozen->owned, frozen->owned_size);
+		} else {
+			htfree(frozen->owned);
+		}
+#else
+		htfree(frozen->owned);
+#endif
+	}
+	frozen->header = NULL;
+	frozen->owned = NULL;
+	frozen->owned_size = 0;
+}
+
+const void *ht_frozen_search_s(const HtFrozen *frozen, const void *key, size_t keylen) {
+	const HtFrozenHeader *header = frozen->header;
+	if (header->count == 0) {
+		return NULL;
+	}
+
+	HtFrozenHash		fh = ht_frozen_hash(key, keylen, header->seed, header->count, header->bucket_count);
+	uint64_t			pos = ht_frozen_slot(&fh, frozen->disp, header->count);
+	const HtFrozenSlot *slot = &frozen->slots[pos];
+	uint64_t			keys_size = header->size - header->keys_offset;
+	// Every key maps to some slot, so the stored key decides whether it is ours
+	if (slot->fingerprint != fh.fingerprint || slot->keylen != keylen || slot->key_offset > keys_size ||
+		keylen > keys_size - slot->key_offset || memcmp(frozen->keys + slot->key_offset, key, keylen) != 0) {
+		return NULL;
+	}
+	return frozen->values + header->value_size * pos;
+}
+
+const void *ht_frozen_search(const HtFrozen *frozen, const char *key) {
+	return ht_frozen_search_s(frozen, key, strlen(key));
+}
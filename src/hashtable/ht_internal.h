@@ -0,0 +1,138 @@
+#ifndef HT_INTERNAL_H
+#define HT_INTERNAL_H
+
+// Declarations shared between the hash table translation units. Not part of
+// the public API.
+
+#include "hashtable/hashtable.h"
+#include "prefetch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Control byte values of flat-mode slots. Full slots hold a 7-bit hash tag
+// (0..127), so the sign bit alone tells free slots from full ones.
+#define HT_CTRL_EMPTY ((signed char) -128)
+#define HT_CTRL_DELETED ((signed char) -2)
+
+// Number of keys a batched lookup hashes and prefetches before resolving any
+// of them: enough to cover memory latency without spilling the batch state
+#ifndef HT_BATCH_SIZE
+#define HT_BATCH_SIZE 16
+#endif
+
+// Hashes a key with the table's hash function and seed
+static inline uint64_t ht_hash(const HtTable *tab, const void *key, size_t keylen) {
+	return tab->hash_fn(key, keylen, tab->hash_seed);
+}
+
+// Sets the default hash function on a newly initialized table
+void ht_set_default_hash(HtTable *tab);
+
+// True if the table's filter proves that no key with this hash is stored
+static inline bool ht_bloom_rejects(const HtTable *tab, uint64_t hash) {
+	return tab->bloom && !ht_bloom_may_contain_hash(tab->bloom, hash);
+}
+
+// Keep an attached filter in step with an insert of a new key or a delete
+void ht_bloom_inserted(HtTable *tab, uint64_t hash);
+void ht_bloom_deleted(HtTable *tab);
+
+// Allocates table storage through the table's allocator
+static inline void *ht_alloc(const HtTable *tab, size_t size) {
+	return tab->allocator.alloc(tab->allocator.ctx, size);
+}
+
+// Frees table storage through the table's allocator; NULL is ignored
+static inline void ht_dealloc(const HtTable *tab, void *p, size_t size) {
+	if (p) {
+		tab->allocator.free(tab->allocator.ctx, p, size);
+	}
+}
+
+// Sets the table's allocator, falling back to htmalloc/htfree when NULL
+void ht_set_allocator(HtTable *tab, const HtAllocator *allocator);
+
+// Copies a key into its storage, allocating only when it does not fit inline
+static inline bool ht_key_store(const HtTable *tab, HtKey *dst, const void *key, size_t keylen) {
+	char *bytes = dst->inline_buf;
+	if (keylen >= HT_INLINE_KEY_SIZE) {
+		bytes = ht_alloc(tab, keylen + 1);
+		if (!bytes) {
+			return false;
+		}
+		dst->heap = bytes;
+	}
+	memcpy(bytes, key, keylen); // Keys may contain any bytes
+	bytes[keylen] = '\0';		// Ensure null-termination
+	return true;
+}
+
+// Frees the heap copy of a key, if it has one
+static inline void ht_key_release(const HtTable *tab, HtKey *key, size_t keylen) {
+	if (keylen >= HT_INLINE_KEY_SIZE) {
+		ht_dealloc(tab, key->heap, keylen + 1);
+	}
+}
+
+// Bytes allocated outside the entry to hold a key
+static inline size_t ht_key_heap_bytes(size_t keylen) {
+	return keylen >= HT_INLINE_KEY_SIZE ? keylen + 1 : 0;
+}
+
+// Flat (open-addressing) backend, implemented in hashtable_flat.c
+void   htf_init_table(HtTable *tab, unsigned capacity, const HtAllocator *allocator);
+void   htf_deinit_table(HtTable *tab);
+bool   htf_reserve(HtTable *tab, unsigned count);
+bool   htf_shrink_to_fit(HtTable *tab);
+bool   htf_emplace_s(HtTable *tab, void *key, size_t keylen, void *value);
+bool   htf_delete_s(HtTable *tab, void *key, size_t keylen);
+void  *htf_search_s(HtTable *tab, void *key, size_t keylen);
+bool   htf_has_s(HtTable *tab, void *key, size_t keylen);
+void   htf_search_batch_s(HtTable *tab, void *const *keys, const size_t *keylens, size_t n, void **out_values);
+size_t htf_memory_usage(const HtTable *tab);
+void   htf_stats(const HtTable *tab, HtStats *stats);
+
+// Index of the lowest set bit of a non-zero mask
+static inline unsigned ht_ctz(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned) __builtin_ctz(mask);
+#else
+	unsigned i = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		++i;
+	}
+	return i;
+#endif
+}
+
+// Bit i of the result is set when slot i of the group holds `tag`
+static inline unsigned ht_group_match(const signed char *group, signed char tag) {
+#ifdef __SSE2__
+	__m128i ctrl = _mm_loadu_si128((const __m128i *) group);
+	return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#else
+	unsigned mask = 0;
+	for (unsigned i = 0; i < HT_GROUP_WIDTH; ++i) {
+		mask |= (unsigned) (group[i] == tag) << i;
+	}
+	return mask;
+#endif
+}
+
+// Bit i of the result is set when slot i of the group is empty or deleted
+static inline unsigned ht_group_match_free(const signed char *group) {
+#ifdef __SSE2__
+	return (unsigned) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) group));
+#else
+	unsigned mask = 0;
+	for (unsigned i = 0; i < HT_GROUP_WIDTH; ++i) {
+		mask |= (unsigned) (group[i] < 0) << i;
+	}
+	return mask;
+#endif
+}
+
+#endif // HT_INTERNAL_H
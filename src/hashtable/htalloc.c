@@ -0,0 +1,198 @@
+#include "hashtable/htalloc.h"
+#include "hashtable/hashtable.h"
+
+// Header in front of every slab chunk, arena block and large pool block,
+// padded so the memory after it is aligned for any type
+typedef union HtBlockHeader {
+	struct {
+		void *next;
+		void *prev; // Only used by large pool blocks
+	} link;
+	max_align_t align;
+} HtBlockHeader;
+
+#define HT_ALIGN sizeof(max_align_t)
+
+static size_t ht_align_up(size_t size, size_t align) {
+	return (size + align - 1) / align * align;
+}
+
+void ht_slab_init(HtSlab *slab, size_t object_size, size_t objects_per_chunk) {
+	// Objects must be able to hold the free-list link and keep its alignment
+	if (object_size < sizeof(void *)) {
+		object_size = sizeof(void *);
+	}
+	slab->object_size = ht_align_up(object_size, sizeof(void *));
+	slab->objects_per_chunk = objects_per_chunk ? objects_per_chunk : 1;
+	slab->free_list = NULL;
+	slab->chunks = NULL;
+	slab->bump = NULL;
+	slab->bump_end = NULL;
+}
+
+void *ht_slab_alloc(HtSlab *slab) {
+	// Reuse a freed object first
+	if (slab->free_list) {
+		void *p = slab->free_list;
+		slab->free_list = *(void **) p;
+		return p;
+	}
+
+	// Carve objects lazily out of the newest chunk, grabbing a new one when full
+	if (slab->bump == slab->bump_end) {
+		size_t		   bytes = slab->object_size * slab->objects_per_chunk;
+		HtBlockHeader *chunk = htmalloc(sizeof(HtBlockHeader) + bytes);
+		if (!chunk) {
+			return NULL;
+		}
+		chunk->link.next = slab->chunks;
+		slab->chunks = chunk;
+		slab->bump = (char *) (chunk + 1);
+		slab->bump_end = slab->bump + bytes;
+	}
+
+	void *p = slab->bump;
+	slab->bump += slab->object_size;
+	return p;
+}
+
+void ht_slab_free(HtSlab *slab, void *p) {
+	*(void **) p = slab->free_list;
+	slab->free_list = p;
+}
+
+void ht_slab_release(HtSlab *slab) {
+	HtBlockHeader *chunk = slab->chunks;
+	while (chunk != NULL) {
+		HtBlockHeader *next = chunk->link.next;
+		htfree(chunk);
+		chunk = next;
+	}
+	slab->free_list = NULL;
+	slab->chunks = NULL;
+	slab->bump = NULL;
+	slab->bump_end = NULL;
+}
+
+void ht_arena_init(HtArena *arena, size_t block_size) {
+	arena->blocks = NULL;
+	arena->bump = NULL;
+	arena->bump_end = NULL;
+	arena->block_size = block_size ? ht_align_up(block_size, HT_ALIGN) : HT_ALIGN;
+}
+
+void *ht_arena_alloc(HtArena *arena, size_t size) {
+	size = ht_align_up(size ? size : 1, HT_ALIGN);
+	if ((size_t) (arena->bump_end - arena->bump) >= size) {
+		void *p = arena->bump;
+		arena->bump += size;
+		return p;
+	}
+
+	// Requests too large for a regular block get a block of their own, linked
+	// behind the newest block so the remaining space there is not abandoned
+	bool		   oversized = size > arena->block_size / 4;
+	size_t		   bytes = oversized ? size : arena->block_size;
+	HtBlockHeader *block = htmalloc(sizeof(HtBlockHeader) + bytes);
+	if (!block) {
+		return NULL;
+	}
+
+	if (oversized && arena->blocks) {
+		HtBlockHeader *newest = arena->blocks;
+		block->link.next = newest->link.next;
+		newest->link.next = block;
+		return block + 1;
+	}
+
+	block->link.next = arena->blocks;
+	arena->blocks = block;
+	arena->bump = (char *) (block + 1) + size;
+	arena->bump_end = (char *) (block + 1) + bytes;
+	return block + 1;
+}
+
+void ht_arena_release(HtArena *arena) {
+	HtBlockHeader *block = arena->blocks;
+	while (block != NULL) {
+		HtBlockHeader *next = block->link.next;
+		htfree(block);
+		block = next;
+	}
+	arena->blocks = NULL;
+	arena->bump = NULL;
+	arena->bump_end = NULL;
+}
+
+static void *ht_pool_alloc(void *ctx, size_t size) {
+	HtPool *pool = ctx;
+	if (size == sizeof(HtNode)) {
+		return ht_slab_alloc(&pool->nodes);
+	}
+	if (size <= HT_POOL_SMALL_MAX) {
+		return ht_arena_alloc(&pool->small, size);
+	}
+
+	HtBlockHeader *block = htmalloc(sizeof(HtBlockHeader) + size);
+	if (!block) {
+		return NULL;
+	}
+	block->link.prev = NULL;
+	block->link.next = pool->large;
+	if (pool->large) {
+		((HtBlockHeader *) pool->large)->link.prev = block;
+	}
+	pool->large = block;
+	return block + 1;
+}
+
+static void ht_pool_free(void *ctx, void *p, size_t size) {
+	HtPool *pool = ctx;
+	if (size == sizeof(HtNode)) {
+		ht_slab_free(&pool->nodes, p);
+		return;
+	}
+	if (size <= HT_POOL_SMALL_MAX) {
+		return; // Reclaimed when the arena is released
+	}
+
+	HtBlockHeader *block = (HtBlockHeader *) p - 1;
+	if (block->link.prev) {
+		((HtBlockHeader *) block->link.prev)->link.next = block->link.next;
+	} else {
+		pool->large = block->link.next;
+	}
+	if (block->link.next) {
+		((HtBlockHeader *) block->link.next)->link.prev = block->link.prev;
+	}
+	htfree(block);
+}
+
+static void ht_pool_release(void *ctx) {
+	HtPool *pool = ctx;
+	ht_slab_release(&pool->nodes);
+	ht_arena_release(&pool->small);
+
+	HtBlockHeader *block = pool->large;
+	while (block != NULL) {
+		HtBlockHeader *next = block->link.next;
+		htfree(block);
+		block = next;
+	}
+	pool->large = NULL;
+}
+
+void ht_pool_init(HtPool *pool) {
+	ht_slab_init(&pool->nodes, sizeof(HtNode), 256);
+	ht_arena_init(&pool->small, 16 * 1024);
+	pool->large = NULL;
+}
+
+void ht_pool_deinit(HtPool *pool) {
+	ht_pool_release(pool);
+}
+
+HtAllocator ht_pool_allocator(HtPool *pool) {
+	HtAllocator allocator = {ht_pool_alloc, ht_pool_free, ht_pool_release, pool};
+	return allocator;
+}
@@ -0,0 +1,328 @@
+#include "hashtable/htconcurrent.h"
+#include "hashtable/hash64.h"
+#include "hashtable/hashtable.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Shards grow once they hold more entries than buckets
+#define HTC_MAX_LOAD_FACTOR 1
+
+static unsigned htc_pow2(unsigned n) {
+	unsigned p = 1;
+	while (p < n) {
+		p *= 2;
+	}
+	return p;
+}
+
+static uint64_t htc_hash(const HtConcurrentTable *tab, const void *key, size_t keylen) {
+	return hash64_wy(key, keylen, tab->seed);
+}
+
+// Shards are picked by the top bits, buckets by the low bits, so the two
+// choices are independent
+static HtcShard *htc_shard(HtConcurrentTable *tab, uint64_t hash) {
+	return tab->shard_bits ? &tab->shards[hash >> (64 - tab->shard_bits)] : &tab->shards[0];
+}
+
+static HtcBuckets *htc_buckets_new(unsigned count) {
+	HtcBuckets *buckets = htmalloc(sizeof(HtcBuckets) + sizeof(HtcNode *) * count);
+	if (!buckets) {
+		return NULL;
+	}
+	buckets->count = count;
+	for (unsigned i = 0; i < count; ++i) {
+		atomic_init(&buckets->heads[i], NULL);
+	}
+	return buckets;
+}
+
+static HtcNode *htc_node_new(const void *key, size_t keylen, uint64_t hash, void *value) {
+	HtcNode *node = htmalloc(sizeof(HtcNode) + keylen + 1);
+	if (!node) {
+		return NULL;
+	}
+	atomic_init(&node->next, NULL);
+	atomic_init(&node->value, value);
+	node->hash = hash;
+	node->keylen = keylen;
+	memcpy(node->key, key, keylen);
+	node->key[keylen] = '\0';
+	return node;
+}
+
+// Frees a bucket array together with every node still linked from it
+static void htc_buckets_free(HtcBuckets *buckets) {
+	for (unsigned i = 0; i < buckets->count; ++i) {
+		HtcNode *node = atomic_load_explicit(&buckets->heads[i], memory_order_relaxed);
+		while (node != NULL) {
+			HtcNode *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+			htfree(node);
+			node = next;
+		}
+	}
+	htfree(buckets);
+}
+
+static void htc_retired_free(HtcRetired *r) {
+	if (r->buckets) {
+		htc_buckets_free(r->p);
+	} else {
+		htfree(r->p);
+	}
+	htfree(r);
+}
+
+// Reader side of the epoch scheme. The slot is claimed with a sequentially
+// consistent CAS, so either a writer scanning the slots sees this reader, or
+// every load the reader makes afterwards sees what that writer unlinked.
+static HtcReaderSlot *htc_enter(HtConcurrentTable *tab) {
+	static _Thread_local unsigned hint;
+	uint64_t					  epoch = atomic_load(&tab->epoch);
+	for (unsigned i = hint;; i = (i + 1) % HTC_READER_SLOTS) {
+		uint_least64_t expected = 0;
+		if (atomic_compare_exchange_weak(&tab->readers[i].epoch, &expected, epoch)) {
+			atomic_thread_fence(memory_order_seq_cst);
+			hint = i; // Usually free again next time, so this thread keeps one slot warm
+			return &tab->readers[i];
+		}
+	}
+}
+
+static void htc_leave(HtcReaderSlot *slot) {
+	atomic_store_explicit(&slot->epoch, 0, memory_order_release);
+}
+
+// Oldest epoch a reader inside the table entered in, or UINT64_MAX if none
+static uint64_t htc_oldest_reader(HtConcurrentTable *tab) {
+	uint64_t oldest = UINT64_MAX;
+	for (unsigned i = 0; i < HTC_READER_SLOTS; ++i) {
+		uint64_t epoch = atomic_load(&tab->readers[i].epoch);
+		if (epoch != 0 && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+	return oldest;
+}
+
+// Frees the shard's retired blocks that no reader can reach. Called with the
+// shard locked.
+static void htc_reclaim(HtConcurrentTable *tab, HtcShard *shard) {
+	if (!shard->retired) {
+		return;
+	}
+	uint64_t	 oldest = htc_oldest_reader(tab);
+	HtcRetired **link = &shard->retired;
+	while (*link != NULL) {
+		HtcRetired *r = *link;
+		// Readers that entered in r->epoch or later started after p was unlinked
+		if (r->epoch <= oldest) {
+			*link = r->next;
+			htc_retired_free(r);
+		} else {
+			link = &r->next;
+		}
+	}
+}
+
+// Queues unlinked memory for freeing. Called with the shard locked, after p
+// was unlinked.
+static void htc_retire(HtConcurrentTable *tab, HtcShard *shard, void *p, bool buckets) {
+	HtcRetired *r = htmalloc(sizeof(HtcRetired));
+	if (!r) {
+		// Leaking is the only safe option while readers may hold p
+		return;
+	}
+	r->p = p;
+	r->buckets = buckets;
+	r->epoch = atomic_fetch_add(&tab->epoch, 1) + 1;
+	atomic_thread_fence(memory_order_seq_cst); // Pairs with the fence in htc_enter
+	r->next = shard->retired;
+	shard->retired = r;
+	htc_reclaim(tab, shard);
+}
+
+// Replaces a shard's bucket array by one twice the size. Readers may be
+// walking the old chains, so nodes are copied rather than relinked: a relinked
+// node would lead a reader into the wrong chain. The old array and its nodes
+// are retired together. Called with the shard locked.
+static void htc_grow(HtConcurrentTable *tab, HtcShard *shard) {
+	HtcBuckets *old = atomic_load_explicit(&shard->buckets, memory_order_relaxed);
+	HtcBuckets *grown = htc_buckets_new(old->count * 2);
+	if (!grown) {
+		return; // The shard just stays at its current size
+	}
+
+	for (unsigned i = 0; i < old->count; ++i) {
+		HtcNode *node = atomic_load_explicit(&old->heads[i], memory_order_relaxed);
+		for (; node != NULL; node = atomic_load_explicit(&node->next, memory_order_relaxed)) {
+			void	*value = atomic_load_explicit(&node->value, memory_order_relaxed);
+			HtcNode *copy = htc_node_new(node->key, node->keylen, node->hash, value);
+			if (!copy) {
+				htc_buckets_free(grown);
+				return;
+			}
+			HtcNode *_Atomic *head = &grown->heads[node->hash & (grown->count - 1)];
+			atomic_init(&copy->next, atomic_load_explicit(head, memory_order_relaxed));
+			atomic_init(head, copy);
+		}
+	}
+
+	atomic_store_explicit(&shard->buckets, grown, memory_order_release);
+	htc_retire(tab, shard, old, true);
+}
+
+bool htc_init_table(HtConcurrentTable *tab, unsigned shard_count, unsigned bucket_count) {
+	tab->shard_count = htc_pow2(shard_count ? shard_count : 1);
+	tab->shard_bits = 0;
+	while ((1u << tab->shard_bits) < tab->shard_count) {
+		++(tab->shard_bits);
+	}
+	tab->seed = 0;
+	atomic_init(&tab->epoch, 1);
+	for (unsigned i = 0; i < HTC_READER_SLOTS; ++i) {
+		atomic_init(&tab->readers[i].epoch, 0);
+	}
+
+	tab->shards = aligned_alloc(HTC_CACHE_LINE, sizeof(HtcShard) * tab->shard_count);
+	if (!tab->shards) {
+		return false;
+	}
+	bucket_count = htc_pow2(bucket_count ? bucket_count : 1);
+	for (unsigned i = 0; i < tab->shard_count; ++i) {
+		HtcShard   *shard = &tab->shards[i];
+		HtcBuckets *buckets = htc_buckets_new(bucket_count);
+		if (!buckets) {
+			tab->shard_count = i;
+			htc_deinit_table(tab);
+			return false;
+		}
+		pthread_mutex_init(&shard->lock, NULL);
+		atomic_init(&shard->buckets, buckets);
+		atomic_init(&shard->element_count, 0);
+		shard->retired = NULL;
+	}
+	return true;
+}
+
+void htc_deinit_table(HtConcurrentTable *tab) {
+	for (unsigned i = 0; i < tab->shard_count; ++i) {
+		HtcShard *shard = &tab->shards[i];
+		while (shard->retired != NULL) {
+			HtcRetired *next = shard->retired->next;
+			htc_retired_free(shard->retired);
+			shard->retired = next;
+		}
+		htc_buckets_free(atomic_load(&shard->buckets));
+		pthread_mutex_destroy(&shard->lock);
+	}
+	free(tab->shards);
+	tab->shards = NULL;
+	tab->shard_count = 0;
+}
+
+// Returns the link pointing at the node holding the key, or NULL. Only for
+// writers: the link stays valid because the shard is locked.
+static HtcNode *_Atomic *htc_find_link(HtcBuckets *buckets, const void *key, size_t keylen, uint64_t hash) {
+	HtcNode *_Atomic *link = &buckets->heads[hash & (buckets->count - 1)];
+	for (HtcNode *node; (node = atomic_load_explicit(link, memory_order_acquire)) != NULL; link = &node->next) {
+		if (node->hash == hash && node->keylen == keylen && memcmp(node->key, key, keylen) == 0) {
+			return link;
+		}
+	}
+	return NULL;
+}
+
+bool htc_emplace_s(HtConcurrentTable *tab, const void *key, size_t keylen, void *value) {
+	uint64_t  hash = htc_hash(tab, key, keylen);
+	HtcShard *shard = htc_shard(tab, hash);
+	bool	  ok = true;
+
+	pthread_mutex_lock(&shard->lock);
+	HtcBuckets		 *buckets = atomic_load_explicit(&shard->buckets, memory_order_relaxed);
+	HtcNode *_Atomic *link = htc_find_link(buckets, key, keylen, hash);
+	if (link != NULL) {
+		// Key already exists, publish the new value
+		atomic_store_explicit(&atomic_load_explicit(link, memory_order_relaxed)->value, value, memory_order_release);
+	} else {
+		HtcNode *node = htc_node_new(key, keylen, hash, value);
+		if (node) {
+			HtcNode *_Atomic *head = &buckets->heads[hash & (buckets->count - 1)];
+			atomic_init(&node->next, atomic_load_explicit(head, memory_order_relaxed));
+			atomic_store_explicit(head, node, memory_order_release); // Fully built before readers can see it
+
+			size_t count = atomic_fetch_add_explicit(&shard->element_count, 1, memory_order_relaxed) + 1;
+			if (count > (size_t) buckets->count * HTC_MAX_LOAD_FACTOR) {
+				htc_grow(tab, shard);
+			}
+		} else {
+			ok = false;
+		}
+	}
+	pthread_mutex_unlock(&shard->lock);
+	return ok;
+}
+
+bool htc_emplace(HtConcurrentTable *tab, const char *key, void *value) {
+	return htc_emplace_s(tab, key, strlen(key), value);
+}
+
+bool htc_delete_s(HtConcurrentTable *tab, const void *key, size_t keylen) {
+	uint64_t  hash = htc_hash(tab, key, keylen);
+	HtcShard *shard = htc_shard(tab, hash);
+
+	pthread_mutex_lock(&shard->lock);
+	HtcBuckets		 *buckets = atomic_load_explicit(&shard->buckets, memory_order_relaxed);
+	HtcNode *_Atomic *link = htc_find_link(buckets, key, keylen, hash);
+	if (link != NULL) {
+		// Readers standing on the node can still follow its next pointer
+		HtcNode *node = atomic_load_explicit(link, memory_order_relaxed);
+		atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed), memory_order_release);
+		atomic_fetch_sub_explicit(&shard->element_count, 1, memory_order_relaxed);
+		htc_retire(tab, shard, node, false);
+	}
+	pthread_mutex_unlock(&shard->lock);
+	return link != NULL;
+}
+
+bool htc_delete(HtConcurrentTable *tab, const char *key) {
+	return htc_delete_s(tab, key, strlen(key));
+}
+
+void *htc_search_s(HtConcurrentTable *tab, const void *key, size_t keylen) {
+	uint64_t  hash = htc_hash(tab, key, keylen);
+	HtcShard *shard = htc_shard(tab, hash);
+	void	 *value = NULL;
+
+	HtcReaderSlot *slot = htc_enter(tab);
+	HtcBuckets	  *buckets = atomic_load_explicit(&shard->buckets, memory_order_acquire);
+	HtcNode		  *node = atomic_load_explicit(&buckets->heads[hash & (buckets->count - 1)], memory_order_acquire);
+	for (; node != NULL; node = atomic_load_explicit(&node->next, memory_order_acquire)) {
+		if (node->hash == hash && node->keylen == keylen && memcmp(node->key, key, keylen) == 0) {
+			value = atomic_load_explicit(&node->value, memory_order_acquire);
+			break;
+		}
+	}
+	htc_leave(slot);
+	return value;
+}
+
+void *htc_search(HtConcurrentTable *tab, const char *key) {
+	return htc_search_s(tab, key, strlen(key));
+}
+
+size_t htc_count(HtConcurrentTable *tab) {
+	size_t count = 0;
+	for (unsigned i = 0; i < tab->shard_count; ++i) {
+		count += atomic_load_explicit(&tab->shards[i].element_count, memory_order_relaxed);
+	}
+	return count;
+}
+
+void htc_collect(HtConcurrentTable *tab) {
+	for (unsigned i = 0; i < tab->shard_count; ++i) {
+		pthread_mutex_lock(&tab->shards[i].lock);
+		htc_reclaim(tab, &tab->shards[i]);
+		pthread_mutex_unlock(&tab->shards[i].lock);
+	}
+}
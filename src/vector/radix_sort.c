@@ -0,0 +1,219 @@
+#include "vector/radix_sort.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Most threads a parallel sort starts
+#define RADIX_MAX_THREADS 64
+
+/* ------------------------------------------------------------------ */
+/* Sort keys: unsigned integers whose order is the order of elements  */
+/* ------------------------------------------------------------------ */
+
+static inline uint64_t radix_key_u32(const uint32_t *x) {
+	return *x;
+}
+
+// Flipping the sign bit maps two's complement order onto unsigned order
+static inline uint64_t radix_key_i32(const int32_t *x) {
+	return (uint32_t) *x ^ 0x80000000u;
+}
+
+// Positive floats: set the sign bit so they sort above negatives. Negative
+// floats: flip every bit, so that larger magnitudes sort lower.
+static inline uint64_t radix_key_f32(const float *x) {
+	uint32_t bits;
+	memcpy(&bits, x, sizeof(bits));
+	return bits ^ ((uint32_t) -(int32_t) (bits >> 31) | 0x80000000u);
+}
+
+static inline uint64_t radix_key_u64(const uint64_t *x) {
+	return *x;
+}
+
+static inline uint64_t radix_key_i64(const int64_t *x) {
+	return (uint64_t) *x ^ 0x8000000000000000ull;
+}
+
+static inline uint64_t radix_key_pairs64(const RadixPair64 *x) {
+	return x->key;
+}
+
+/* ------------------------------------------------------------------ */
+/* Serial sort                                                         */
+/* ------------------------------------------------------------------ */
+
+// One counting pass fills the histograms of every key byte, then each byte
+// whose keys are not all equal gets a scatter pass between data and scratch
+#define RADIX_DEFINE_SORT(NAME, T, KEY_BYTES)                                                                          \
+	bool radix_sort_##NAME(T *data, size_t n) {                                                                        \
+		if (n < 2) {                                                                                                   \
+			return true;                                                                                               \
+		}                                                                                                              \
+		T *scratch = malloc(n * sizeof(T));                                                                            \
+		if (!scratch) {                                                                                                \
+			return false;                                                                                              \
+		}                                                                                                              \
+		size_t counts[KEY_BYTES][256] = {{0}};                                                                         \
+		for (size_t i = 0; i < n; ++i) {                                                                               \
+			uint64_t key = radix_key_##NAME(&data[i]);                                                                 \
+			for (unsigned byte = 0; byte < (KEY_BYTES); ++byte) {                                                      \
+				++counts[byte][(key >> (8 * byte)) & 0xff];                                                            \
+			}                                                                                                          \
+		}                                                                                                              \
+		T *src = data;                                                                                                 \
+		T *dst = scratch;                                                                                              \
+		for (unsigned byte = 0; byte < (KEY_BYTES); ++byte) {                                                          \
+			unsigned shift = 8 * byte;                                                                                 \
+			size_t	*offsets = counts[byte];                                                                           \
+			if (offsets[(radix_key_##NAME(&src[0]) >> shift) & 0xff] == n) {                                           \
+				continue;                                                                                              \
+			}                                                                                                          \
+			size_t sum = 0;                                                                                            \
+			for (unsigned digit = 0; digit < 256; ++digit) {                                                           \
+				size_t count = offsets[digit];                                                                         \
+				offsets[digit] = sum;                                                                                  \
+				sum += count;                                                                                          \
+			}                                                                                                          \
+			for (size_t i = 0; i < n; ++i) {                                                                           \
+				dst[offsets[(radix_key_##NAME(&src[i]) >> shift) & 0xff]++] = src[i];                                  \
+			}                                                                                                          \
+			T *tmp = src;                                                                                              \
+			src = dst;                                                                                                 \
+			dst = tmp;                                                                                                 \
+		}                                                                                                              \
+		if (src != data) {                                                                                             \
+			memcpy(data, src, n * sizeof(T));                                                                          \
+		}                                                                                                              \
+		free(scratch);                                                                                                 \
+		return true;                                                                                                   \
+	}
+
+RADIX_DEFINE_SORT(u32, uint32_t, 4)
+RADIX_DEFINE_SORT(i32, int32_t, 4)
+RADIX_DEFINE_SORT(f32, float, 4)
+RADIX_DEFINE_SORT(u64, uint64_t, 8)
+RADIX_DEFINE_SORT(i64, int64_t, 8)
+RADIX_DEFINE_SORT(pairs64, RadixPair64, 8)
+
+/* ------------------------------------------------------------------ */
+/* Parallel sort                                                       */
+/* ------------------------------------------------------------------ */
+
+// Number of threads to sort n elements with, given the caller's request
+static unsigned radix_thread_count(unsigned requested, size_t n) {
+	if (requested == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		requested = cpus > 0 ? (unsigned) cpus : 1;
+	}
+	size_t useful = n / RADIX_SORT_PARALLEL_MIN_CHUNK;
+	if (requested > useful) {
+		requested = useful ? (unsigned) useful : 1;
+	}
+	return requested < RADIX_MAX_THREADS ? requested : RADIX_MAX_THREADS;
+}
+
+// Runs fn on every job, jobs[0] on the calling thread. A job whose thread
+// cannot be started runs on the calling thread too.
+static void radix_run(void *(*fn)(void *), void *jobs, size_t job_size, unsigned count) {
+	pthread_t threads[RADIX_MAX_THREADS];
+	bool	  started[RADIX_MAX_THREADS];
+	for (unsigned t = 1; t < count; ++t) {
+		started[t] = pthread_create(&threads[t], NULL, fn, (char *) jobs + t * job_size) == 0;
+	}
+	fn(jobs);
+	for (unsigned t = 1; t < count; ++t) {
+		if (started[t]) {
+			pthread_join(threads[t], NULL);
+		} else {
+			fn((char *) jobs + t * job_size);
+		}
+	}
+}
+
+// Each pass: every thread counts the digits of its slice; the counts become
+// per-thread output offsets (digit-major, then thread order, which keeps the
+// sort stable); every thread scatters its slice
+#define RADIX_DEFINE_PARALLEL_SORT(NAME, T, KEY_BYTES)                                                                 \
+	typedef struct RadixJob_##NAME {                                                                                   \
+		const T *src;                                                                                                  \
+		T		*dst;                                                                                                  \
+		size_t	 begin;                                                                                                \
+		size_t	 end;                                                                                                  \
+		unsigned shift;                                                                                                \
+		size_t	 counts[256];                                                                                          \
+	} RadixJob_##NAME;                                                                                                 \
+                                                                                                                       \
+	static void *radix_count_##NAME(void *arg) {                                                                       \
+		RadixJob_##NAME *job = arg;                                                                                    \
+		memset(job->counts, 0, sizeof(job->counts));                                                                   \
+		for (size_t i = job->begin; i < job->end; ++i) {                                                               \
+			++job->counts[(radix_key_##NAME(&job->src[i]) >> job->shift) & 0xff];                                      \
+		}                                                                                                              \
+		return NULL;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	static void *radix_scatter_##NAME(void *arg) {                                                                     \
+		RadixJob_##NAME *job = arg;                                                                                    \
+		for (size_t i = job->begin; i < job->end; ++i) {                                                               \
+			job->dst[job->counts[(radix_key_##NAME(&job->src[i]) >> job->shift) & 0xff]++] = job->src[i];              \
+		}                                                                                                              \
+		return NULL;                                                                                                   \
+	}                                                                                                                  \
+                                                                                                                       \
+	bool radix_sort_##NAME##_parallel(T *data, size_t n, unsigned threads) {                                           \
+		threads = radix_thread_count(threads, n);                                                                      \
+		if (threads < 2) {                                                                                             \
+			return radix_sort_##NAME(data, n);                                                                         \
+		}                                                                                                              \
+		T				*scratch = malloc(n * sizeof(T));                                                              \
+		RadixJob_##NAME *jobs = malloc(threads * sizeof(RadixJob_##NAME));                                             \
+		if (!scratch || !jobs) {                                                                                       \
+			free(scratch);                                                                                             \
+			free(jobs);                                                                                                \
+			return false;                                                                                              \
+		}                                                                                                              \
+		for (unsigned t = 0; t < threads; ++t) {                                                                       \
+			jobs[t].begin = n * t / threads;                                                                           \
+			jobs[t].end = n * (t + 1) / threads;                                                                       \
+		}                                                                                                              \
+		T *src = data;                                                                                                 \
+		T *dst = scratch;                                                                                              \
+		for (unsigned byte = 0; byte < (KEY_BYTES); ++byte) {                                                          \
+			for (unsigned t = 0; t < threads; ++t) {                                                                   \
+				jobs[t].src = src;                                                                                     \
+				jobs[t].dst = dst;                                                                                     \
+				jobs[t].shift = 8 * byte;                                                                              \
+			}                                                                                                          \
+			radix_run(radix_count_##NAME, jobs, sizeof(RadixJob_##NAME), threads);                                     \
+			size_t sum = 0;                                                                                            \
+			bool   all_equal = false;                                                                                  \
+			for (unsigned digit = 0; digit < 256 && !all_equal; ++digit) {                                             \
+				size_t digit_start = sum;                                                                              \
+				for (unsigned t = 0; t < threads; ++t) {                                                               \
+					size_t count = jobs[t].counts[digit];                                                              \
+					jobs[t].counts[digit] = sum;                                                                       \
+					sum += count;                                                                                      \
+				}                                                                                                      \
+				all_equal = sum - digit_start == n;                                                                    \
+			}                                                                                                          \
+			if (all_equal) {                                                                                           \
+				continue;                                                                                              \
+			}                                                                                                          \
+			radix_run(radix_scatter_##NAME, jobs, sizeof(RadixJob_##NAME), threads);                                   \
+			T *tmp = src;                                                                                              \
+			src = dst;                                                                                                 \
+			dst = tmp;                                                                                                 \
+		}                                                                                                              \
+		if (src != data) {                                                                                             \
+			memcpy(data, src, n * sizeof(T));                                                                          \
+		}                                                                                                              \
+		free(scratch);                                                                                                 \
+		free(jobs);                                                                                                    \
+		return true;                                                                                                   \
+	}
+
+RADIX_DEFINE_PARALLEL_SORT(u32, uint32_t, 4)
+RADIX_DEFINE_PARALLEL_SORT(u64, uint64_t, 8)
+RADIX_DEFINE_PARALLEL_SORT(pairs64, RadixPair64, 8)
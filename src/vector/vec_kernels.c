@@ -0,0 +1,947 @@
+#include "vector/vec_kernels.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VK_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+// The SIMD versions are compiled for their instruction set whatever the
+// flags of the build, and only called once CPUID reports it
+#define VK_SSE2 __attribute__((target("sse2")))
+#define VK_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Kernel table of one instruction set
+typedef struct VecKernels {
+	size_t (*find_f32)(const float *, size_t, float);
+	size_t (*find_i32)(const int32_t *, size_t, int32_t);
+	size_t (*count_f32)(const float *, size_t, float);
+	size_t (*count_i32)(const int32_t *, size_t, int32_t);
+	float (*min_f32)(const float *, size_t);
+	float (*max_f32)(const float *, size_t);
+	int32_t (*min_i32)(const int32_t *, size_t);
+	int32_t (*max_i32)(const int32_t *, size_t);
+	float (*sum_f32)(const float *, size_t);
+	int64_t (*sum_i32)(const int32_t *, size_t);
+	float (*dot_f32)(const float *, const float *, size_t);
+	int32_t (*dot_i32)(const int32_t *, const int32_t *, size_t);
+	void (*fill_f32)(float *, size_t, float);
+	void (*fill_i32)(int32_t *, size_t, int32_t);
+	void (*clamp_f32)(float *, size_t, float, float);
+	void (*clamp_i32)(int32_t *, size_t, int32_t, int32_t);
+	size_t (*compact_f32)(float *, const float *, const uint8_t *, size_t);
+	size_t (*compact_i32)(int32_t *, const int32_t *, const uint8_t *, size_t);
+	void (*prefix_sum_f32)(float *, const float *, size_t);
+	void (*prefix_sum_i32)(int32_t *, const int32_t *, size_t);
+} VecKernels;
+
+/* ------------------------------------------------------------------ */
+/* Scalar versions, also used for the tails of the SIMD versions       */
+/* ------------------------------------------------------------------ */
+
+static size_t vk_find_f32_scalar(const float *data, size_t n, float value) {
+	size_t i = 0;
+	while (i < n && data[i] != value) {
+		++i;
+	}
+	return i;
+}
+
+static size_t vk_find_i32_scalar(const int32_t *data, size_t n, int32_t value) {
+	size_t i = 0;
+	while (i < n && data[i] != value) {
+		++i;
+	}
+	return i;
+}
+
+static size_t vk_count_f32_scalar(const float *data, size_t n, float value) {
+	size_t count = 0;
+	for (size_t i = 0; i < n; ++i) {
+		count += data[i] == value;
+	}
+	return count;
+}
+
+static size_t vk_count_i32_scalar(const int32_t *data, size_t n, int32_t value) {
+	size_t count = 0;
+	for (size_t i = 0; i < n; ++i) {
+		count += data[i] == value;
+	}
+	return count;
+}
+
+static float vk_min_f32_scalar(const float *data, size_t n) {
+	float min = data[0];
+	for (size_t i = 1; i < n; ++i) {
+		min = data[i] < min ? data[i] : min;
+	}
+	return min;
+}
+
+static float vk_max_f32_scalar(const float *data, size_t n) {
+	float max = data[0];
+	for (size_t i = 1; i < n; ++i) {
+		max = data[i] > max ? data[i] : max;
+	}
+	return max;
+}
+
+static int32_t vk_min_i32_scalar(const int32_t *data, size_t n) {
+	int32_t min = data[0];
+	for (size_t i = 1; i < n; ++i) {
+		min = data[i] < min ? data[i] : min;
+	}
+	return min;
+}
+
+static int32_t vk_max_i32_scalar(const int32_t *data, size_t n) {
+	int32_t max = data[0];
+	for (size_t i = 1; i < n; ++i) {
+		max = data[i] > max ? data[i] : max;
+	}
+	return max;
+}
+
+static float vk_sum_f32_scalar(const float *data, size_t n) {
+	float sum = 0.0f;
+	for (size_t i = 0; i < n; ++i) {
+		sum += data[i];
+	}
+	return sum;
+}
+
+static int64_t vk_sum_i32_scalar(const int32_t *data, size_t n) {
+	int64_t sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += data[i];
+	}
+	return sum;
+}
+
+static float vk_dot_f32_scalar(const float *a, const float *b, size_t n) {
+	float sum = 0.0f;
+	for (size_t i = 0; i < n; ++i) {
+		sum += a[i] * b[i];
+	}
+	return sum;
+}
+
+// Unsigned arithmetic, so that overflow wraps like the SIMD versions
+static int32_t vk_dot_i32_scalar(const int32_t *a, const int32_t *b, size_t n) {
+	uint32_t sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		sum += (uint32_t) a[i] * (uint32_t) b[i];
+	}
+	return (int32_t) sum;
+}
+
+static void vk_fill_f32_scalar(float *data, size_t n, float value) {
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = value;
+	}
+}
+
+static void vk_fill_i32_scalar(int32_t *data, size_t n, int32_t value) {
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = value;
+	}
+}
+
+static void vk_clamp_f32_scalar(float *data, size_t n, float lo, float hi) {
+	for (size_t i = 0; i < n; ++i) {
+		float x = data[i] < lo ? lo : data[i];
+		data[i] = x > hi ? hi : x;
+	}
+}
+
+static void vk_clamp_i32_scalar(int32_t *data, size_t n, int32_t lo, int32_t hi) {
+	for (size_t i = 0; i < n; ++i) {
+		int32_t x = data[i] < lo ? lo : data[i];
+		data[i] = x > hi ? hi : x;
+	}
+}
+
+// Branchless: every element is written, and the position only advances past kept ones
+static size_t vk_compact_f32_scalar(float *dst, const float *src, const uint8_t *mask, size_t n) {
+	size_t kept = 0;
+	for (size_t i = 0; i < n; ++i) {
+		dst[kept] = src[i];
+		kept += mask[i] != 0;
+	}
+	return kept;
+}
+
+static size_t vk_compact_i32_scalar(int32_t *dst, const int32_t *src, const uint8_t *mask, size_t n) {
+	size_t kept = 0;
+	for (size_t i = 0; i < n; ++i) {
+		dst[kept] = src[i];
+		kept += mask[i] != 0;
+	}
+	return kept;
+}
+
+// Continues a prefix sum from `running`, the sum of the elements before src[0]
+static void vk_prefix_f32_from(float *dst, const float *src, size_t n, float running) {
+	for (size_t i = 0; i < n; ++i) {
+		running += src[i];
+		dst[i] = running;
+	}
+}
+
+static void vk_prefix_i32_from(int32_t *dst, const int32_t *src, size_t n, uint32_t running) {
+	for (size_t i = 0; i < n; ++i) {
+		running += (uint32_t) src[i];
+		dst[i] = (int32_t) running;
+	}
+}
+
+static void vk_prefix_sum_f32_scalar(float *dst, const float *src, size_t n) {
+	vk_prefix_f32_from(dst, src, n, 0.0f);
+}
+
+static void vk_prefix_sum_i32_scalar(int32_t *dst, const int32_t *src, size_t n) {
+	vk_prefix_i32_from(dst, src, n, 0);
+}
+
+static const VecKernels vk_scalar = {
+	vk_find_f32_scalar,		  vk_find_i32_scalar,		vk_count_f32_scalar,	  vk_count_i32_scalar,
+	vk_min_f32_scalar,		  vk_max_f32_scalar,		vk_min_i32_scalar,		  vk_max_i32_scalar,
+	vk_sum_f32_scalar,		  vk_sum_i32_scalar,		vk_dot_f32_scalar,		  vk_dot_i32_scalar,
+	vk_fill_f32_scalar,		  vk_fill_i32_scalar,		vk_clamp_f32_scalar,	  vk_clamp_i32_scalar,
+	vk_compact_f32_scalar,	  vk_compact_i32_scalar,	vk_prefix_sum_f32_scalar, vk_prefix_sum_i32_scalar,
+};
+
+#ifdef VK_X86
+
+/* ------------------------------------------------------------------ */
+/* SSE2: 4 lanes                                                       */
+/* ------------------------------------------------------------------ */
+
+// SSE2 has no 32-bit integer min/max or multiply; these build them from compares and 64-bit multiplies
+VK_SSE2 static inline __m128i vk_min_epi32_sse2(__m128i a, __m128i b) {
+	__m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+VK_SSE2 static inline __m128i vk_max_epi32_sse2(__m128i a, __m128i b) {
+	__m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+VK_SSE2 static inline __m128i vk_mullo_epi32_sse2(__m128i a, __m128i b) {
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+							  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+VK_SSE2 static inline float vk_hsum_ps_sse2(__m128 v) {
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+	return _mm_cvtss_f32(v);
+}
+
+VK_SSE2 static inline int32_t vk_hsum_epi32_sse2(__m128i v) {
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+VK_SSE2 static size_t vk_find_f32_sse2(const float *data, size_t n, float value) {
+	__m128 v = _mm_set1_ps(value);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		int match = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), v));
+		if (match) {
+			return i + (size_t) __builtin_ctz((unsigned) match);
+		}
+	}
+	return i + vk_find_f32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static size_t vk_find_i32_sse2(const int32_t *data, size_t n, int32_t value) {
+	__m128i v = _mm_set1_epi32(value);
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (data + i)), v);
+		int		match = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		if (match) {
+			return i + (size_t) __builtin_ctz((unsigned) match);
+		}
+	}
+	return i + vk_find_i32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static size_t vk_count_f32_sse2(const float *data, size_t n, float value) {
+	__m128 v = _mm_set1_ps(value);
+	size_t count = 0;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		count += (size_t) __builtin_popcount((unsigned) _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), v)));
+	}
+	return count + vk_count_f32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static size_t vk_count_i32_sse2(const int32_t *data, size_t n, int32_t value) {
+	__m128i v = _mm_set1_epi32(value);
+	size_t	count = 0;
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (data + i)), v);
+		count += (size_t) __builtin_popcount((unsigned) _mm_movemask_ps(_mm_castsi128_ps(eq)));
+	}
+	return count + vk_count_i32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static float vk_min_f32_sse2(const float *data, size_t n) {
+	if (n < 4) {
+		return vk_min_f32_scalar(data, n);
+	}
+	__m128 min = _mm_loadu_ps(data);
+	size_t i = 4;
+	for (; i + 4 <= n; i += 4) {
+		min = _mm_min_ps(min, _mm_loadu_ps(data + i));
+	}
+	// The last vector overlaps elements already seen, which does not change a minimum
+	min = _mm_min_ps(min, _mm_loadu_ps(data + n - 4));
+	min = _mm_min_ps(min, _mm_movehl_ps(min, min));
+	min = _mm_min_ss(min, _mm_shuffle_ps(min, min, 1));
+	return _mm_cvtss_f32(min);
+}
+
+VK_SSE2 static float vk_max_f32_sse2(const float *data, size_t n) {
+	if (n < 4) {
+		return vk_max_f32_scalar(data, n);
+	}
+	__m128 max = _mm_loadu_ps(data);
+	size_t i = 4;
+	for (; i + 4 <= n; i += 4) {
+		max = _mm_max_ps(max, _mm_loadu_ps(data + i));
+	}
+	max = _mm_max_ps(max, _mm_loadu_ps(data + n - 4));
+	max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+	max = _mm_max_ss(max, _mm_shuffle_ps(max, max, 1));
+	return _mm_cvtss_f32(max);
+}
+
+VK_SSE2 static int32_t vk_min_i32_sse2(const int32_t *data, size_t n) {
+	if (n < 4) {
+		return vk_min_i32_scalar(data, n);
+	}
+	__m128i min = _mm_loadu_si128((const __m128i *) data);
+	size_t	i = 4;
+	for (; i + 4 <= n; i += 4) {
+		min = vk_min_epi32_sse2(min, _mm_loadu_si128((const __m128i *) (data + i)));
+	}
+	min = vk_min_epi32_sse2(min, _mm_loadu_si128((const __m128i *) (data + n - 4)));
+	min = vk_min_epi32_sse2(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(1, 0, 3, 2)));
+	min = vk_min_epi32_sse2(min, _mm_shuffle_epi32(min, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(min);
+}
+
+VK_SSE2 static int32_t vk_max_i32_sse2(const int32_t *data, size_t n) {
+	if (n < 4) {
+		return vk_max_i32_scalar(data, n);
+	}
+	__m128i max = _mm_loadu_si128((const __m128i *) data);
+	size_t	i = 4;
+	for (; i + 4 <= n; i += 4) {
+		max = vk_max_epi32_sse2(max, _mm_loadu_si128((const __m128i *) (data + i)));
+	}
+	max = vk_max_epi32_sse2(max, _mm_loadu_si128((const __m128i *) (data + n - 4)));
+	max = vk_max_epi32_sse2(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+	max = vk_max_epi32_sse2(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(max);
+}
+
+// Two accumulators hide the latency of the additions
+VK_SSE2 static float vk_sum_f32_sse2(const float *data, size_t n) {
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_loadu_ps(data + i));
+		acc1 = _mm_add_ps(acc1, _mm_loadu_ps(data + i + 4));
+	}
+	return vk_hsum_ps_sse2(_mm_add_ps(acc0, acc1)) + vk_sum_f32_scalar(data + i, n - i);
+}
+
+VK_SSE2 static int64_t vk_sum_i32_sse2(const int32_t *data, size_t n) {
+	__m128i acc = _mm_setzero_si128();
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i sign = _mm_cmpgt_epi32(_mm_setzero_si128(), x);
+		acc = _mm_add_epi64(acc, _mm_add_epi64(_mm_unpacklo_epi32(x, sign), _mm_unpackhi_epi32(x, sign)));
+	}
+	int64_t lanes[2];
+	_mm_storeu_si128((__m128i *) lanes, acc);
+	return lanes[0] + lanes[1] + vk_sum_i32_scalar(data + i, n - i);
+}
+
+VK_SSE2 static float vk_dot_f32_sse2(const float *a, const float *b, size_t n) {
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	return vk_hsum_ps_sse2(_mm_add_ps(acc0, acc1)) + vk_dot_f32_scalar(a + i, b + i, n - i);
+}
+
+VK_SSE2 static int32_t vk_dot_i32_sse2(const int32_t *a, const int32_t *b, size_t n) {
+	__m128i acc = _mm_setzero_si128();
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+		__m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+		acc = _mm_add_epi32(acc, vk_mullo_epi32_sse2(x, y));
+	}
+	uint32_t sum = (uint32_t) vk_hsum_epi32_sse2(acc) + (uint32_t) vk_dot_i32_scalar(a + i, b + i, n - i);
+	return (int32_t) sum;
+}
+
+VK_SSE2 static void vk_fill_f32_sse2(float *data, size_t n, float value) {
+	__m128 v = _mm_set1_ps(value);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_ps(data + i, v);
+	}
+	vk_fill_f32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static void vk_fill_i32_sse2(int32_t *data, size_t n, int32_t value) {
+	__m128i v = _mm_set1_epi32(value);
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_si128((__m128i *) (data + i), v);
+	}
+	vk_fill_i32_scalar(data + i, n - i, value);
+}
+
+VK_SSE2 static void vk_clamp_f32_sse2(float *data, size_t n, float lo, float hi) {
+	__m128 vlo = _mm_set1_ps(lo);
+	__m128 vhi = _mm_set1_ps(hi);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), vlo), vhi));
+	}
+	vk_clamp_f32_scalar(data + i, n - i, lo, hi);
+}
+
+VK_SSE2 static void vk_clamp_i32_sse2(int32_t *data, size_t n, int32_t lo, int32_t hi) {
+	__m128i vlo = _mm_set1_epi32(lo);
+	__m128i vhi = _mm_set1_epi32(hi);
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (data + i));
+		_mm_storeu_si128((__m128i *) (data + i), vk_min_epi32_sse2(vk_max_epi32_sse2(x, vlo), vhi));
+	}
+	vk_clamp_i32_scalar(data + i, n - i, lo, hi);
+}
+
+// In-register prefix sum of four lanes by two shifted additions, plus the
+// running total broadcast from the previous vector
+VK_SSE2 static void vk_prefix_sum_f32_sse2(float *dst, const float *src, size_t n) {
+	__m128 carry = _mm_setzero_ps();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(src + i);
+		x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+		x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+		x = _mm_add_ps(x, carry);
+		_mm_storeu_ps(dst + i, x);
+		carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	vk_prefix_f32_from(dst + i, src + i, n - i, _mm_cvtss_f32(carry));
+}
+
+VK_SSE2 static void vk_prefix_sum_i32_sse2(int32_t *dst, const int32_t *src, size_t n) {
+	__m128i carry = _mm_setzero_si128();
+	size_t	i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi32(x, carry);
+		_mm_storeu_si128((__m128i *) (dst + i), x);
+		carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	vk_prefix_i32_from(dst + i, src + i, n - i, (uint32_t) _mm_cvtsi128_si32(carry));
+}
+
+// SSE2 has no variable shuffle to compact with, so compaction stays scalar (and branchless)
+static const VecKernels vk_sse2 = {
+	vk_find_f32_sse2,		vk_find_i32_sse2,	   vk_count_f32_sse2,	   vk_count_i32_sse2,
+	vk_min_f32_sse2,		vk_max_f32_sse2,	   vk_min_i32_sse2,		   vk_max_i32_sse2,
+	vk_sum_f32_sse2,		vk_sum_i32_sse2,	   vk_dot_f32_sse2,		   vk_dot_i32_sse2,
+	vk_fill_f32_sse2,		vk_fill_i32_sse2,	   vk_clamp_f32_sse2,	   vk_clamp_i32_sse2,
+	vk_compact_f32_scalar,	vk_compact_i32_scalar, vk_prefix_sum_f32_sse2, vk_prefix_sum_i32_sse2,
+};
+
+/* ------------------------------------------------------------------ */
+/* AVX2: 8 lanes                                                       */
+/* ------------------------------------------------------------------ */
+
+VK_AVX2 static inline float vk_hsum_ps_avx2(__m256 v) {
+	__m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+VK_AVX2 static inline int32_t vk_hsum_epi32_avx2(__m256i v) {
+	__m128i x = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+	x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(x);
+}
+
+VK_AVX2 static size_t vk_find_f32_avx2(const float *data, size_t n, float value) {
+	__m256 v = _mm256_set1_ps(value);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int match = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), v, _CMP_EQ_OQ));
+		if (match) {
+			return i + (size_t) __builtin_ctz((unsigned) match);
+		}
+	}
+	return i + vk_find_f32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static size_t vk_find_i32_avx2(const int32_t *data, size_t n, int32_t value) {
+	__m256i v = _mm256_set1_epi32(value);
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (data + i)), v);
+		int		match = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		if (match) {
+			return i + (size_t) __builtin_ctz((unsigned) match);
+		}
+	}
+	return i + vk_find_i32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static size_t vk_count_f32_avx2(const float *data, size_t n, float value) {
+	__m256 v = _mm256_set1_ps(value);
+	size_t count = 0;
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 eq = _mm256_cmp_ps(_mm256_loadu_ps(data + i), v, _CMP_EQ_OQ);
+		count += (size_t) __builtin_popcount((unsigned) _mm256_movemask_ps(eq));
+	}
+	return count + vk_count_f32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static size_t vk_count_i32_avx2(const int32_t *data, size_t n, int32_t value) {
+	__m256i v = _mm256_set1_epi32(value);
+	size_t	count = 0;
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (data + i)), v);
+		count += (size_t) __builtin_popcount((unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+	}
+	return count + vk_count_i32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static float vk_min_f32_avx2(const float *data, size_t n) {
+	if (n < 8) {
+		return vk_min_f32_sse2(data, n);
+	}
+	__m256 min = _mm256_loadu_ps(data);
+	size_t i = 8;
+	for (; i + 8 <= n; i += 8) {
+		min = _mm256_min_ps(min, _mm256_loadu_ps(data + i));
+	}
+	min = _mm256_min_ps(min, _mm256_loadu_ps(data + n - 8));
+	__m128 x = _mm_min_ps(_mm256_castps256_ps128(min), _mm256_extractf128_ps(min, 1));
+	x = _mm_min_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_min_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+VK_AVX2 static float vk_max_f32_avx2(const float *data, size_t n) {
+	if (n < 8) {
+		return vk_max_f32_sse2(data, n);
+	}
+	__m256 max = _mm256_loadu_ps(data);
+	size_t i = 8;
+	for (; i + 8 <= n; i += 8) {
+		max = _mm256_max_ps(max, _mm256_loadu_ps(data + i));
+	}
+	max = _mm256_max_ps(max, _mm256_loadu_ps(data + n - 8));
+	__m128 x = _mm_max_ps(_mm256_castps256_ps128(max), _mm256_extractf128_ps(max, 1));
+	x = _mm_max_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_max_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+
+VK_AVX2 static int32_t vk_min_i32_avx2(const int32_t *data, size_t n) {
+	if (n < 8) {
+		return vk_min_i32_sse2(data, n);
+	}
+	__m256i min = _mm256_loadu_si256((const __m256i *) data);
+	size_t	i = 8;
+	for (; i + 8 <= n; i += 8) {
+		min = _mm256_min_epi32(min, _mm256_loadu_si256((const __m256i *) (data + i)));
+	}
+	min = _mm256_min_epi32(min, _mm256_loadu_si256((const __m256i *) (data + n - 8)));
+	__m128i x = _mm_min_epi32(_mm256_castsi256_si128(min), _mm256_extracti128_si256(min, 1));
+	x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+	x = _mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(x);
+}
+
+VK_AVX2 static int32_t vk_max_i32_avx2(const int32_t *data, size_t n) {
+	if (n < 8) {
+		return vk_max_i32_sse2(data, n);
+	}
+	__m256i max = _mm256_loadu_si256((const __m256i *) data);
+	size_t	i = 8;
+	for (; i + 8 <= n; i += 8) {
+		max = _mm256_max_epi32(max, _mm256_loadu_si256((const __m256i *) (data + i)));
+	}
+	max = _mm256_max_epi32(max, _mm256_loadu_si256((const __m256i *) (data + n - 8)));
+	__m128i x = _mm_max_epi32(_mm256_castsi256_si128(max), _mm256_extracti128_si256(max, 1));
+	x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+	x = _mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(x);
+}
+
+VK_AVX2 static float vk_sum_f32_avx2(const float *data, size_t n) {
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+		acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+	}
+	return vk_hsum_ps_avx2(_mm256_add_ps(acc0, acc1)) + vk_sum_f32_scalar(data + i, n - i);
+}
+
+VK_AVX2 static int64_t vk_sum_i32_avx2(const int32_t *data, size_t n) {
+	__m256i acc = _mm256_setzero_si256();
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i lo = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) (data + i)));
+		__m256i hi = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) (data + i + 4)));
+		acc = _mm256_add_epi64(acc, _mm256_add_epi64(lo, hi));
+	}
+	int64_t lanes[4];
+	_mm256_storeu_si256((__m256i *) lanes, acc);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + vk_sum_i32_scalar(data + i, n - i);
+}
+
+VK_AVX2 static float vk_dot_f32_avx2(const float *a, const float *b, size_t n) {
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+		acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+	}
+	return vk_hsum_ps_avx2(_mm256_add_ps(acc0, acc1)) + vk_dot_f32_scalar(a + i, b + i, n - i);
+}
+
+VK_AVX2 static int32_t vk_dot_i32_avx2(const int32_t *a, const int32_t *b, size_t n) {
+	__m256i acc = _mm256_setzero_si256();
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+		acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(x, y));
+	}
+	uint32_t sum = (uint32_t) vk_hsum_epi32_avx2(acc) + (uint32_t) vk_dot_i32_scalar(a + i, b + i, n - i);
+	return (int32_t) sum;
+}
+
+VK_AVX2 static void vk_fill_f32_avx2(float *data, size_t n, float value) {
+	__m256 v = _mm256_set1_ps(value);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(data + i, v);
+	}
+	vk_fill_f32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static void vk_fill_i32_avx2(int32_t *data, size_t n, int32_t value) {
+	__m256i v = _mm256_set1_epi32(value);
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_si256((__m256i *) (data + i), v);
+	}
+	vk_fill_i32_scalar(data + i, n - i, value);
+}
+
+VK_AVX2 static void vk_clamp_f32_avx2(float *data, size_t n, float lo, float hi) {
+	__m256 vlo = _mm256_set1_ps(lo);
+	__m256 vhi = _mm256_set1_ps(hi);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(data + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), vlo), vhi));
+	}
+	vk_clamp_f32_scalar(data + i, n - i, lo, hi);
+}
+
+VK_AVX2 static void vk_clamp_i32_avx2(int32_t *data, size_t n, int32_t lo, int32_t hi) {
+	__m256i vlo = _mm256_set1_epi32(lo);
+	__m256i vhi = _mm256_set1_epi32(hi);
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (data + i));
+		_mm256_storeu_si256((__m256i *) (data + i), _mm256_min_epi32(_mm256_max_epi32(x, vlo), vhi));
+	}
+	vk_clamp_i32_scalar(data + i, n - i, lo, hi);
+}
+
+// Lane order that packs the lanes selected by a 4-bit keep mask to the front
+static const int32_t vk_compact_lanes[16][4] = {
+	{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0}, {2, 0, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 0}, {0, 1, 2, 0},
+	{3, 0, 0, 0}, {0, 3, 0, 0}, {1, 3, 0, 0}, {0, 1, 3, 0}, {2, 3, 0, 0}, {0, 2, 3, 0}, {1, 2, 3, 0}, {0, 1, 2, 3},
+};
+
+// Packs the kept elements of whole groups of eight, as two halves with the AVX
+// variable in-lane permute; each store writes a whole half past the kept
+// elements. The elements are read before anything is stored, so dst may equal
+// src. Sets *done to the number of elements consumed, leaving the tail.
+VK_AVX2 static size_t vk_compact_avx2(void *dst, const void *src, const uint8_t *mask, size_t n, size_t *done) {
+	float		*out = (float *) dst;
+	const float *in = (const float *) src;
+	size_t		 kept = 0;
+	size_t		 i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i	 bytes = _mm_loadl_epi64((const __m128i *) (mask + i));
+		unsigned keep = ~(unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())) & 0xff;
+		__m128	 lo = _mm_loadu_ps(in + i);
+		__m128	 hi = _mm_loadu_ps(in + i + 4);
+		__m128i	 lo_lanes = _mm_loadu_si128((const __m128i *) vk_compact_lanes[keep & 15]);
+		__m128i	 hi_lanes = _mm_loadu_si128((const __m128i *) vk_compact_lanes[keep >> 4]);
+		_mm_storeu_ps(out + kept, _mm_permutevar_ps(lo, lo_lanes));
+		kept += (size_t) __builtin_popcount(keep & 15);
+		_mm_storeu_ps(out + kept, _mm_permutevar_ps(hi, hi_lanes));
+		kept += (size_t) __builtin_popcount(keep >> 4);
+	}
+	*done = i;
+	return kept;
+}
+
+VK_AVX2 static size_t vk_compact_f32_avx2(float *dst, const float *src, const uint8_t *mask, size_t n) {
+	size_t done;
+	size_t kept = vk_compact_avx2(dst, src, mask, n, &done);
+	return kept + vk_compact_f32_scalar(dst + kept, src + done, mask + done, n - done);
+}
+
+VK_AVX2 static size_t vk_compact_i32_avx2(int32_t *dst, const int32_t *src, const uint8_t *mask, size_t n) {
+	size_t done;
+	size_t kept = vk_compact_avx2(dst, src, mask, n, &done);
+	return kept + vk_compact_i32_scalar(dst + kept, src + done, mask + done, n - done);
+}
+
+// Prefix sums within each 128-bit half, then the low half's total added to
+// the high half and the running total to both
+VK_AVX2 static void vk_prefix_sum_f32_avx2(float *dst, const float *src, size_t n) {
+	__m256 carry = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 x = _mm256_loadu_ps(src + i);
+		x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+		x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+		__m256 low_total = _mm256_permute2f128_ps(x, x, 0x08);
+		x = _mm256_add_ps(x, _mm256_shuffle_ps(low_total, low_total, _MM_SHUFFLE(3, 3, 3, 3)));
+		x = _mm256_add_ps(x, carry);
+		_mm256_storeu_ps(dst + i, x);
+		carry = _mm256_permutevar8x32_ps(x, _mm256_set1_epi32(7));
+	}
+	vk_prefix_f32_from(dst + i, src + i, n - i, _mm256_cvtss_f32(carry));
+}
+
+VK_AVX2 static void vk_prefix_sum_i32_avx2(int32_t *dst, const int32_t *src, size_t n) {
+	__m256i carry = _mm256_setzero_si256();
+	size_t	i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + i));
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+		x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+		__m256i low_total = _mm256_permute2x128_si256(x, x, 0x08);
+		x = _mm256_add_epi32(x, _mm256_shuffle_epi32(low_total, _MM_SHUFFLE(3, 3, 3, 3)));
+		x = _mm256_add_epi32(x, carry);
+		_mm256_storeu_si256((__m256i *) (dst + i), x);
+		carry = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+	}
+	vk_prefix_i32_from(dst + i, src + i, n - i, (uint32_t) _mm_cvtsi128_si32(_mm256_castsi256_si128(carry)));
+}
+
+static const VecKernels vk_avx2 = {
+	vk_find_f32_avx2,	 vk_find_i32_avx2,	  vk_count_f32_avx2,	  vk_count_i32_avx2,
+	vk_min_f32_avx2,	 vk_max_f32_avx2,	  vk_min_i32_avx2,		  vk_max_i32_avx2,
+	vk_sum_f32_avx2,	 vk_sum_i32_avx2,	  vk_dot_f32_avx2,		  vk_dot_i32_avx2,
+	vk_fill_f32_avx2,	 vk_fill_i32_avx2,	  vk_clamp_f32_avx2,	  vk_clamp_i32_avx2,
+	vk_compact_f32_avx2, vk_compact_i32_avx2, vk_prefix_sum_f32_avx2, vk_prefix_sum_i32_avx2,
+};
+
+// XCR0: which register states the OS saves on context switches
+static unsigned long long vk_xgetbv0(void) {
+	unsigned lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long) hi << 32) | lo;
+}
+
+#endif // VK_X86
+
+/* ------------------------------------------------------------------ */
+/* Dispatch                                                            */
+/* ------------------------------------------------------------------ */
+
+// Table in use; NULL until the first kernel call or vec_simd_set_level
+static const VecKernels *_Atomic vk_active;
+static _Atomic VecSimdLevel		 vk_level;
+
+VecSimdLevel vec_simd_detect(void) {
+#ifdef VK_X86
+	unsigned eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(edx & bit_SSE2)) {
+		return VEC_SIMD_SCALAR;
+	}
+	// AVX2 also needs the OS to save the YMM registers: OSXSAVE set and XCR0
+	// bits 1 (SSE) and 2 (AVX) enabled
+	if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX) && (vk_xgetbv0() & 6) == 6 &&
+		__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2)) {
+		return VEC_SIMD_AVX2;
+	}
+	return VEC_SIMD_SSE2;
+#else
+	return VEC_SIMD_SCALAR;
+#endif
+}
+
+VecSimdLevel vec_simd_set_level(VecSimdLevel level) {
+	VecSimdLevel supported = vec_simd_detect();
+	if (level > supported) {
+		level = supported;
+	}
+	const VecKernels *kernels = &vk_scalar;
+#ifdef VK_X86
+	if (level == VEC_SIMD_AVX2) {
+		kernels = &vk_avx2;
+	} else if (level == VEC_SIMD_SSE2) {
+		kernels = &vk_sse2;
+	}
+#endif
+	atomic_store(&vk_level, level);
+	atomic_store_explicit(&vk_active, kernels, memory_order_release);
+	return level;
+}
+
+VecSimdLevel vec_simd_level(void) {
+	if (!atomic_load_explicit(&vk_active, memory_order_acquire)) {
+		vec_simd_set_level(vec_simd_detect());
+	}
+	return atomic_load(&vk_level);
+}
+
+static inline const VecKernels *vk_get(void) {
+	const VecKernels *kernels = atomic_load_explicit(&vk_active, memory_order_acquire);
+	if (!kernels) {
+		vec_simd_set_level(vec_simd_detect());
+		kernels = atomic_load_explicit(&vk_active, memory_order_acquire);
+	}
+	return kernels;
+}
+
+/* ------------------------------------------------------------------ */
+/* Public entry points                                                 */
+/* ------------------------------------------------------------------ */
+
+size_t vec_find_f32(const float *data, size_t n, float value) {
+	return vk_get()->find_f32(data, n, value);
+}
+
+size_t vec_find_i32(const int32_t *data, size_t n, int32_t value) {
+	return vk_get()->find_i32(data, n, value);
+}
+
+size_t vec_count_f32(const float *data, size_t n, float value) {
+	return vk_get()->count_f32(data, n, value);
+}
+
+size_t vec_count_i32(const int32_t *data, size_t n, int32_t value) {
+	return vk_get()->count_i32(data, n, value);
+}
+
+float vec_min_f32(const float *data, size_t n) {
+	return vk_get()->min_f32(data, n);
+}
+
+float vec_max_f32(const float *data, size_t n) {
+	return vk_get()->max_f32(data, n);
+}
+
+int32_t vec_min_i32(const int32_t *data, size_t n) {
+	return vk_get()->min_i32(data, n);
+}
+
+int32_t vec_max_i32(const int32_t *data, size_t n) {
+	return vk_get()->max_i32(data, n);
+}
+
+// Two passes, both vectorized: the minimum, then its first position
+size_t vec_argmin_f32(const float *data, size_t n) {
+	const VecKernels *kernels = vk_get();
+	return n ? kernels->find_f32(data, n, kernels->min_f32(data, n)) : 0;
+}
+
+size_t vec_argmin_i32(const int32_t *data, size_t n) {
+	const VecKernels *kernels = vk_get();
+	return n ? kernels->find_i32(data, n, kernels->min_i32(data, n)) : 0;
+}
+
+float vec_sum_f32(const float *data, size_t n) {
+	return vk_get()->sum_f32(data, n);
+}
+
+int64_t vec_sum_i32(const int32_t *data, size_t n) {
+	return vk_get()->sum_i32(data, n);
+}
+
+float vec_dot_f32(const float *a, const float *b, size_t n) {
+	return vk_get()->dot_f32(a, b, n);
+}
+
+int32_t vec_dot_i32(const int32_t *a, const int32_t *b, size_t n) {
+	return vk_get()->dot_i32(a, b, n);
+}
+
+void vec_fill_f32(float *data, size_t n, float value) {
+	vk_get()->fill_f32(data, n, value);
+}
+
+void vec_fill_i32(int32_t *data, size_t n, int32_t value) {
+	vk_get()->fill_i32(data, n, value);
+}
+
+void vec_clamp_f32(float *data, size_t n, float lo, float hi) {
+	vk_get()->clamp_f32(data, n, lo, hi);
+}
+
+void vec_clamp_i32(int32_t *data, size_t n, int32_t lo, int32_t hi) {
+	vk_get()->clamp_i32(data, n, lo, hi);
+}
+
+size_t vec_compact_f32(float *dst, const float *src, const uint8_t *mask, size_t n) {
+	return vk_get()->compact_f32(dst, src, mask, n);
+}
+
+size_t vec_compact_i32(int32_t *dst, const int32_t *src, const uint8_t *mask, size_t n) {
+	return vk_get()->compact_i32(dst, src, mask, n);
+}
+
+void vec_prefix_sum_f32(float *dst, const float *src, size_t n) {
+	vk_get()->prefix_sum_f32(dst, src, n);
+}
+
+void vec_prefix_sum_i32(int32_t *dst, const int32_t *src, size_t n) {
+	vk_get()->prefix_sum_i32(dst, src, n);
+}
@@ -0,0 +1,152 @@
+#include "btree/bplustree.h"
+#include "test_common.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+DEF_BPLUSTREE(uint64_t, uint32_t, Timeline)
+
+// A fanout of 4 keys builds deep trees from few keys and exercises every split and merge path
+#undef BPLUSTREE_KEY_BYTES
+#define BPLUSTREE_KEY_BYTES 16
+DEF_BPLUSTREE(int32_t, int32_t, SmallTree)
+
+// Checks order, fill and depth below node; keys lie in [low, high) where given
+static void check_node(SmallTree_node *node, size_t depth, size_t height, const int32_t *low, const int32_t *high,
+					   int is_root) {
+	assert(node->count <= SmallTree_fanout);
+	assert(is_root || node->count >= SmallTree_min_keys);
+	for (uint32_t i = 0; i < node->count; ++i) {
+		assert(i == 0 || node->keys[i - 1] < node->keys[i]);
+		assert(!low || node->keys[i] >= *low);
+		assert(!high || node->keys[i] < *high);
+	}
+	if (node->leaf) {
+		assert(depth == height); // every leaf at the same depth
+		return;
+	}
+	SmallTree_inner *inner = SmallTree_as_inner(node);
+	for (uint32_t i = 0; i <= node->count; ++i) {
+		check_node(inner->children[i], depth + 1, height, i > 0 ? &node->keys[i - 1] : low,
+				   i < node->count ? &node->keys[i] : high, 0);
+	}
+}
+
+// Checks the structure, and that a scan of the linked leaves yields exactly the present keys
+static void check_tree(const SmallTree *tree, const int32_t *values, int n) {
+	if (tree->root)
+		check_node(tree->root, 1, tree->height, NULL, NULL, 1);
+	else
+		assert(tree->height == 0 && tree->first == NULL && tree->count == 0);
+	size_t			 seen = 0;
+	int32_t			 prev = -1;
+	SmallTree_leaf	*prev_leaf = NULL;
+	SmallTree_cursor cursor = SmallTree_begin(tree);
+	for (; SmallTree_cursor_valid(&cursor); SmallTree_cursor_next(&cursor)) {
+		int32_t key = SmallTree_cursor_key(&cursor);
+		assert(key > prev && key < n && values[key] >= 0);
+		assert(*SmallTree_cursor_value(&cursor) == values[key]);
+		if (cursor.index == 0) {
+			assert(cursor.leaf->prev == prev_leaf);
+			prev_leaf = cursor.leaf;
+		}
+		prev = key;
+		++seen;
+	}
+	assert(tree->last == prev_leaf);
+	assert(seen == tree->count);
+}
+
+// Function to test randomized inserts, replacements and erases against a value table.
+void test_bplustree_random() {
+	enum { N = 3000 };
+	static int32_t values[N]; // -1 when absent
+	memset(values, 0xff, sizeof(values));
+	SmallTree tree;
+	SmallTree_init(&tree);
+	int erased = SmallTree_erase(&tree, 5);
+	assert(SmallTree_find(&tree, 5) == NULL && !erased);
+
+	size_t present = 0;
+	for (int step = 0; step < 60000; ++step) {
+		int32_t key = (int32_t) (test_rand() % N);
+		int		op = (int) (test_rand() % 3);
+		if (op < 2) {
+			int32_t value = (int32_t) (test_rand() % 1000);
+			present += values[key] < 0;
+			int ok = SmallTree_insert(&tree, key, value);
+			assert(ok);
+			values[key] = value;
+		} else {
+			int erased = SmallTree_erase(&tree, key);
+			assert(erased == (values[key] >= 0));
+			present -= values[key] >= 0;
+			values[key] = -1;
+		}
+		assert(tree.count == present);
+		int32_t *found = SmallTree_find(&tree, key);
+		assert(values[key] >= 0 ? found && *found == values[key] : found == NULL);
+		if (step % 2000 == 0)
+			check_tree(&tree, values, N);
+	}
+	check_tree(&tree, values, N);
+	assert(tree.height > 3);
+
+	// Drain the tree in a scattered order
+	for (int32_t i = 0; i < N; ++i) {
+		int32_t key = (int32_t) ((i * 7) % N);
+		int erased = SmallTree_erase(&tree, key);
+		assert(erased == (values[key] >= 0));
+		values[key] = -1;
+		if (i % 500 == 0)
+			check_tree(&tree, values, N);
+	}
+	assert(tree.count == 0 && tree.root == NULL && tree.height == 0);
+	SmallTree_deinit(&tree);
+}
+
+// Function to test sequential bulk inserts, lookups and lower bounds with the default node size.
+void test_bplustree_bounds() {
+	Timeline tree;
+	Timeline_init(&tree);
+	enum { N = 100000 };
+	for (uint32_t i = 0; i < N; ++i) {
+		int ok = Timeline_insert(&tree, (uint64_t) i * 10, i);
+		assert(ok);
+	}
+	assert(tree.count == N && Timeline_fanout == 16);
+	for (uint32_t i = 0; i < N; ++i) {
+		uint32_t *value = Timeline_find(&tree, (uint64_t) i * 10);
+		assert(value && *value == i);
+		assert(Timeline_find(&tree, (uint64_t) i * 10 + 5) == NULL);
+	}
+
+	// Every lower bound lands on the next multiple of ten, and scans continue across leaves
+	for (uint64_t key = 0; key < (uint64_t) N * 10; key += 7) {
+		Timeline_cursor cursor = Timeline_lower_bound(&tree, key);
+		uint64_t		expect = (key + 9) / 10 * 10;
+		assert(expect < (uint64_t) N * 10 ? Timeline_cursor_key(&cursor) == expect : !Timeline_cursor_valid(&cursor));
+	}
+	Timeline_cursor cursor = Timeline_lower_bound(&tree, 55555);
+	for (uint64_t expect = 55560; expect < 56000; expect += 10) {
+		assert(Timeline_cursor_key(&cursor) == expect);
+		Timeline_cursor_next(&cursor);
+	}
+	cursor = Timeline_lower_bound(&tree, (uint64_t) N * 10);
+	assert(!Timeline_cursor_valid(&cursor));
+	Timeline_deinit(&tree);
+	assert(tree.root == NULL);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_bplustree_random(); // Run randomized insert and erase test
+	test_bplustree_bounds(); // Run lookup and range test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -1,10 +1,41 @@
 #include "btree/btree.h"
+#include "test_common.h"
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 DEF_BTREE(int, IntTree)
 
-int main(void) {
+static int IntTree_node_cmp(IntTree_node *pnode_a, IntTree_node *pnode_b) {
+	return (pnode_a->value > pnode_b->value) - (pnode_a->value < pnode_b->value);
+}
+
+// Checks links, order and red-black rules below node; returns its black height
+static int check_subtree(IntTree_node *node, IntTree_node *parent, const int *low, const int *high, size_t *count) {
+	if (!node)
+		return 1;
+	assert(node->pparent == parent);
+	assert(!low || node->value > *low);
+	assert(!high || node->value < *high);
+	if (node->red)
+		assert(!IntTree_is_red(node->pchildren[0]) && !IntTree_is_red(node->pchildren[1]));
+	++*count;
+	int left = check_subtree(node->pchildren[0], node, low, &node->value, count);
+	int right = check_subtree(node->pchildren[1], node, &node->value, high, count);
+	assert(left == right);
+	return left + !node->red;
+}
+
+static void check_tree(const IntTree *tree) {
+	size_t count = 0;
+	assert(!IntTree_is_red(tree->root));
+	check_subtree(tree->root, NULL, NULL, NULL, &count);
+	assert(count == tree->count);
+}
+
+// Function to test navigating a tree linked by hand.
+void test_btree_manual_links() {
 	// Initialize nodes
 	IntTree_node head;
 	IntTree_node_init_t(&head, 5); // Create root node with value 5
@@ -69,6 +100,265 @@ int main(void) {
 	assert(did_iter == 0); // Already at head
 
 	IntTree_iterator_deinit(&iter);
+}
+
+// Function to test randomized inserts and erases against a presence table, checking the invariants.
+void test_btree_insert_erase() {
+	enum { N = 4000 };
+	static IntTree_node nodes[N];
+	static int			present[N];
+	IntTree				tree;
+	IntTree_init(&tree);
+	assert(IntTree_find(&tree, 1) == NULL && IntTree_lower_bound(&tree, 1) == NULL);
+
+	for (int step = 0; step < 40000; ++step) {
+		int value = (int) (test_rand() % N);
+		if (present[value]) {
+			assert(IntTree_find(&tree, value) == &nodes[value]);
+			IntTree_erase(&tree, &nodes[value]);
+			present[value] = 0;
+			assert(IntTree_find(&tree, value) == NULL);
+		} else {
+			IntTree_node_init_t(&nodes[value], value);
+			IntTree_node *inserted = IntTree_insert(&tree, &nodes[value]);
+			assert(inserted == &nodes[value]);
+			present[value] = 1;
+		}
+		if (step % 1000 == 0)
+			check_tree(&tree);
+	}
+	check_tree(&tree);
+
+	// A second node with a present value is not linked
+	IntTree_node duplicate;
+	for (int value = 0; value < N; ++value) {
+		if (present[value]) {
+			IntTree_node_init_t(&duplicate, value);
+			IntTree_node *existing = IntTree_insert(&tree, &duplicate);
+			assert(existing == &nodes[value]);
+			break;
+		}
+	}
+
+	// Ascending inserts stay balanced: height is at most 2 log2(n + 1)
+	IntTree sorted;
+	IntTree_init(&sorted);
+	static IntTree_node run[N];
+	for (int i = 0; i < N; ++i) {
+		IntTree_node_init_t(&run[i], i);
+		IntTree_insert(&sorted, &run[i]);
+	}
+	check_tree(&sorted);
+	int depth = 0;
+	for (IntTree_node *node = sorted.root; node; node = node->pchildren[0])
+		++depth;
+	assert(depth <= 24);
+	for (int i = 0; i < N; ++i)
+		IntTree_erase(&sorted, &run[(i * 7) % N]); // 7 is coprime to N, so every node once
+	assert(sorted.root == NULL && sorted.count == 0);
+}
+
+// Function to test lower and upper bounds against a linear scan.
+void test_btree_bounds() {
+	enum { N = 500 };
+	static IntTree_node nodes[N];
+	IntTree				tree;
+	IntTree_init(&tree);
+	for (int i = 0; i < N; ++i) {
+		IntTree_node_init_t(&nodes[i], i * 3); // 0, 3, 6, ...
+		IntTree_insert(&tree, &nodes[i]);
+	}
+	for (int value = -2; value < N * 3 + 2; ++value) {
+		IntTree_node *lower = IntTree_lower_bound(&tree, value);
+		IntTree_node *upper = IntTree_upper_bound(&tree, value);
+		int			  expect_lower = value <= 0 ? 0 : (value + 2) / 3 * 3;
+		int			  expect_upper = value < 0 ? 0 : (value / 3 + 1) * 3;
+		assert(expect_lower < N * 3 ? lower && lower->value == expect_lower : lower == NULL);
+		assert(expect_upper < N * 3 ? upper && upper->value == expect_upper : upper == NULL);
+		assert((IntTree_find(&tree, value) != NULL) == (value >= 0 && value < N * 3 && value % 3 == 0));
+	}
+}
+
+enum { TRAVERSAL_PRE, TRAVERSAL_IN, TRAVERSAL_POST };
+
+// Reference traversal by recursion
+static void collect(IntTree_node *node, int order, IntTree_node **out, size_t *n) {
+	if (!node)
+		return;
+	if (order == TRAVERSAL_PRE)
+		out[(*n)++] = node;
+	collect(node->pchildren[0], order, out, n);
+	if (order == TRAVERSAL_IN)
+		out[(*n)++] = node;
+	collect(node->pchildren[1], order, out, n);
+	if (order == TRAVERSAL_POST)
+		out[(*n)++] = node;
+}
+
+// Checks the stepping functions of each order forwards and backwards against the recursive reference
+static void check_traversals(IntTree *tree) {
+	static IntTree_node *expect[5000];
+	for (int order = TRAVERSAL_PRE; order <= TRAVERSAL_POST; ++order) {
+		size_t n = 0;
+		collect(tree->root, order, expect, &n);
+		size_t		  i = 0;
+		IntTree_node *node;
+		if (order == TRAVERSAL_PRE) {
+			BTREE_FOREACH_PREORDER(IntTree, tree, node) {
+				assert(node == expect[i++]);
+			}
+			assert(i == n);
+			for (node = IntTree_preorder_last(tree); node; node = IntTree_preorder_prev(node))
+				assert(node == expect[--i]);
+		} else if (order == TRAVERSAL_IN) {
+			BTREE_FOREACH(IntTree, tree, node) {
+				assert(node == expect[i++]);
+			}
+			assert(i == n);
+			BTREE_FOREACH_REVERSE(IntTree, tree, node) {
+				assert(node == expect[--i]);
+			}
+		} else {
+			BTREE_FOREACH_POSTORDER(IntTree, tree, node) {
+				assert(node == expect[i++]);
+			}
+			assert(i == n);
+			for (node = IntTree_postorder_last(tree); node; node = IntTree_postorder_prev(node))
+				assert(node == expect[--i]);
+		}
+		assert(i == 0);
+	}
+}
+
+// Function to test in-order, reverse, pre-order and post-order traversal through the parent links.
+void test_btree_traversals() {
+	IntTree tree;
+	IntTree_init(&tree);
+	check_traversals(&tree); // empty
+	assert(IntTree_first(&tree) == NULL && IntTree_postorder_first(&tree) == NULL);
+
+	enum { N = 3000 };
+	static IntTree_node nodes[N];
+	for (int i = 0; i < N; ++i) {
+		IntTree_node_init_t(&nodes[i], (int) (test_rand() % 100000));
+		IntTree_insert(&tree, &nodes[i]);
+		if (i < 8 || i % 500 == 0)
+			check_traversals(&tree); // small shapes, including lopsided ones
+	}
+	check_traversals(&tree);
+
+	// In-order visits values ascending
+	IntTree_node *node;
+	int			  prev = -1;
+	size_t		  count = 0;
+	BTREE_FOREACH(IntTree, &tree, node) {
+		assert(node->value > prev);
+		prev = node->value;
+		++count;
+	}
+	assert(count == tree.count);
+}
+
+static int height(const IntTree_node *node) {
+	if (!node)
+		return 0;
+	int left = height(node->pchildren[BTREE_LEFT]), right = height(node->pchildren[BTREE_RIGHT]);
+	return 1 + (left > right ? left : right);
+}
+
+static void sum_values(void *ctx, IntTree_node *node) {
+	*(long *) ctx += node->value;
+}
+
+// Function to test linear-time builds from sorted values and the range queries.
+void test_btree_build_and_ranges() {
+	static int values[70000];
+	for (int i = 0; i < 70000; ++i)
+		values[i] = i * 2; // even numbers
+
+	IntTree tree;
+	for (size_t n = 0; n <= 70; ++n) {
+		IntTree_node *block = IntTree_build_from_sorted(&tree, values, n);
+		assert((block != NULL) == (n > 0));
+		check_tree(&tree);
+		size_t		  i = 0;
+		IntTree_node *node;
+		BTREE_FOREACH(IntTree, &tree, node) {
+			assert(node->value == values[i++]);
+		}
+		assert(i == n);
+		free(block);
+	}
+
+	IntTree_node *block = IntTree_build_from_sorted(&tree, values, 70000);
+	assert(block);
+	check_tree(&tree);
+	assert(height(tree.root) == 17); // perfectly balanced: ceil(log2(70001))
+
+	assert(IntTree_count_range(&tree, 10, 20) == 5);  // 10 12 14 16 18
+	assert(IntTree_count_range(&tree, 11, 21) == 5);  // 12 .. 20
+	assert(IntTree_count_range(&tree, -5, 1) == 1);	  // 0
+	assert(IntTree_count_range(&tree, 30, 30) == 0);
+	assert(IntTree_count_range(&tree, 139990, 1 << 30) == 5);
+	long sum = 0;
+	IntTree_visit_range(&tree, 100, 110, sum_values, &sum);
+	assert(sum == 100 + 102 + 104 + 106 + 108);
+
+	// A built tree takes further inserts and erases like any other
+	IntTree_node extra;
+	IntTree_node_init_t(&extra, 7);
+	IntTree_node *inserted = IntTree_insert(&tree, &extra);
+	assert(inserted == &extra);
+	IntTree_erase(&tree, &block[35000]);
+	check_tree(&tree);
+	assert(IntTree_count_range(&tree, 0, 10) == 6);
+	free(block);
+}
+
+// Function to test splitting a tree at a key and joining the halves back.
+void test_btree_split_join() {
+	enum { N = 2000 };
+	static IntTree_node nodes[N];
+	IntTree				tree, right;
+	for (int key = -10; key <= N * 3 + 10; key += 97) {
+		IntTree_init(&tree);
+		for (int i = 0; i < N; ++i) {
+			IntTree_node_init_t(&nodes[i], (i * 7919) % N * 3); // multiples of 3 in scattered order
+			IntTree_insert(&tree, &nodes[i]);
+		}
+		IntTree_split(&tree, key, &right);
+		check_tree(&tree);
+		check_tree(&right);
+		size_t expect_left = key <= 0 ? 0 : key >= N * 3 ? N : (size_t) (key + 2) / 3;
+		assert(tree.count == expect_left && right.count == N - expect_left);
+		IntTree_node *last = IntTree_last(&tree), *first = IntTree_first(&right);
+		assert(!last || last->value < key);
+		assert(!first || first->value >= key);
+
+		IntTree_join(&tree, &right);
+		check_tree(&tree);
+		assert(tree.count == N && right.count == 0 && right.root == NULL);
+		int			  prev = -1;
+		IntTree_node *node;
+		BTREE_FOREACH(IntTree, &tree, node) {
+			assert(node->value == prev + (prev < 0 ? 1 : 3));
+			prev = node->value;
+		}
+	}
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_btree_manual_links();	   // Run hand-linked navigation test
+	test_btree_insert_erase();	   // Run balanced insert and erase test
+	test_btree_bounds();		   // Run bound query test
+	test_btree_traversals();	   // Run traversal order test
+	test_btree_build_and_ranges(); // Run sorted build and range query test
+	test_btree_split_join();	   // Run split and join test
+}
 
-	return 0;
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
 }
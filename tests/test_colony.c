@@ -0,0 +1,159 @@
+#include "test_common.h"
+#include "vector/colony.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Entity {
+	uint32_t id;
+	float	 health;
+} Entity;
+
+DEF_COLONY(Entity, EntityColony)
+DEF_COLONY(int, IntColony)
+
+// Number of elements iteration visits, checking each against `alive` when given
+static size_t count_visited(EntityColony *col, const unsigned char *alive) {
+	size_t	count = 0;
+	Entity *e;
+	COLONY_FOREACH(EntityColony, col, e) {
+		if (alive)
+			assert(alive[e->id]);
+		++count;
+	}
+	// Stepping by element address visits the same elements
+	size_t by_address = 0;
+	for (e = EntityColony_first(col); e; e = EntityColony_next(e))
+		++by_address;
+	assert(by_address == count);
+	return count;
+}
+
+// Function to test insertion across blocks, stable addresses and iteration.
+void test_colony_insert() {
+	EntityColony col;
+	EntityColony_init(&col);
+	assert(EntityColony_first(&col) == NULL);
+
+	enum { N = 20000 }; // several blocks
+	static Entity *where[N];
+	for (uint32_t i = 0; i < N; ++i) {
+		where[i] = EntityColony_insert(&col, (Entity) {i, 1.0f});
+		assert(where[i]);
+	}
+	assert(col.count == N && col.blocks > 1);
+	for (uint32_t i = 0; i < N; ++i)
+		assert(where[i]->id == i); // nothing moved
+
+	// With no erasures, iteration is insertion order
+	uint32_t expect = 0;
+	Entity	*e;
+	COLONY_FOREACH(EntityColony, &col, e) {
+		assert(e->id == expect++);
+	}
+	assert(expect == N);
+	EntityColony_deinit(&col);
+	assert(col.count == 0 && col.first == NULL);
+}
+
+// Function to test that erased slots are skipped, merged into runs and reused before appending.
+void test_colony_erase_reuse() {
+	IntColony col;
+	IntColony_init(&col);
+	int *slot[10];
+	for (int i = 0; i < 10; ++i)
+		slot[i] = IntColony_insert(&col, i);
+
+	// Erase 2, 4, then 3 between them, so the three merge into one run
+	IntColony_erase(&col, slot[2]);
+	IntColony_erase(&col, slot[4]);
+	IntColony_erase(&col, slot[3]);
+	IntColony_erase(&col, slot[0]);
+	IntColony_erase(&col, slot[9]);
+	assert(col.count == 5);
+	int seen[10] = {0}, visited = 0;
+	int *it;
+	COLONY_FOREACH(IntColony, &col, it) {
+		++seen[*it];
+		++visited;
+	}
+	assert(visited == 5);
+	assert(seen[1] && seen[5] && seen[6] && seen[7] && seen[8]);
+	assert(!seen[0] && !seen[2] && !seen[3] && !seen[4] && !seen[9]);
+
+	// New elements land in the erased slots, not past the end
+	for (int i = 0; i < 5; ++i) {
+		int *p = IntColony_insert(&col, 100 + i);
+		assert(p == slot[0] || p == slot[2] || p == slot[3] || p == slot[4] || p == slot[9]);
+	}
+	assert(col.free_blocks == NULL && col.first->high == 10);
+	visited = 0;
+	COLONY_FOREACH(IntColony, &col, it) {
+		++visited;
+	}
+	assert(visited == 10);
+
+	// Erasing everything frees the block
+	for (int i = 0; i < 10; ++i)
+		IntColony_erase(&col, slot[i]);
+	assert(col.count == 0 && col.blocks == 0 && IntColony_first(&col) == NULL);
+	IntColony_deinit(&col);
+}
+
+// Function to test random inserts and erases against a record of live elements.
+void test_colony_random() {
+	enum { N = 30000, STEPS = 200000 };
+	static Entity		*where[N];
+	static unsigned char alive[N];
+	memset(alive, 0, sizeof(alive));
+	EntityColony col;
+	EntityColony_init(&col);
+	size_t live = 0;
+	for (int step = 0; step < STEPS; ++step) {
+		uint32_t id = (uint32_t) (test_rand() % N);
+		if (alive[id]) {
+			assert(where[id]->id == id);
+			EntityColony_erase(&col, where[id]);
+			alive[id] = 0;
+			--live;
+		} else {
+			where[id] = EntityColony_insert(&col, (Entity) {id, 0.5f});
+			assert(where[id]);
+			alive[id] = 1;
+			++live;
+		}
+		assert(col.count == live);
+		if (step % 20000 == 0)
+			assert(count_visited(&col, alive) == live);
+	}
+	assert(count_visited(&col, alive) == live);
+	for (uint32_t id = 0; id < N; ++id) {
+		if (alive[id])
+			assert(where[id]->id == id);
+	}
+
+	// Erase every other survivor; iteration still visits exactly the rest
+	for (uint32_t id = 0; id < N; id += 2) {
+		if (alive[id]) {
+			EntityColony_erase(&col, where[id]);
+			alive[id] = 0;
+			--live;
+		}
+	}
+	assert(count_visited(&col, alive) == live);
+	EntityColony_deinit(&col);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_colony_insert();	   // Run insertion and stability test
+	test_colony_erase_reuse(); // Run erase and slot reuse test
+	test_colony_random();	   // Run randomized test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -0,0 +1,18 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdint.h>
+
+// State of test_rand; every test program starts from the same seed, so a
+// failing run repeats exactly
+static uint64_t test_rng_state = 88172645463325252ull;
+
+// xorshift64 generator, good enough to pick random keys and operations
+static inline uint64_t test_rand(void) {
+	test_rng_state ^= test_rng_state << 13;
+	test_rng_state ^= test_rng_state >> 7;
+	test_rng_state ^= test_rng_state << 17;
+	return test_rng_state;
+}
+
+#endif // TEST_COMMON_H
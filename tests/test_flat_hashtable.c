@@ -0,0 +1,189 @@
+#include "hashtable/flat_hashtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct GridCell {
+	int x;
+	int y;
+} GridCell;
+
+static bool grid_cell_eq(const GridCell *a, const GridCell *b) {
+	return a->x == b->x && a->y == b->y;
+}
+
+// Identity hash: consecutive keys share their high bits, which the table must cope with
+size_t IntMap_hash_key(int key) {
+	return (size_t) key;
+}
+
+size_t CellMap_hash_key(GridCell key) {
+	return (size_t) key.x * 31 + (size_t) key.y;
+}
+
+// Every key in one slot, to exercise long Robin Hood runs
+size_t CollideMap_hash_key(int key) {
+	(void) key;
+	return 42;
+}
+
+DEF_FLAT_HASHTABLE(int, int, IntMap)
+DEF_FLAT_HASHTABLE_EQ(GridCell, int, CellMap, grid_cell_eq)
+DEF_FLAT_HASHTABLE(int, int, CollideMap)
+
+// Function to test insertion, replacement, lookup and deletion.
+void test_flat_hashtable_basic() {
+	IntMap map;
+	bool   ok = IntMap_init(&map, 0);
+	assert(ok);
+	assert(IntMap_get(&map, 1) == NULL);
+	ok = IntMap_delete(&map, 1);
+	assert(!ok);
+
+	ok = IntMap_insert(&map, 1, 100);
+	assert(ok);
+	ok = IntMap_insert(&map, 2, 200);
+	assert(ok);
+	assert(*IntMap_get(&map, 1) == 100);
+	assert(*IntMap_get(&map, 2) == 200);
+
+	// Inserting an existing key replaces its value
+	ok = IntMap_insert(&map, 1, 101);
+	assert(ok);
+	assert(map.count == 2);
+	assert(*IntMap_get(&map, 1) == 101);
+
+	ok = IntMap_delete(&map, 1);
+	assert(ok);
+	ok = IntMap_delete(&map, 1);
+	assert(!ok);
+	assert(IntMap_get(&map, 1) == NULL);
+	assert(*IntMap_get(&map, 2) == 200);
+	assert(map.count == 1);
+	IntMap_deinit(&map);
+}
+
+// Function to test growth and random inserts and deletes against a reference array.
+void test_flat_hashtable_random() {
+	enum { KEYS = 4096 };
+	static int reference[KEYS]; // 0 when absent
+	memset(reference, 0, sizeof(reference));
+
+	IntMap map;
+	bool   ok = IntMap_init(&map, 4);
+	assert(ok);
+	srand(7);
+	for (int round = 0; round < 200000; ++round) {
+		int key = rand() % KEYS;
+		if (rand() % 3) {
+			reference[key] = round + 1;
+			ok = IntMap_insert(&map, key, round + 1);
+			assert(ok);
+		} else {
+			ok = IntMap_delete(&map, key);
+			assert(ok == (reference[key] != 0));
+			reference[key] = 0;
+		}
+	}
+
+	size_t count = 0;
+	for (int key = 0; key < KEYS; ++key) {
+		int *value = IntMap_get(&map, key);
+		assert((value != NULL) == (reference[key] != 0));
+		assert(!value || *value == reference[key]);
+		count += reference[key] != 0;
+	}
+	assert(map.count == count);
+	assert((map.capacity & (map.capacity - 1)) == 0);
+	assert(map.count * FLAT_HASHTABLE_MAX_LOAD_DEN <= map.capacity * FLAT_HASHTABLE_MAX_LOAD_NUM);
+	IntMap_deinit(&map);
+}
+
+// Function to test struct keys compared with a user-supplied equality function.
+void test_flat_hashtable_struct_keys() {
+	CellMap map;
+	bool	ok = CellMap_init(&map, 16);
+	assert(ok);
+	for (int x = 0; x < 50; ++x) {
+		for (int y = 0; y < 50; ++y) {
+			ok = CellMap_insert(&map, (GridCell){x, y}, x * 100 + y);
+			assert(ok);
+		}
+	}
+	assert(map.count == 2500);
+	for (int x = 0; x < 50; ++x) {
+		for (int y = 0; y < 50; ++y) {
+			int *value = CellMap_get(&map, (GridCell){x, y});
+			assert(value != NULL && *value == x * 100 + y);
+		}
+	}
+	assert(CellMap_get(&map, (GridCell){50, 0}) == NULL);
+	ok = CellMap_delete(&map, (GridCell){3, 4});
+	assert(ok);
+	assert(CellMap_get(&map, (GridCell){3, 4}) == NULL);
+	assert(*CellMap_get(&map, (GridCell){4, 3}) == 403);
+	CellMap_deinit(&map);
+}
+
+// Function to test deletion with backward shift when every key collides.
+void test_flat_hashtable_collisions() {
+	CollideMap map;
+	bool	   ok = CollideMap_init(&map, 64);
+	assert(ok);
+	for (int i = 0; i < 40; ++i) {
+		ok = CollideMap_insert(&map, i, i);
+		assert(ok);
+	}
+	for (int i = 0; i < 40; i += 2) {
+		ok = CollideMap_delete(&map, i);
+		assert(ok);
+	}
+	for (int i = 0; i < 40; ++i) {
+		int *value = CollideMap_get(&map, i);
+		assert((value != NULL) == (i % 2 == 1));
+	}
+
+	HtStats stats;
+	CollideMap_stats(&map, &stats);
+	assert(stats.entries == 20);
+	assert(stats.max_chain == 20); // The run is packed back against the home slot
+	assert(stats.avg_probe == 10.5);
+	CollideMap_deinit(&map);
+}
+
+// Function to test the reported probe lengths of a well-spread table.
+void test_flat_hashtable_stats() {
+	IntMap map;
+	bool   ok = IntMap_init(&map, 10000);
+	assert(ok);
+	size_t capacity = map.capacity;
+	for (int i = 0; i < 10000; ++i) {
+		ok = IntMap_insert(&map, i * 4096, i);
+		assert(ok);
+	}
+	assert(map.capacity == capacity); // Reserved up front, no growth
+
+	HtStats stats;
+	IntMap_stats(&map, &stats);
+	assert(stats.entries == 10000);
+	assert(stats.buckets == capacity);
+	assert(stats.load_factor <= 0.875);
+	assert(stats.avg_probe < 3.0);
+	assert(stats.bytes == capacity * sizeof(IntMap_slot));
+	IntMap_deinit(&map);
+}
+
+// Function that runs all the test cases for the flat hash table.
+void run_tests() {
+	test_flat_hashtable_basic();	   // Run insert/lookup/delete test
+	test_flat_hashtable_random();	   // Run randomized test
+	test_flat_hashtable_struct_keys(); // Run struct key test
+	test_flat_hashtable_collisions();  // Run colliding key test
+	test_flat_hashtable_stats();	   // Run probe length test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -1,6 +1,10 @@
+#include "hashtable/hash64.h"
 #include "hashtable/hashtable.h"
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 // Structure definition for the test data type
 struct test_t {
@@ -93,11 +97,660 @@ void test_hashtable_deletion() {
 	free(map);			  // Free allocated memory
 }
 
+// Function to test the flat (open-addressing) mode through the regular API.
+// Inserts enough keys to force several resizes, then checks lookups, updates
+// and deletions, including reuse of deleted slots.
+void test_hashtable_flat_operations() {
+	HtTable *map = malloc(sizeof(HtTable));
+	assert(map != NULL);
+	ht_init_table_flat(map, 4);
+	assert(map->mode == HT_MODE_FLAT);
+
+	static int values[1000];
+	char	   key[32];
+
+	// Insert more keys than the initial capacity to trigger growth
+	for (int i = 0; i < 1000; ++i) {
+		values[i] = i;
+		snprintf(key, sizeof(key), "entity_%d", i);
+		bool ok = ht_emplace(map, key, &values[i]);
+		assert(ok);
+	}
+	assert(map->element_count == 1000);
+	assert(map->bucket_count % HT_GROUP_WIDTH == 0);
+
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "entity_%d", i);
+		assert(ht_search(map, key) == &values[i]);
+		assert(ht_has(map, key));
+	}
+	assert(ht_search(map, "missing") == NULL);
+	assert(!ht_has(map, "missing"));
+
+	// Updating an existing key must not add an entry
+	ht_emplace(map, "entity_7", &values[8]);
+	assert(map->element_count == 1000);
+	assert(ht_search(map, "entity_7") == &values[8]);
+
+	// Delete every other key, then make sure the rest are still reachable
+	for (int i = 0; i < 1000; i += 2) {
+		snprintf(key, sizeof(key), "entity_%d", i);
+		bool ok = ht_delete(map, key);
+		assert(ok);
+		ok = ht_delete(map, key);
+		assert(!ok);
+	}
+	assert(map->element_count == 500);
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "entity_%d", i);
+		assert(ht_has(map, key) == (i % 2 == 1));
+	}
+
+	// Churn through inserts and deletes so deleted slots get reused
+	for (int round = 0; round < 20; ++round) {
+		for (int i = 0; i < 1000; i += 2) {
+			snprintf(key, sizeof(key), "entity_%d", i);
+			bool ok = ht_emplace(map, key, &values[i]);
+			assert(ok);
+		}
+		for (int i = 0; i < 1000; i += 2) {
+			snprintf(key, sizeof(key), "entity_%d", i);
+			bool ok = ht_delete(map, key);
+			assert(ok);
+		}
+	}
+	assert(map->element_count == 500);
+	assert(ht_search_s(map, "entity_999", 10) == &values[999]);
+
+	ht_deinit_table(map);
+	free(map);
+}
+
+// Function to test automatic incremental growth of a chained table, plus the
+// explicit ht_reserve and ht_shrink_to_fit entry points in both modes.
+void test_hashtable_rehash() {
+	HtTable *map = malloc(sizeof(HtTable));
+	assert(map != NULL);
+	ht_init_table(map, 4);
+
+	static int values[1000];
+	char	   key[32];
+	bool	   saw_rehash = false;
+
+	// Every key inserted so far must stay reachable while buckets migrate
+	for (int i = 0; i < 1000; ++i) {
+		values[i] = i;
+		snprintf(key, sizeof(key), "asset_%d", i);
+		bool ok = ht_emplace(map, key, &values[i]);
+		assert(ok);
+		saw_rehash |= map->rehash_buckets != NULL;
+		for (int j = 0; j <= i; j += 37) {
+			snprintf(key, sizeof(key), "asset_%d", j);
+			assert(ht_search(map, key) == &values[j]);
+		}
+	}
+	assert(saw_rehash);
+	assert(map->element_count == 1000);
+
+	// Finish any migration still in progress
+	while (ht_rehash_step(map, 16)) {
+	}
+	assert(map->rehash_buckets == NULL);
+	assert(map->bucket_count >= 1000);
+
+	// Reserving completes immediately
+	bool ok = ht_reserve(map, 5000);
+	assert(ok);
+	assert(map->rehash_buckets == NULL);
+	assert(map->bucket_count >= 5000);
+
+	for (int i = 10; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "asset_%d", i);
+		ok = ht_delete(map, key);
+		assert(ok);
+	}
+	ok = ht_shrink_to_fit(map);
+	assert(ok);
+	assert(map->bucket_count == 10);
+	for (int i = 0; i < 10; ++i) {
+		snprintf(key, sizeof(key), "asset_%d", i);
+		assert(ht_search(map, key) == &values[i]);
+	}
+	ht_deinit_table(map);
+
+	// Flat tables resize in one go
+	ht_init_table_flat(map, 4);
+	ok = ht_reserve(map, 1000);
+	assert(ok);
+	unsigned reserved = map->bucket_count;
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "asset_%d", i);
+		ok = ht_emplace(map, key, &values[i]);
+		assert(ok);
+	}
+	assert(map->bucket_count == reserved); // No growth past the reservation
+	for (int i = 10; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "asset_%d", i);
+		ok = ht_delete(map, key);
+		assert(ok);
+	}
+	ok = ht_shrink_to_fit(map);
+	assert(ok);
+	assert(map->bucket_count == HT_GROUP_WIDTH);
+	assert(ht_search(map, "asset_9") == &values[9]);
+
+	ht_deinit_table(map);
+	free(map);
+}
+
+// Function to test that sized keys are matched by exact length and bytes, so
+// keys sharing a prefix and binary keys with embedded nulls stay distinct.
+void test_hashtable_sized_keys() {
+	HtTable *map = malloc(sizeof(HtTable));
+	assert(map != NULL);
+
+	for (int mode = 0; mode < 2; ++mode) {
+		if (mode == 0) {
+			ht_init_table(map, 4);
+		} else {
+			ht_init_table_flat(map, 4);
+		}
+
+		struct test_t short_key = {1, 2};
+		struct test_t long_key = {3, 4};
+		struct test_t bin_a = {5, 6};
+		struct test_t bin_b = {7, 8};
+
+		// Keys sharing a prefix
+		ht_emplace(map, "Test", &short_key);
+		ht_emplace(map, "Test1", &long_key);
+		assert(map->element_count == 2);
+		assert(ht_search_s(map, "Test1", 4) == &short_key);
+		assert(ht_search_s(map, "Test1", 5) == &long_key);
+		assert(ht_search(map, "Test") == &short_key);
+		assert(ht_search_s(map, "Tes", 3) == NULL);
+
+		// Binary keys that only differ after an embedded null
+		const char key_a[4] = {'i', 'd', '\0', 'a'};
+		const char key_b[4] = {'i', 'd', '\0', 'b'};
+		ht_emplace_s(map, (void *) key_a, sizeof(key_a), &bin_a);
+		ht_emplace_s(map, (void *) key_b, sizeof(key_b), &bin_b);
+		assert(map->element_count == 4);
+		assert(ht_search_s(map, (void *) key_a, sizeof(key_a)) == &bin_a);
+		assert(ht_search_s(map, (void *) key_b, sizeof(key_b)) == &bin_b);
+		assert(ht_has_s(map, (void *) key_a, sizeof(key_a)));
+		assert(!ht_has(map, "id")); // Not the same key as its first two bytes
+
+		bool ok = ht_delete_s(map, (void *) key_a, sizeof(key_a));
+		assert(ok);
+		assert(!ht_has_s(map, (void *) key_a, sizeof(key_a)));
+		assert(ht_search_s(map, (void *) key_b, sizeof(key_b)) == &bin_b);
+		ok = ht_delete(map, "Test");
+		assert(ok);
+		assert(ht_search(map, "Test1") == &long_key);
+		assert(map->element_count == 2);
+
+		ht_deinit_table(map);
+	}
+	free(map);
+}
+
+// Inserts `count` keys of `keylen` bytes into a fresh table and reports the
+// bytes allocated per entry and the insert throughput.
+static double measure_inserts(HtMode mode, size_t keylen, unsigned count, double *bytes_per_entry) {
+	HtTable tab;
+	char	key[64];
+
+	if (mode == HT_MODE_FLAT) {
+		ht_init_table_flat(&tab, count);
+	} else {
+		ht_init_table(&tab, count);
+	}
+
+	clock_t start = clock();
+	for (unsigned i = 0; i < count; ++i) {
+		// Left-pad the key out to exactly keylen bytes
+		memset(key, '_', keylen);
+		char digits[16];
+		int	 len = snprintf(digits, sizeof(digits), "c%u", i);
+		memcpy(key + keylen - (size_t) len, digits, (size_t) len);
+		ht_emplace_s(&tab, key, keylen, NULL);
+	}
+	double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	assert(tab.element_count == count);
+	*bytes_per_entry = (double) ht_memory_usage(&tab) / count;
+	ht_deinit_table(&tab);
+	return seconds > 0 ? count / seconds : 0;
+}
+
+// Function to test inline storage of short keys, including the boundary where
+// keys move to the heap, and to compare memory per entry and insert throughput
+// between inline and heap-stored keys.
+void test_hashtable_inline_keys() {
+	HtTable *map = malloc(sizeof(HtTable));
+	assert(map != NULL);
+	ht_init_table(map, 8);
+
+	char		  inline_key[HT_INLINE_KEY_SIZE];
+	char		  heap_key[HT_INLINE_KEY_SIZE + 1];
+	struct test_t test1 = {1, 2};
+	struct test_t test2 = {3, 4};
+
+	// The longest inline key and the shortest heap key
+	memset(inline_key, 'k', sizeof(inline_key) - 1);
+	inline_key[sizeof(inline_key) - 1] = '\0';
+	memset(heap_key, 'k', sizeof(heap_key) - 1);
+	heap_key[sizeof(heap_key) - 1] = '\0';
+
+	ht_emplace(map, inline_key, &test1);
+	ht_emplace(map, heap_key, &test2);
+	assert(ht_search(map, inline_key) == &test1);
+	assert(ht_search(map, heap_key) == &test2);
+
+	// A single short-key entry costs one node and nothing else
+	size_t before = ht_memory_usage(map);
+	ht_emplace(map, "Transform", &test1);
+	assert(ht_memory_usage(map) - before == sizeof(HtNode));
+	ht_deinit_table(map);
+	free(map);
+
+	for (int mode = 0; mode < 2; ++mode) {
+		double short_bytes, long_bytes;
+		double short_rate = measure_inserts((HtMode) mode, 12, 20000, &short_bytes);
+		double long_rate = measure_inserts((HtMode) mode, 40, 20000, &long_bytes);
+
+		printf("%s: 12-byte keys %.1f B/entry %.0f inserts/s, 40-byte keys %.1f B/entry %.0f inserts/s\n",
+			   mode == HT_MODE_FLAT ? "flat" : "chained", short_bytes, short_rate, long_bytes, long_rate);
+
+		// Heap-stored keys pay for their copy on top of the entry itself
+		assert(long_bytes - short_bytes >= 41);
+	}
+}
+
+// Allocator that counts live allocations, to check that every block a table
+// allocates goes through its allocator and comes back
+static void *counting_alloc(void *ctx, size_t size) {
+	++*(int *) ctx;
+	return malloc(size);
+}
+
+static void counting_free(void *ctx, void *p, size_t size) {
+	(void) size;
+	--*(int *) ctx;
+	free(p);
+}
+
+// Function to test tables with custom allocators: a counting allocator must
+// see balanced allocations, and a pool must back a table through growth,
+// deletion and a bulk deinit.
+void test_hashtable_allocators() {
+	HtTable tab;
+	char	key[64];
+	int		live = 0;
+	HtPool	pool;
+
+	HtAllocator counting = {counting_alloc, counting_free, NULL, &live};
+	HtAllocator pooled = ht_pool_allocator(&pool);
+
+	for (int mode = 0; mode < 2; ++mode) {
+		for (int use_pool = 0; use_pool < 2; ++use_pool) {
+			const HtAllocator *allocator = use_pool ? &pooled : &counting;
+			ht_pool_init(&pool);
+
+			if (mode == HT_MODE_FLAT) {
+				ht_init_table_flat_with_allocator(&tab, 4, allocator);
+			} else {
+				ht_init_table_with_allocator(&tab, 4, allocator);
+			}
+
+			// Mix inline and heap keys, force growth, then delete some
+			for (int i = 0; i < 2000; ++i) {
+				snprintf(key, sizeof(key), i % 2 ? "k%d" : "a_rather_long_asset_path_%d.png", i);
+				bool ok = ht_emplace(&tab, key, (void *) (size_t) (i + 1));
+				assert(ok);
+			}
+			for (int i = 0; i < 2000; i += 3) {
+				snprintf(key, sizeof(key), i % 2 ? "k%d" : "a_rather_long_asset_path_%d.png", i);
+				bool ok = ht_delete(&tab, key);
+				assert(ok);
+			}
+			for (int i = 0; i < 2000; ++i) {
+				snprintf(key, sizeof(key), i % 2 ? "k%d" : "a_rather_long_asset_path_%d.png", i);
+				void *expected = i % 3 ? (void *) (size_t) (i + 1) : NULL;
+				assert(ht_search(&tab, key) == expected);
+			}
+
+			ht_deinit_table(&tab);
+			assert(live == 0);
+			if (use_pool) {
+				// The table already released the pool
+				assert(pool.nodes.chunks == NULL && pool.small.blocks == NULL && pool.large == NULL);
+			}
+			ht_pool_deinit(&pool);
+		}
+	}
+}
+
+// Allocator that fails while the int behind ctx is non-zero
+static void *refusing_alloc(void *ctx, size_t size) {
+	return *(int *) ctx ? NULL : malloc(size);
+}
+
+static void refusing_free(void *ctx, void *p, size_t size) {
+	(void) ctx;
+	(void) size;
+	free(p);
+}
+
+// Function to test a flat table whose slot array could not be allocated: it
+// must read as empty, and the first insert must allocate the slots instead.
+void test_hashtable_flat_alloc_failure() {
+	HtTable		tab;
+	int			refuse = 1;
+	HtAllocator refusing = {refusing_alloc, refusing_free, NULL, &refuse};
+
+	ht_init_table_flat_with_allocator(&tab, 100, &refusing);
+	assert(tab.bucket_count == 0 && tab.element_count == 0);
+	assert(ht_search(&tab, "key") == NULL && !ht_has(&tab, "key"));
+	bool deleted = ht_delete(&tab, "key");
+	assert(!deleted);
+
+	char *keys[2] = {"key", "other"};
+	void *values[2] = {&tab, &tab};
+	ht_search_batch(&tab, keys, 2, values);
+	assert(values[0] == NULL && values[1] == NULL);
+
+	bool ok = ht_emplace(&tab, "key", &refuse);
+	assert(!ok && tab.element_count == 0);
+
+	refuse = 0;
+	ok = ht_emplace(&tab, "key", &refuse);
+	assert(ok && tab.bucket_count > 0);
+	assert(ht_search(&tab, "key") == &refuse);
+	ht_deinit_table(&tab);
+}
+
+// Function to test the 64-bit hash family and selecting a hash per table.
+// Every length around the word and stripe boundaries is checked so the short
+// and tail reads of each function are covered.
+void test_hashtable_hash_fns() {
+	unsigned char buf[600];
+	for (unsigned i = 0; i < sizeof(buf); ++i) {
+		buf[i] = (unsigned char) (i * 131u + 7u);
+	}
+
+	for (size_t len = 0; len <= 520; ++len) {
+		// Deterministic, and independent of what follows the key in memory
+		unsigned char copy[600];
+		memcpy(copy, buf, len);
+		memset(copy + len, 0xee, sizeof(copy) - len);
+		assert(hash64_wy(buf, len, 1) == hash64_wy(copy, len, 1));
+		assert(hash64_xxh(buf, len, 1) == hash64_xxh(copy, len, 1));
+		assert(hash64_crc(buf, len, 1) == hash64_crc(copy, len, 1));
+
+		// The seed and every input byte change the result
+		assert(hash64_wy(buf, len, 1) != hash64_wy(buf, len, 2));
+		assert(hash64_xxh(buf, len, 1) != hash64_xxh(buf, len, 2));
+		if (len > 0) {
+			copy[len - 1] ^= 1;
+			assert(hash64_wy(buf, len, 1) != hash64_wy(copy, len, 1));
+			assert(hash64_xxh(buf, len, 1) != hash64_xxh(copy, len, 1));
+			assert(hash64_crc(buf, len, 1) != hash64_crc(copy, len, 1));
+			copy[0] ^= 2;
+			assert(hash64_wy(buf, len, 1) != hash64_wy(copy, len, 1));
+			assert(hash64_xxh(buf, len, 1) != hash64_xxh(copy, len, 1));
+		}
+	}
+
+	// The SIMD stripe matches the scalar definition
+	uint64_t acc_simd[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	uint64_t acc_scalar[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	for (unsigned s = 0; s + HASH64_STRIPE <= sizeof(buf); s += HASH64_STRIPE) {
+		hash64_accumulate(acc_simd, buf + s, 42);
+		hash64_accumulate_scalar(acc_scalar, buf + s, 42);
+	}
+	assert(memcmp(acc_simd, acc_scalar, sizeof(acc_simd)) == 0);
+
+	// Every selectable hash works in both modes
+	HtHashFn fns[] = {ht_hash_wy, ht_hash_xxh, ht_hash_crc, ht_hash_fnv1a, ht_hash_shift_add};
+	for (unsigned f = 0; f < sizeof(fns) / sizeof(fns[0]); ++f) {
+		for (int flat = 0; flat < 2; ++flat) {
+			HtTable tab;
+			if (flat) {
+				ht_init_table_flat(&tab, 4);
+			} else {
+				ht_init_table(&tab, 4);
+			}
+			assert(tab.hash_fn == ht_hash_wy); // Default
+			bool ok = ht_set_hash_fn(&tab, fns[f], 0x1234);
+			assert(ok);
+
+			char key[32];
+			for (int i = 0; i < 500; ++i) {
+				snprintf(key, sizeof(key), "asset/%d.png", i);
+				ok = ht_emplace(&tab, key, (void *) (size_t) (i + 1));
+				assert(ok);
+			}
+			ok = ht_set_hash_fn(&tab, ht_hash_wy, 0); // Entries keep their hashes
+			assert(!ok);
+			assert(tab.hash_fn == fns[f]);
+			for (int i = 0; i < 500; ++i) {
+				snprintf(key, sizeof(key), "asset/%d.png", i);
+				assert(ht_search(&tab, key) == (void *) (size_t) (i + 1));
+			}
+			assert(ht_search(&tab, "asset/500.png") == NULL);
+			for (int i = 0; i < 500; i += 2) {
+				snprintf(key, sizeof(key), "asset/%d.png", i);
+				ok = ht_delete(&tab, key);
+				assert(ok);
+			}
+			assert(tab.element_count == 250);
+			ht_deinit_table(&tab);
+		}
+	}
+}
+
+// Function to test batched lookups in both modes, with hits and misses mixed,
+// batch sizes that are not a multiple of the internal batch, and lookups that
+// run while a chained table is still rehashing.
+void test_hashtable_search_batch() {
+	for (int flat = 0; flat < 2; ++flat) {
+		HtTable tab;
+		if (flat) {
+			ht_init_table_flat(&tab, 4);
+		} else {
+			ht_init_table(&tab, 4);
+		}
+
+		static char keys[300][40];
+		char	   *key_ptrs[300];
+		for (int i = 0; i < 300; ++i) {
+			// Every third key is absent, and some keys are too long to be inlined
+			snprintf(keys[i], sizeof(keys[i]), i % 7 ? "key_%d" : "a_rather_long_key_name_%d", i);
+			key_ptrs[i] = keys[i];
+			if (i % 3) {
+				bool ok = ht_emplace(&tab, keys[i], &keys[i]);
+				assert(ok);
+			}
+		}
+
+		void *values[300];
+		for (size_t n = 0; n <= 300; n += 37) {
+			ht_search_batch(&tab, key_ptrs, n, values);
+			for (size_t i = 0; i < n; ++i) {
+				assert(values[i] == ht_search(&tab, keys[i]));
+				assert(values[i] == (i % 3 ? (void *) &keys[i] : NULL));
+			}
+		}
+
+		size_t keylens[300];
+		for (int i = 0; i < 300; ++i) {
+			keylens[i] = 3; // Prefix of "key_..."; never stored, so all miss
+		}
+		ht_search_batch_s(&tab, (void *const *) key_ptrs, keylens, 300, values);
+		for (int i = 0; i < 300; ++i) {
+			assert(values[i] == NULL);
+		}
+		ht_deinit_table(&tab);
+	}
+}
+
+// Function to test the stats report in both modes, and that it exposes a weak
+// hash: under shift-add, keys that differ only in early characters collide.
+void test_hashtable_stats() {
+	for (int flat = 0; flat < 2; ++flat) {
+		size_t max_chain[2];
+		for (int weak = 0; weak < 2; ++weak) {
+			HtTable tab;
+			if (flat) {
+				ht_init_table_flat(&tab, 1024);
+			} else {
+				ht_init_table(&tab, 1024);
+			}
+			if (weak) {
+				bool ok = ht_set_hash_fn(&tab, ht_hash_shift_add, 0);
+				assert(ok);
+			}
+
+			char key[32];
+			for (int i = 0; i < 1000; ++i) {
+				snprintf(key, sizeof(key), "%03d_localisation_key", i);
+				bool ok = ht_emplace(&tab, key, &tab);
+				assert(ok);
+			}
+			assert(ht_search(&tab, "000_localisation_key") == &tab);
+			assert(ht_search(&tab, "missing") == NULL);
+			assert(!ht_has(&tab, "missing"));
+
+			HtStats stats;
+			ht_stats(&tab, &stats);
+			assert(stats.entries == 1000);
+			assert(stats.buckets == tab.bucket_count);
+			assert(stats.load_factor == 1000.0 / tab.bucket_count);
+			assert(stats.bytes == ht_memory_usage(&tab));
+			assert(stats.bytes_per_entry == (double) stats.bytes / 1000);
+			assert(stats.avg_probe >= 1.0 && stats.max_chain >= 1);
+
+			// Chained histograms count buckets, flat ones count entries
+			size_t total = 0;
+			for (int i = 0; i < HT_STATS_HISTOGRAM; ++i) {
+				total += stats.histogram[i];
+			}
+			assert(total == (flat ? 1000 : stats.buckets));
+			max_chain[weak] = stats.max_chain;
+
+#ifdef HT_ENABLE_STATS
+			assert(stats.hits == 1 && stats.misses == 2);
+			ht_stats_reset(&tab);
+			ht_stats(&tab, &stats);
+#endif
+			assert(stats.hits == 0 && stats.misses == 0);
+			ht_deinit_table(&tab);
+		}
+		assert(max_chain[1] > max_chain[0]);
+	}
+}
+
+// Function to test an attached Bloom filter in both modes: results must not
+// change while the filter grows with the table and is rebuilt after deletes.
+void test_hashtable_bloom() {
+	for (int flat = 0; flat < 2; ++flat) {
+		HtTable tab;
+		if (flat) {
+			ht_init_table_flat(&tab, 8);
+		} else {
+			ht_init_table(&tab, 8);
+		}
+		static char keys[2000][32];
+		static bool present[2000];
+		for (int i = 0; i < 2000; ++i) {
+			snprintf(keys[i], sizeof(keys[i]), i % 9 ? "component_%d" : "a_long_component_name_%d", i);
+			present[i] = i < 100;
+			if (present[i]) {
+				bool ok = ht_emplace(&tab, keys[i], &keys[i]);
+				assert(ok);
+			}
+		}
+		bool ok = ht_attach_bloom(&tab, 0);
+		assert(ok);
+		assert(tab.bloom->count == 100);
+		size_t bloom_bytes = ht_memory_usage(&tab);
+		ht_detach_bloom(&tab);
+		assert(ht_memory_usage(&tab) < bloom_bytes);
+		ok = ht_attach_bloom(&tab, 0); // Detaching and attaching again rebuilds the filter
+		assert(ok);
+
+		srand(3);
+		for (int round = 0; round < 20000; ++round) {
+			int i = rand() % 2000;
+			switch (rand() % 4) {
+			case 0:
+				ok = ht_emplace(&tab, keys[i], &keys[i]);
+				assert(ok);
+				present[i] = true;
+				break;
+			case 1:
+				ok = ht_delete(&tab, keys[i]);
+				assert(ok == present[i]);
+				present[i] = false;
+				break;
+			default:
+				assert(ht_search(&tab, keys[i]) == (present[i] ? (void *) &keys[i] : NULL));
+				assert(ht_has(&tab, keys[i]) == present[i]);
+			}
+		}
+
+		char *key_ptrs[2000];
+		void *values[2000];
+		size_t count = 0;
+		for (int i = 0; i < 2000; ++i) {
+			key_ptrs[i] = keys[i];
+			count += present[i];
+		}
+		assert(tab.element_count == count);
+		assert(tab.bloom->capacity >= count); // Grew with the table
+		ht_search_batch(&tab, key_ptrs, 2000, values);
+		for (int i = 0; i < 2000; ++i) {
+			assert(values[i] == (present[i] ? (void *) &keys[i] : NULL));
+		}
+
+		// Keys that were never inserted are mostly turned away by the filter
+		size_t passed = 0;
+		char   key[32];
+		for (int i = 0; i < 1000; ++i) {
+			snprintf(key, sizeof(key), "missing_%d", i);
+			passed += ht_bloom_may_contain_hash(tab.bloom, tab.hash_fn(key, strlen(key), tab.hash_seed));
+			assert(ht_search(&tab, key) == NULL);
+		}
+		assert(passed < 50);
+
+		// Deleting everything leaves a rebuilt, near-empty filter
+		for (int i = 0; i < 2000; ++i) {
+			ht_delete(&tab, keys[i]);
+		}
+		assert(tab.element_count == 0);
+		assert(tab.bloom->capacity == HT_BLOOM_MIN_CAPACITY);
+		ht_deinit_table(&tab);
+		assert(tab.bloom == NULL);
+	}
+}
+
 // Function that runs all the test cases for the hash table operations.
 void run_tests() {
 	test_hashtable_basic_operations();	   // Run basic operations test
 	test_hashtable_duplicate_insertions(); // Run duplicate insertions test
 	test_hashtable_deletion();			   // Run deletion test
+	test_hashtable_flat_operations();	   // Run flat mode test
+	test_hashtable_rehash();			   // Run growth and shrink test
+	test_hashtable_sized_keys();		   // Run sized key test
+	test_hashtable_inline_keys();		   // Run inline key test
+	test_hashtable_allocators();		   // Run allocator test
+	test_hashtable_flat_alloc_failure();   // Run failed flat allocation test
+	test_hashtable_hash_fns();			   // Run hash function test
+	test_hashtable_search_batch();		   // Run batched lookup test
+	test_hashtable_stats();				   // Run stats test
+	test_hashtable_bloom();				   // Run Bloom filter test
 }
 
 // Entry point of the program, which executes all the test cases.
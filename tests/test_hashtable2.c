@@ -34,6 +34,56 @@ int main() {
     val2 = IntHashTable_get(&ht, 2);
     assert(val2 != NULL && *val2 == 200);
 
+    // Test batched retrieval, with more keys than one prefetch batch
+    for (int i = 10; i < 50; ++i) {
+        IntHashTable_insert(&ht, i, i * 10);
+    }
+    int keys[60];
+    int *vals[60];
+    for (int i = 0; i < 60; ++i) {
+        keys[i] = i;
+    }
+    IntHashTable_get_batch(&ht, keys, 60, vals);
+    for (int i = 0; i < 60; ++i) {
+        assert(vals[i] == IntHashTable_get(&ht, i));
+        assert(i == 2 || (i >= 10 && i < 50) ? vals[i] && *vals[i] == (i == 2 ? 200 : i * 10) : !vals[i]);
+    }
+
+    // Test the stats report: 41 entries over 10 buckets
+    HtStats stats;
+    IntHashTable_stats(&ht, &stats);
+    assert(stats.entries == 41 && stats.buckets == 10);
+    assert(stats.load_factor == 4.1);
+    assert(stats.max_chain == 5);
+#ifdef HT_ENABLE_STATS
+    assert(stats.hits > 0 && stats.misses > 0);
+#else
+    assert(stats.hits == 0 && stats.misses == 0);
+#endif
+
+    // Test an attached Bloom filter: same results, rebuilt after deletes
+    bool ok = IntHashTable_attach_bloom(&ht, 0);
+    assert(ok);
+    for (int i = 50; i < 200; ++i) {
+        IntHashTable_insert(&ht, i, i * 10);
+    }
+    for (int i = 10; i < 150; ++i) {
+        IntHashTable_delete(&ht, i);
+    }
+    assert(ht.bloom->count < 100); // Rebuilt from the remaining entries
+    for (int i = 0; i < 300; ++i) {
+        int *val = IntHashTable_get(&ht, i);
+        assert(i == 2 || (i >= 150 && i < 200) ? val && *val == (i == 2 ? 200 : i * 10) : !val);
+    }
+    IntHashTable_get_batch(&ht, keys, 60, vals);
+    for (int i = 0; i < 60; ++i) {
+        assert(vals[i] == IntHashTable_get(&ht, i));
+    }
+    IntHashTable_stats(&ht, &stats);
+    assert(stats.entries == 51);
+    assert(stats.bytes == sizeof(IntHashTable_node *) * 10 + sizeof(IntHashTable_node) * 51 +
+                              ht_bloom_memory_usage(ht.bloom));
+
     // Test deinitialization
     IntHashTable_deinit(&ht);
 
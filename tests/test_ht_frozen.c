@@ -0,0 +1,214 @@
+#include "hashtable/ht_frozen.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FROZEN_PATH "test_ht_frozen.bin"
+
+// Stores each entry's value pointer as the int it points to
+static void encode_int(void *ctx, const char *key, size_t keylen, void *value, void *out) {
+	(void) key;
+	(void) keylen;
+	++*(int *) ctx;
+	memcpy(out, value, sizeof(int));
+}
+
+static int frozen_int(const HtFrozen *frozen, const char *key) {
+	const void *value = ht_frozen_search(frozen, key);
+	assert(value != NULL);
+	int result;
+	memcpy(&result, value, sizeof(result));
+	return result;
+}
+
+// Function to test freezing tables of both modes, with short, long and binary
+// keys, and looking every key up in the image.
+void test_ht_frozen_freeze() {
+	static int values[5000];
+	for (int flat = 0; flat < 2; ++flat) {
+		HtTable tab;
+		if (flat) {
+			ht_init_table_flat(&tab, 16);
+		} else {
+			ht_init_table(&tab, 16);
+		}
+
+		char key[64];
+		for (int i = 0; i < 5000; ++i) {
+			values[i] = i * 3;
+			snprintf(key, sizeof(key), i % 5 ? "asset_%d" : "assets/textures/a_much_longer_name_%d.png", i);
+			bool ok = ht_emplace(&tab, key, &values[i]);
+			assert(ok);
+		}
+		const char bin[3] = {'x', '\0', 'y'};
+		bool	   ok = ht_emplace_s(&tab, (void *) bin, 3, &values[0]);
+		assert(ok);
+
+		void  *image;
+		size_t size;
+		int	   encoded = 0;
+		ok = ht_freeze(&tab, sizeof(int), encode_int, &encoded, &image, &size);
+		assert(ok);
+		assert(encoded == 5001);
+
+		HtFrozen frozen;
+		ok = ht_frozen_open_memory(&frozen, image, size);
+		assert(ok);
+		assert(frozen.header->count == 5001);
+		for (int i = 0; i < 5000; ++i) {
+			snprintf(key, sizeof(key), i % 5 ? "asset_%d" : "assets/textures/a_much_longer_name_%d.png", i);
+			assert(frozen_int(&frozen, key) == i * 3);
+		}
+		assert(ht_frozen_search_s(&frozen, bin, 3) != NULL);
+		assert(ht_frozen_search_s(&frozen, bin, 2) == NULL);
+
+		// Every absent key lands on some slot and must be rejected there
+		for (int i = 5000; i < 20000; ++i) {
+			snprintf(key, sizeof(key), "asset_%d", i);
+			assert(ht_frozen_search(&frozen, key) == NULL);
+		}
+		assert(ht_frozen_search(&frozen, "") == NULL);
+
+		ht_frozen_close(&frozen); // Borrowed memory is left alone
+		htfree(image);
+		ht_deinit_table(&tab);
+	}
+}
+
+// Function to test writing an image to a file, mapping it back and copying
+// values without an encoder.
+void test_ht_frozen_file() {
+	static double values[100];
+	HtTable		  tab;
+	ht_init_table_flat(&tab, 100);
+	char key[32];
+	for (int i = 0; i < 100; ++i) {
+		values[i] = i * 0.5;
+		snprintf(key, sizeof(key), "shader_%d", i);
+		bool ok = ht_emplace(&tab, key, &values[i]);
+		assert(ok);
+	}
+	bool ok = ht_freeze_to_file(&tab, sizeof(double), NULL, NULL, FROZEN_PATH);
+	assert(ok);
+	ht_deinit_table(&tab);
+
+	HtFrozen frozen;
+	ok = ht_frozen_open(&frozen, FROZEN_PATH);
+	assert(ok);
+	for (int i = 0; i < 100; ++i) {
+		snprintf(key, sizeof(key), "shader_%d", i);
+		const double *value = ht_frozen_search(&frozen, key);
+		assert(value != NULL && *value == i * 0.5); // Values are 8-byte aligned
+	}
+	assert(ht_frozen_search(&frozen, "shader_100") == NULL);
+	ht_frozen_close(&frozen);
+	remove(FROZEN_PATH);
+
+	// Files that are not images are refused
+	FILE *file = fopen(FROZEN_PATH, "wb");
+	assert(file != NULL);
+	fputs("not a frozen table, just some text long enough to hold a header", file);
+	fclose(file);
+	ok = ht_frozen_open(&frozen, FROZEN_PATH);
+	assert(!ok);
+	remove(FROZEN_PATH);
+	ok = ht_frozen_open(&frozen, FROZEN_PATH);
+	assert(!ok);
+}
+
+// Function to test freezing empty and single-entry tables.
+void test_ht_frozen_small() {
+	for (int count = 0; count < 3; ++count) {
+		HtTable tab;
+		ht_init_table(&tab, 1);
+		int one = 1;
+		for (int i = 0; i < count; ++i) {
+			bool ok = ht_emplace(&tab, i ? "b" : "a", &one);
+			assert(ok);
+		}
+
+		void  *image;
+		size_t size;
+		bool   ok = ht_freeze(&tab, 0, NULL, NULL, &image, &size);
+		assert(ok);
+		HtFrozen frozen;
+		ok = ht_frozen_open_memory(&frozen, image, size);
+		assert(ok);
+		assert((ht_frozen_search(&frozen, "a") != NULL) == (count >= 1));
+		assert((ht_frozen_search(&frozen, "b") != NULL) == (count >= 2));
+		assert(ht_frozen_search(&frozen, "c") == NULL);
+		htfree(image);
+		ht_deinit_table(&tab);
+	}
+}
+
+// Function to test that images whose regions reach past their end are refused, and that
+// slots pointing outside the key bytes are never followed.
+void test_ht_frozen_corrupt() {
+	static int values[100];
+	HtTable	   tab;
+	ht_init_table(&tab, 100);
+	char key[32];
+	for (int i = 0; i < 100; ++i) {
+		values[i] = i;
+		snprintf(key, sizeof(key), "loot_%d", i);
+		ht_emplace(&tab, key, &values[i]);
+	}
+	void  *image;
+	size_t size;
+	bool   ok = ht_freeze(&tab, sizeof(int), NULL, NULL, &image, &size);
+	assert(ok);
+	ht_deinit_table(&tab);
+
+	HtFrozen	   frozen;
+	HtFrozenHeader header;
+	memcpy(&header, image, sizeof(header));
+	ok = ht_frozen_open_memory(&frozen, image, size - 8); // Truncated
+	assert(!ok);
+
+	// Each region in turn claims more than the image holds
+	uint64_t *fields[] = {&header.bucket_count, &header.count, &header.disp_offset, &header.slots_offset,
+						  &header.values_offset, &header.keys_offset};
+	for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); ++f) {
+		uint64_t saved = *fields[f];
+		uint64_t bad[] = {size + 8, UINT64_MAX / 8, UINT64_MAX - 7};
+		for (size_t b = 0; b < sizeof(bad) / sizeof(bad[0]); ++b) {
+			*fields[f] = bad[b];
+			memcpy(image, &header, sizeof(header));
+			ok = ht_frozen_open_memory(&frozen, image, size);
+			assert(!ok);
+		}
+		*fields[f] = saved;
+	}
+	header.slots_offset += 4; // Misaligned
+	memcpy(image, &header, sizeof(header));
+	ok = ht_frozen_open_memory(&frozen, image, size);
+	assert(!ok);
+	header.slots_offset -= 4;
+
+	// An image cut off after its slots opens, but no lookup reads past the end
+	header.size = header.keys_offset;
+	memcpy(image, &header, sizeof(header));
+	ok = ht_frozen_open_memory(&frozen, image, header.size);
+	assert(ok);
+	for (int i = 0; i < 100; ++i) {
+		snprintf(key, sizeof(key), "loot_%d", i);
+		assert(ht_frozen_search(&frozen, key) == NULL);
+	}
+	htfree(image);
+}
+
+// Function that runs all the test cases for frozen tables.
+void run_tests() {
+	test_ht_frozen_freeze();  // Run freeze and lookup test
+	test_ht_frozen_file();	  // Run file round-trip test
+	test_ht_frozen_small();	  // Run tiny table test
+	test_ht_frozen_corrupt(); // Run corrupt image test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -0,0 +1,105 @@
+#include "hashtable/htalloc.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Function to test that the slab hands out distinct, aligned objects, reuses
+// freed ones first and spans several chunks.
+void test_slab() {
+	HtSlab slab;
+	ht_slab_init(&slab, 40, 8);
+
+	void *objects[100];
+	for (int i = 0; i < 100; ++i) {
+		objects[i] = ht_slab_alloc(&slab);
+		assert(objects[i] != NULL);
+		assert((uintptr_t) objects[i] % sizeof(void *) == 0);
+		memset(objects[i], i, 40); // Must not clobber other objects
+	}
+	for (int i = 0; i < 100; ++i) {
+		assert(((unsigned char *) objects[i])[39] == (unsigned char) i);
+	}
+
+	// The most recently freed object comes back first
+	ht_slab_free(&slab, objects[10]);
+	ht_slab_free(&slab, objects[20]);
+	void *reused = ht_slab_alloc(&slab);
+	assert(reused == objects[20]);
+	reused = ht_slab_alloc(&slab);
+	assert(reused == objects[10]);
+
+	ht_slab_release(&slab);
+	assert(slab.chunks == NULL);
+
+	// Still usable after a release
+	void *fresh = ht_slab_alloc(&slab);
+	assert(fresh != NULL);
+	ht_slab_release(&slab);
+	printf("Passed test_slab.\n");
+}
+
+// Function to test that the arena packs small allocations, keeps them aligned
+// and serves requests larger than a block.
+void test_arena() {
+	HtArena arena;
+	ht_arena_init(&arena, 1024);
+
+	char *a = ht_arena_alloc(&arena, 5);
+	char *b = ht_arena_alloc(&arena, 5);
+	assert(a != NULL && b != NULL && a != b);
+	assert((uintptr_t) b % sizeof(max_align_t) == 0);
+	memcpy(a, "abcd", 5);
+	memcpy(b, "efgh", 5);
+
+	char *big = ht_arena_alloc(&arena, 4096);
+	assert(big != NULL);
+	memset(big, 0x5a, 4096);
+
+	// The oversized block must not have stolen the current block's space
+	char *c = ht_arena_alloc(&arena, 5);
+	assert(c == b + sizeof(max_align_t));
+	assert(strcmp(a, "abcd") == 0 && strcmp(b, "efgh") == 0);
+
+	for (int i = 0; i < 1000; ++i) {
+		char *small = ht_arena_alloc(&arena, 24);
+		assert(small != NULL);
+	}
+
+	ht_arena_release(&arena);
+	assert(arena.blocks == NULL);
+	printf("Passed test_arena.\n");
+}
+
+// Function to test routing through a pool allocator: large blocks can be
+// freed one by one, and a release frees everything left.
+void test_pool() {
+	HtPool		pool;
+	ht_pool_init(&pool);
+	HtAllocator allocator = ht_pool_allocator(&pool);
+
+	void *small = allocator.alloc(allocator.ctx, 32);
+	void *large1 = allocator.alloc(allocator.ctx, 4096);
+	void *large2 = allocator.alloc(allocator.ctx, 8192);
+	assert(small != NULL && large1 != NULL && large2 != NULL);
+	memset(large1, 1, 4096);
+	memset(large2, 2, 8192);
+
+	allocator.free(allocator.ctx, large1, 4096);
+	allocator.free(allocator.ctx, small, 32);
+	allocator.alloc(allocator.ctx, 1024);
+
+	assert(allocator.release != NULL);
+	allocator.release(allocator.ctx);
+	assert(pool.large == NULL);
+
+	ht_pool_deinit(&pool);
+	printf("Passed test_pool.\n");
+}
+
+int main() {
+	test_slab();
+	test_arena();
+	test_pool();
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include "hashtable/htbloom.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Returns the share of 100000 never-added keys the filter lets through
+static double false_positive_rate(const HtBloom *bloom) {
+	size_t passed = 0;
+	for (uint64_t i = 0; i < 100000; ++i) {
+		uint64_t key = 1000000000 + i;
+		passed += ht_bloom_may_contain(bloom, &key, sizeof(key));
+	}
+	return passed / 100000.0;
+}
+
+// Function to test that added keys are always found and the false-positive
+// rate matches the bits per key.
+void test_htbloom_rates() {
+	const unsigned bits[3] = {8, 0, 16};
+	const uint64_t keys[3] = {32768, 21845, 16384};	 // 1024 blocks each: exactly the requested bits per key
+	const double   limits[3] = {0.04, 0.01, 0.003}; // Documented rates with some slack
+	for (int b = 0; b < 3; ++b) {
+		HtBloom bloom;
+		bool	ok = ht_bloom_init(&bloom, keys[b], bits[b]);
+		assert(ok);
+		assert(bloom.block_mask == 1023);
+		for (uint64_t key = 0; key < keys[b]; ++key) {
+			ht_bloom_add(&bloom, &key, sizeof(key));
+		}
+		for (uint64_t key = 0; key < keys[b]; ++key) {
+			assert(ht_bloom_may_contain(&bloom, &key, sizeof(key))); // Never a false negative
+		}
+		double rate = false_positive_rate(&bloom);
+		printf("%u bits/key: %.3f%% false positives\n", bits[b] ? bits[b] : HT_BLOOM_BITS_PER_KEY, rate * 100);
+		assert(rate < limits[b]);
+		assert(!ht_bloom_stale(&bloom));
+		ht_bloom_deinit(&bloom);
+	}
+}
+
+// Function to test raw hashes, including the identity hash of integers.
+void test_htbloom_hashes() {
+	HtBloom bloom;
+	bool	ok = ht_bloom_init(&bloom, 1000, 0);
+	assert(ok);
+	for (uint64_t id = 0; id < 1000; ++id) {
+		ht_bloom_add_hash(&bloom, id * 4096);
+	}
+	size_t passed = 0;
+	for (uint64_t id = 0; id < 1000; ++id) {
+		assert(ht_bloom_may_contain_hash(&bloom, id * 4096));
+		passed += ht_bloom_may_contain_hash(&bloom, id * 4096 + 1);
+	}
+	assert(passed < 30); // Strided identity hashes still spread out
+
+	ht_bloom_clear(&bloom);
+	assert(bloom.count == 0);
+	assert(!ht_bloom_may_contain_hash(&bloom, 0));
+	ht_bloom_deinit(&bloom);
+}
+
+// Function to test when an owner is told to rebuild the filter.
+void test_htbloom_stale() {
+	HtBloom bloom;
+	bool	ok = ht_bloom_init(&bloom, 100, 0);
+	assert(ok);
+	assert(bloom.capacity == 100);
+	for (uint64_t key = 0; key < 100; ++key) {
+		ht_bloom_add_hash(&bloom, key);
+	}
+	assert(!ht_bloom_stale(&bloom));
+	ht_bloom_add_hash(&bloom, 100); // Over capacity
+	assert(ht_bloom_stale(&bloom));
+
+	ok = ht_bloom_reset(&bloom, 1000);
+	assert(ok);
+	assert(bloom.count == 0 && bloom.capacity == 1000);
+	assert((bloom.block_mask + 1) * 256 >= 1000 * HT_BLOOM_BITS_PER_KEY);
+	for (uint64_t key = 0; key < 10; ++key) {
+		ht_bloom_add_hash(&bloom, key);
+	}
+	bloom.removed = 5;
+	assert(!ht_bloom_stale(&bloom));
+	bloom.removed = 6; // Over half of the keys gone
+	assert(ht_bloom_stale(&bloom));
+	ht_bloom_postpone(&bloom);
+	assert(!ht_bloom_stale(&bloom));
+
+	ok = ht_bloom_reset(&bloom, 0); // Never below the minimum size
+	assert(ok);
+	assert(bloom.capacity == HT_BLOOM_MIN_CAPACITY);
+	ht_bloom_deinit(&bloom);
+}
+
+// Function that runs all the test cases for the Bloom filter.
+void run_tests() {
+	test_htbloom_rates();  // Run false-positive rate test
+	test_htbloom_hashes(); // Run raw hash test
+	test_htbloom_stale();  // Run rebuild policy test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -0,0 +1,160 @@
+#include "hashtable/htconcurrent.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STABLE_KEYS 512
+#define CHURN_KEYS 512
+#define WRITERS 2
+#define READERS 4
+
+static int values[STABLE_KEYS + CHURN_KEYS];
+
+// Function to test single-threaded operations: insert, update, search, delete
+// and growth well past the initial bucket count.
+void test_htconcurrent_basic_operations() {
+	HtConcurrentTable tab;
+	bool			  ok = htc_init_table(&tab, 4, 2);
+	assert(ok);
+	assert(tab.shard_count == 4);
+
+	char key[32];
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "key_%d", i);
+		ok = htc_emplace(&tab, key, &values[i % 100]);
+		assert(ok);
+	}
+	assert(htc_count(&tab) == 1000);
+
+	for (int i = 0; i < 1000; ++i) {
+		snprintf(key, sizeof(key), "key_%d", i);
+		assert(htc_search(&tab, key) == &values[i % 100]);
+	}
+	assert(htc_search(&tab, "key_1000") == NULL);
+
+	// Updates replace the value in place
+	ok = htc_emplace(&tab, "key_5", &values[99]);
+	assert(ok);
+	assert(htc_search(&tab, "key_5") == &values[99]);
+	assert(htc_count(&tab) == 1000);
+
+	for (int i = 0; i < 1000; i += 2) {
+		snprintf(key, sizeof(key), "key_%d", i);
+		ok = htc_delete(&tab, key);
+		assert(ok);
+		ok = htc_delete(&tab, key);
+		assert(!ok);
+	}
+	assert(htc_count(&tab) == 500);
+	assert(htc_search(&tab, "key_0") == NULL);
+	assert(htc_search(&tab, "key_1") == &values[1]);
+
+	// With no reader inside, everything retired can be freed
+	htc_collect(&tab);
+	for (unsigned i = 0; i < tab.shard_count; ++i) {
+		assert(tab.shards[i].retired == NULL);
+	}
+
+	// Sized keys may contain null bytes
+	const char bin[4] = {'a', '\0', 'b', '\0'};
+	ok = htc_emplace_s(&tab, bin, 4, &values[3]);
+	assert(ok);
+	assert(htc_search_s(&tab, bin, 4) == &values[3]);
+	assert(htc_search_s(&tab, bin, 3) == NULL);
+	ok = htc_delete_s(&tab, bin, 4);
+	assert(ok);
+
+	htc_deinit_table(&tab);
+}
+
+typedef struct {
+	HtConcurrentTable *tab;
+	int				   id;
+	atomic_int		  *stop;
+} ThreadArgs;
+
+static void *writer_thread(void *p) {
+	ThreadArgs *args = p;
+	char		key[32];
+	// Each writer churns its own half of the churn keys
+	for (int round = 0; round < 40; ++round) {
+		for (int i = args->id; i < CHURN_KEYS; i += WRITERS) {
+			snprintf(key, sizeof(key), "churn_%d", i);
+			bool ok = htc_emplace(args->tab, key, &values[STABLE_KEYS + i]);
+			assert(ok);
+		}
+		for (int i = args->id; i < CHURN_KEYS; i += WRITERS) {
+			snprintf(key, sizeof(key), "churn_%d", i);
+			bool ok = htc_delete(args->tab, key);
+			assert(ok);
+		}
+	}
+	return NULL;
+}
+
+static void *reader_thread(void *p) {
+	ThreadArgs *args = p;
+	char		key[32];
+	unsigned	i = (unsigned) args->id;
+	while (!atomic_load(args->stop)) {
+		// Stable keys are always found with their value, churn keys are either
+		// absent or carry theirs
+		unsigned k = (i++ * 2654435761u) % STABLE_KEYS;
+		snprintf(key, sizeof(key), "stable_%u", k);
+		assert(htc_search(args->tab, key) == &values[k]);
+
+		k = (i * 40503u) % CHURN_KEYS;
+		snprintf(key, sizeof(key), "churn_%u", k);
+		void *v = htc_search(args->tab, key);
+		assert(v == NULL || v == &values[STABLE_KEYS + k]);
+	}
+	return NULL;
+}
+
+// Function to test concurrent readers and writers. Writers grow the shards and
+// retire nodes while readers keep searching; AddressSanitizer catches any node
+// freed while a reader could still see it.
+void test_htconcurrent_threads() {
+	HtConcurrentTable tab;
+	bool			  ok = htc_init_table(&tab, 4, 1);
+	assert(ok);
+
+	char key[32];
+	for (int i = 0; i < STABLE_KEYS; ++i) {
+		snprintf(key, sizeof(key), "stable_%d", i);
+		ok = htc_emplace(&tab, key, &values[i]);
+		assert(ok);
+	}
+
+	atomic_int stop = 0;
+	pthread_t  threads[WRITERS + READERS];
+	ThreadArgs args[WRITERS + READERS];
+	for (int t = 0; t < WRITERS + READERS; ++t) {
+		args[t] = (ThreadArgs){&tab, t < WRITERS ? t : t - WRITERS, &stop};
+		int err = pthread_create(&threads[t], NULL, t < WRITERS ? writer_thread : reader_thread, &args[t]);
+		assert(err == 0);
+	}
+	for (int t = 0; t < WRITERS; ++t) {
+		pthread_join(threads[t], NULL);
+	}
+	atomic_store(&stop, 1);
+	for (int t = WRITERS; t < WRITERS + READERS; ++t) {
+		pthread_join(threads[t], NULL);
+	}
+
+	assert(htc_count(&tab) == STABLE_KEYS);
+	htc_deinit_table(&tab);
+}
+
+// Function that runs all the test cases for the concurrent hash table.
+void run_tests() {
+	test_htconcurrent_basic_operations(); // Run single-threaded test
+	test_htconcurrent_threads();		  // Run multi-threaded test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
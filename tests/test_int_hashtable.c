@@ -0,0 +1,152 @@
+#include "hashtable/int_hashtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+DEF_INT_HASHTABLE(uint32_t, int, EntityMap, UINT32_MAX)
+DEF_INT_HASHTABLE(uint64_t, uint64_t, HandleMap, 0)
+
+// Function to test insertion, replacement, lookup, deletion and the sentinel key.
+void test_int_hashtable_basic() {
+	EntityMap map;
+	bool	  ok = EntityMap_init(&map, 0);
+	assert(ok);
+	assert(EntityMap_get(&map, 1) == NULL);
+	ok = EntityMap_delete(&map, 1);
+	assert(!ok);
+
+	ok = EntityMap_insert(&map, 0, 10);
+	assert(ok);
+	ok = EntityMap_insert(&map, 1, 11);
+	assert(ok);
+	assert(*EntityMap_get(&map, 0) == 10);
+	assert(*EntityMap_get(&map, 1) == 11);
+	ok = EntityMap_insert(&map, 1, 12); // Replaces the value
+	assert(ok);
+	assert(map.count == 2);
+	assert(*EntityMap_get(&map, 1) == 12);
+
+	// The sentinel marks empty slots and can be neither inserted nor found
+	ok = EntityMap_insert(&map, UINT32_MAX, 1);
+	assert(!ok);
+	assert(EntityMap_get(&map, UINT32_MAX) == NULL);
+	ok = EntityMap_delete(&map, UINT32_MAX);
+	assert(!ok);
+
+	ok = EntityMap_delete(&map, 0);
+	assert(ok);
+	assert(EntityMap_get(&map, 0) == NULL);
+	assert(*EntityMap_get(&map, 1) == 12);
+	assert(map.count == 1);
+	EntityMap_deinit(&map);
+}
+
+// Function to test random inserts and deletes of 64-bit handles against a reference array.
+void test_int_hashtable_random() {
+	enum { KEYS = 4096 };
+	static uint64_t reference[KEYS]; // 0 when absent
+	memset(reference, 0, sizeof(reference));
+
+	HandleMap map;
+	bool	  ok = HandleMap_init(&map, 1);
+	assert(ok);
+	srand(11);
+	for (int round = 0; round < 200000; ++round) {
+		int		 k = rand() % KEYS;
+		uint64_t handle = ((uint64_t) k << 32) | 0x10; // Generation in the low bits, index above
+		if (rand() % 3) {
+			reference[k] = (uint64_t) round + 1;
+			ok = HandleMap_insert(&map, handle, (uint64_t) round + 1);
+			assert(ok);
+		} else {
+			ok = HandleMap_delete(&map, handle);
+			assert(ok == (reference[k] != 0));
+			reference[k] = 0;
+		}
+	}
+
+	size_t count = 0;
+	for (int k = 0; k < KEYS; ++k) {
+		uint64_t *value = HandleMap_get(&map, ((uint64_t) k << 32) | 0x10);
+		assert((value != NULL) == (reference[k] != 0));
+		assert(!value || *value == reference[k]);
+		count += reference[k] != 0;
+	}
+	assert(map.count == count);
+	assert(map.count * INT_HASHTABLE_MAX_LOAD_DEN <= map.capacity * INT_HASHTABLE_MAX_LOAD_NUM);
+	HandleMap_deinit(&map);
+}
+
+// Function to test batched lookups of hits and misses, including runs that wrap around the end of the table.
+void test_int_hashtable_batch() {
+	EntityMap map;
+	bool	  ok = EntityMap_init(&map, 12);
+	assert(ok);
+	uint32_t ids[100];
+	for (uint32_t i = 0; i < 100; ++i) {
+		ids[i] = i * 7;
+		if (i % 2 == 0) {
+			ok = EntityMap_insert(&map, ids[i], (int) i);
+			assert(ok);
+		}
+	}
+
+	int *out[100];
+	EntityMap_get_batch(&map, ids, 100, out);
+	for (int i = 0; i < 100; ++i) {
+		assert((out[i] != NULL) == (i % 2 == 0));
+		assert(!out[i] || *out[i] == i);
+		assert(out[i] == EntityMap_get(&map, ids[i]));
+	}
+
+	EntityMap empty;
+	ok = EntityMap_init(&empty, 0);
+	assert(ok);
+	EntityMap_get_batch(&empty, ids, 3, out);
+	assert(out[0] == NULL && out[1] == NULL && out[2] == NULL);
+	EntityMap_deinit(&empty);
+	EntityMap_deinit(&map);
+}
+
+// Function to test that strided IDs, which defeat identity hashing, still get short probes.
+void test_int_hashtable_strided() {
+	EntityMap map;
+	bool	  ok = EntityMap_init(&map, 0);
+	assert(ok);
+	for (uint32_t i = 0; i < 20000; ++i) {
+		ok = EntityMap_insert(&map, i * 4096, (int) i);
+		assert(ok);
+	}
+
+	HtStats stats;
+	EntityMap_stats(&map, &stats);
+	assert(stats.entries == 20000);
+	assert(stats.load_factor <= 0.75);
+	assert(stats.avg_probe < 3.0);
+	assert(stats.bytes == map.capacity * (sizeof(uint32_t) + sizeof(int)));
+
+	for (uint32_t i = 0; i < 20000; i += 2) {
+		ok = EntityMap_delete(&map, i * 4096);
+		assert(ok);
+	}
+	for (uint32_t i = 0; i < 20000; ++i) {
+		int *value = EntityMap_get(&map, i * 4096);
+		assert((value != NULL) == (i % 2 == 1));
+		assert(!value || *value == (int) i);
+	}
+	EntityMap_deinit(&map);
+}
+
+// Function that runs all the test cases for integer-key hash tables.
+void run_tests() {
+	test_int_hashtable_basic();	   // Run insert/lookup/delete test
+	test_int_hashtable_random();   // Run randomized 64-bit test
+	test_int_hashtable_batch();	   // Run batched lookup test
+	test_int_hashtable_strided();  // Run strided ID test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
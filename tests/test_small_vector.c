@@ -0,0 +1,142 @@
+#include "btree/btree.h"
+#include "vector/small_vector.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+DEF_SMALL_VECTOR(int, 4, IntSmallVec)
+DEF_BTREE(int, IntTree)
+
+static int IntTree_node_cmp(IntTree_node *pnode_a, IntTree_node *pnode_b) {
+	return (pnode_a->value > pnode_b->value) - (pnode_a->value < pnode_b->value);
+}
+
+// Function to test that up to N elements stay in the inline buffer.
+void test_small_vector_inline() {
+	IntSmallVec vec;
+	IntSmallVec_init(&vec, 0);
+	assert(IntSmallVec_is_inline(&vec));
+	assert(vec.capacity == 4 && vec.count == 0);
+
+	for (int i = 0; i < 4; ++i) {
+		int ok = IntSmallVec_push_back(&vec, i * 10);
+		assert(ok);
+	}
+	assert(IntSmallVec_is_inline(&vec));
+	assert(vec.data == vec.inline_data);
+	for (int i = 0; i < 4; ++i)
+		assert(vec.data[i] == i * 10);
+
+	int out = 0;
+	int ok = IntSmallVec_pop_back(&vec, &out);
+	assert(ok);
+	assert(out == 30 && vec.count == 3);
+	IntSmallVec_deinit(&vec);
+	assert(IntSmallVec_is_inline(&vec) && vec.count == 0);
+}
+
+// Function to test spilling to the heap and moving back inline on shrink.
+void test_small_vector_spill() {
+	IntSmallVec vec;
+	IntSmallVec_init(&vec, 0);
+	for (int i = 0; i < 100; ++i) {
+		int ok = IntSmallVec_push_back(&vec, i);
+		assert(ok);
+	}
+	assert(!IntSmallVec_is_inline(&vec));
+	assert(vec.capacity >= 100);
+	for (int i = 0; i < 100; ++i)
+		assert(vec.data[i] == i);
+
+	// Shrinking to N or fewer elements returns to the inline buffer
+	int ok = IntSmallVec_erase_range(&vec, 3, 97);
+	assert(ok);
+	ok = IntSmallVec_shrink_to_fit(&vec);
+	assert(ok);
+	assert(IntSmallVec_is_inline(&vec));
+	assert(vec.capacity == 4 && vec.count == 3);
+	assert(vec.data[0] == 0 && vec.data[1] == 1 && vec.data[2] == 2);
+
+	// _realloc below count truncates, as with DEF_VECTOR
+	ok = IntSmallVec_realloc_exact(&vec, 2);
+	assert(ok);
+	assert(vec.count == 2);
+	IntSmallVec_deinit(&vec);
+
+	// A large initial capacity allocates up front
+	IntSmallVec_init(&vec, 64);
+	assert(!IntSmallVec_is_inline(&vec));
+	assert(vec.capacity == 64);
+	IntSmallVec_deinit(&vec);
+	assert(IntSmallVec_is_inline(&vec));
+}
+
+// Function to test the bulk operations shared with DEF_VECTOR across the inline/heap boundary.
+void test_small_vector_bulk() {
+	IntSmallVec vec;
+	IntSmallVec_init(&vec, 0);
+	int values[6] = {1, 2, 3, 4, 5, 6};
+	int ok = IntSmallVec_append_n(&vec, values, 2);
+	assert(ok);
+	assert(IntSmallVec_is_inline(&vec));
+	ok = IntSmallVec_insert_range(&vec, 1, values + 2, 4); // 1 3 4 5 6 2
+	assert(ok);
+	assert(!IntSmallVec_is_inline(&vec));
+	int expect[6] = {1, 3, 4, 5, 6, 2};
+	assert(vec.count == 6 && memcmp(vec.data, expect, sizeof(expect)) == 0);
+
+	int *slot = IntSmallVec_emplace_back(&vec);
+	assert(slot);
+	*slot = 7;
+	ok = IntSmallVec_resize_uninit(&vec, 9);
+	assert(ok);
+	assert(vec.count == 9 && vec.data[6] == 7);
+	ok = IntSmallVec_insert_range(&vec, 10, values, 1); // out of range
+	assert(!ok);
+	IntSmallVec_deinit(&vec);
+}
+
+// Function to test that a btree iterator descends past its inline depth and back.
+void test_small_vector_btree_iterator() {
+	enum { DEPTH = BTREE_ITER_INLINE_DEPTH * 3 };
+	IntTree_node *nodes = malloc(DEPTH * sizeof(IntTree_node));
+	assert(nodes);
+	IntTree_node_init_t(&nodes[0], 0);
+	for (int i = 1; i < DEPTH; ++i) {
+		IntTree_node_init_t(&nodes[i], i);
+		nodes[i - 1].pchildren[BTREE_RIGHT] = &nodes[i];
+		IntTree_node_parent_to(&nodes[i], &nodes[i - 1], BTREE_RIGHT);
+	}
+	assert(IntTree_node_cmp(&nodes[0], &nodes[1]) < 0);
+
+	IntTree_iterator iter;
+	IntTree_iterator_init(&iter, &nodes[0]);
+	assert(IntTree_pnode_stack_is_inline(&iter.stack));
+	int steps = 0;
+	while (IntTree_iter_child(&iter, BTREE_RIGHT)) {
+		++steps;
+		if (steps < BTREE_ITER_INLINE_DEPTH)
+			assert(IntTree_pnode_stack_is_inline(&iter.stack));
+	}
+	assert(steps == DEPTH - 1);
+	assert(iter.current == &nodes[DEPTH - 1]);
+	while (IntTree_iter_parent(&iter))
+		--steps;
+	assert(steps == 0 && iter.current == &nodes[0]);
+	IntTree_iterator_deinit(&iter);
+	free(nodes);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_small_vector_inline();		   // Run inline storage test
+	test_small_vector_spill();		   // Run heap spill and shrink test
+	test_small_vector_bulk();		   // Run bulk operation test
+	test_small_vector_btree_iterator(); // Run deep btree iterator test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
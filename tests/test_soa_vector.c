@@ -0,0 +1,117 @@
+#include "vector/soa_vector.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define PARTICLE_FIELDS(X) X(float, x) X(float, vx) X(uint8_t, flags) X(double, mass) X(int, id)
+DEF_SOA_VECTOR(PARTICLE_FIELDS, Particles)
+
+static Particles_elem make_particle(int id) {
+	Particles_elem p = {(float) id, 0.5f, (uint8_t) (id & 0xff), id * 2.0, id};
+	return p;
+}
+
+static int is_aligned(const void *ptr) {
+	return ((uintptr_t) ptr % SOA_VECTOR_ALIGN) == 0;
+}
+
+// Function to test push, get, set and pop across growth.
+void test_soa_vector_push_pop() {
+	Particles ps;
+	Particles_init(&ps, 0);
+	assert(ps.count == 0 && ps.capacity == 0);
+	int ok = Particles_pop_back(&ps, NULL);
+	assert(!ok);
+
+	for (int i = 0; i < 1000; ++i) {
+		ok = Particles_push_back(&ps, make_particle(i));
+		assert(ok);
+	}
+	assert(ps.count == 1000);
+	assert(ps.capacity >= 1000 && ps.capacity % SOA_VECTOR_LANES == 0);
+	assert(is_aligned(ps.x) && is_aligned(ps.vx) && is_aligned(ps.flags));
+	assert(is_aligned(ps.mass) && is_aligned(ps.id));
+	for (int i = 0; i < 1000; ++i) {
+		Particles_elem p = Particles_get(&ps, (size_t) i);
+		assert(p.x == (float) i && p.vx == 0.5f && p.flags == (uint8_t) i);
+		assert(p.mass == i * 2.0 && p.id == i);
+	}
+
+	Particles_set(&ps, 3, make_particle(77));
+	assert(ps.id[3] == 77 && ps.mass[3] == 154.0);
+
+	Particles_elem out;
+	ok = Particles_pop_back(&ps, &out);
+	assert(ok);
+	assert(out.id == 999 && ps.count == 999);
+	Particles_clear(&ps);
+	assert(ps.count == 0 && ps.capacity >= 1000);
+	Particles_deinit(&ps);
+	assert(ps.block == NULL && ps.capacity == 0);
+}
+
+// Function to test unordered removal.
+void test_soa_vector_swap_remove() {
+	Particles ps;
+	Particles_init(&ps, 8);
+	assert(ps.capacity == SOA_VECTOR_LANES);
+	for (int i = 0; i < 5; ++i) {
+		int ok = Particles_push_back(&ps, make_particle(i));
+		assert(ok);
+	}
+
+	int ok = Particles_swap_remove(&ps, 1); // last (4) moves into slot 1
+	assert(ok);
+	assert(ps.count == 4);
+	assert(ps.id[1] == 4 && ps.x[1] == 4.0f && ps.flags[1] == 4 && ps.mass[1] == 8.0);
+	ok = Particles_swap_remove(&ps, 3); // removing the last element moves nothing
+	assert(ok);
+	assert(ps.count == 3 && ps.id[0] == 0 && ps.id[1] == 4 && ps.id[2] == 2);
+	ok = Particles_swap_remove(&ps, 3);
+	assert(!ok);
+	Particles_deinit(&ps);
+}
+
+// Function to test whole-field loops through spans.
+void test_soa_vector_spans() {
+	Particles ps;
+	Particles_init(&ps, 0);
+	int ok = Particles_resize_uninit(&ps, 333);
+	assert(ok);
+	float *x = SOA_VECTOR_SPAN(&ps, x);
+	float *vx = SOA_VECTOR_SPAN(&ps, vx);
+	int	  *id = SOA_VECTOR_SPAN(&ps, id);
+	for (size_t i = 0; i < ps.count; ++i) {
+		x[i] = (float) i;
+		vx[i] = 2.0f;
+		id[i] = (int) i;
+	}
+	for (size_t i = 0; i < ps.count; ++i)
+		x[i] += vx[i] * 0.5f;
+
+	// The padding up to the next multiple of SOA_VECTOR_LANES is writable
+	size_t padded = (ps.count + SOA_VECTOR_LANES - 1) / SOA_VECTOR_LANES * SOA_VECTOR_LANES;
+	assert(padded <= ps.capacity);
+	for (size_t i = ps.count; i < padded; ++i)
+		x[i] = 0.0f;
+
+	// Growth keeps the data of every field
+	ok = Particles_reserve(&ps, 5000);
+	assert(ok);
+	for (size_t i = 0; i < ps.count; ++i)
+		assert(ps.x[i] == (float) i + 1.0f && ps.id[i] == (int) i);
+	Particles_deinit(&ps);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_soa_vector_push_pop();	   // Run push/pop test
+	test_soa_vector_swap_remove(); // Run swap-remove test
+	test_soa_vector_spans();	   // Run span loop test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
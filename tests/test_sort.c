@@ -0,0 +1,203 @@
+#include "test_common.h"
+#include "vector/radix_sort.h"
+#include "vector/vector.h"
+#include "vector/vector_sort.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Sprite {
+	float depth;
+	int	  id;
+} Sprite;
+
+#define INT_LESS(a, b)	  (*(a) < *(b))
+#define SPRITE_LESS(a, b) ((a)->depth < (b)->depth)
+
+DEF_VECTOR(int, IntVec)
+DEF_VECTOR_SORT(int, IntVec, INT_LESS)
+DEF_VECTOR(Sprite, SpriteVec)
+DEF_VECTOR_SORT(Sprite, SpriteVec, SPRITE_LESS)
+DEF_VECTOR(RadixPair64, DrawList)
+
+static int cmp_int(const void *a, const void *b) {
+	int x = *(const int *) a, y = *(const int *) b;
+	return (x > y) - (x < y);
+}
+
+static int cmp_u64(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+	return (x > y) - (x < y);
+}
+
+// Function to test the generated comparison sort on random, sorted, reversed and duplicate-heavy input.
+void test_sort_generated() {
+	static const size_t sizes[] = {0, 1, 2, 3, 16, 17, 100, 1000, 20000};
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		size_t n = sizes[s];
+		for (int pattern = 0; pattern < 4; ++pattern) {
+			IntVec vec;
+			IntVec_init(&vec, n);
+			for (size_t i = 0; i < n; ++i) {
+				int value = pattern == 0   ? (int) test_rand()
+							: pattern == 1 ? (int) i
+							: pattern == 2 ? (int) (n - i)
+										   : (int) (test_rand() % 4);
+				int ok = IntVec_push_back(&vec, value);
+				assert(ok);
+			}
+			int *expect = malloc((n + 1) * sizeof(int));
+			assert(expect);
+			for (size_t i = 0; i < n; ++i)
+				expect[i] = vec.data[i];
+			qsort(expect, n, sizeof(int), cmp_int);
+			IntVec_sort(&vec);
+			assert(IntVec_is_sorted(vec.data, vec.count));
+			assert(n == 0 || memcmp(vec.data, expect, n * sizeof(int)) == 0);
+			free(expect);
+			IntVec_deinit(&vec);
+		}
+	}
+
+	// The heapsort fallback taken when quicksort recurses too deep
+	int heap[300];
+	for (int i = 0; i < 300; ++i)
+		heap[i] = (int) (test_rand() % 50);
+	IntVec_introsort(heap, 300, 0);
+	assert(IntVec_is_sorted(heap, 300));
+
+	// Struct elements through a member comparison; the same ids survive
+	SpriteVec sprites;
+	SpriteVec_init(&sprites, 0);
+	for (int i = 0; i < 500; ++i) {
+		Sprite sprite = {(float) (test_rand() % 100) / 10.0f, i};
+		int	   ok = SpriteVec_push_back(&sprites, sprite);
+		assert(ok);
+	}
+	SpriteVec_sort(&sprites);
+	assert(SpriteVec_is_sorted(sprites.data, sprites.count));
+	int seen[500] = {0};
+	for (size_t i = 0; i < sprites.count; ++i)
+		++seen[sprites.data[i].id];
+	for (int i = 0; i < 500; ++i)
+		assert(seen[i] == 1);
+	SpriteVec_deinit(&sprites);
+}
+
+// Function to test the integer and float radix sorts against qsort and the expected order.
+void test_sort_radix_keys() {
+	enum { N = 5000 };
+	static uint32_t u32[N];
+	static int32_t	i32[N];
+	static uint64_t u64[N], u64_expect[N];
+	static int64_t	i64[N];
+	static float	f32[N];
+	for (size_t i = 0; i < N; ++i) {
+		u64[i] = u64_expect[i] = test_rand();
+		u32[i] = (uint32_t) u64[i];
+		i32[i] = (int32_t) (u64[i] >> 7);
+		i64[i] = (int64_t) u64[i];
+		f32[i] = (float) ((int32_t) u64[i] % 100000) / 7.0f;
+	}
+	// Float edge values
+	f32[0] = -INFINITY;
+	f32[1] = INFINITY;
+	f32[2] = -0.0f;
+	f32[3] = 0.0f;
+	f32[4] = -1e-30f;
+	f32[5] = 1e-30f;
+
+	bool ok = radix_sort_u32(u32, N);
+	ok &= radix_sort_i32(i32, N);
+	ok &= radix_sort_u64(u64, N);
+	ok &= radix_sort_i64(i64, N);
+	ok &= radix_sort_f32(f32, N);
+	assert(ok);
+	qsort(u64_expect, N, sizeof(uint64_t), cmp_u64);
+	assert(memcmp(u64, u64_expect, sizeof(u64)) == 0);
+	for (size_t i = 1; i < N; ++i) {
+		assert(u32[i - 1] <= u32[i]);
+		assert(i32[i - 1] <= i32[i]);
+		assert(i64[i - 1] <= i64[i]);
+		assert(f32[i - 1] <= f32[i]);
+	}
+	assert(f32[0] == -INFINITY && f32[N - 1] == INFINITY);
+	for (size_t i = 1; i < N; ++i) {
+		if (f32[i] == 0.0f && f32[i - 1] == 0.0f)
+			assert(signbit(f32[i - 1]) && !signbit(f32[i])); // -0.0 sorts first
+	}
+
+	// Trivial sizes and keys that share all but one byte
+	ok = radix_sort_u32(u32, 0);
+	ok &= radix_sort_u32(u32, 1);
+	assert(ok);
+	uint32_t low[4] = {0x12345603u, 0x12345601u, 0x12345602u, 0x12345600u};
+	ok = radix_sort_u32(low, 4);
+	assert(ok);
+	assert(low[0] == 0x12345600u && low[3] == 0x12345603u);
+}
+
+// Function to test that pair sorting is stable and the parallel sorts match the serial ones.
+void test_sort_radix_pairs() {
+	enum { N = 300000 }; // several parallel chunks
+	DrawList list;
+	DrawList_init(&list, N);
+	for (size_t i = 0; i < N; ++i) {
+		RadixPair64 pair = {test_rand() % 1000 << 40, i};
+		int			ok = DrawList_push_back(&list, pair);
+		assert(ok);
+	}
+	RadixPair64 *copy = malloc(N * sizeof(RadixPair64));
+	assert(copy);
+	memcpy(copy, list.data, N * sizeof(RadixPair64));
+
+	bool ok = radix_sort_pairs64(VEC_SPAN(&list));
+	assert(ok);
+	for (size_t i = 1; i < N; ++i) {
+		assert(list.data[i - 1].key <= list.data[i].key);
+		if (list.data[i - 1].key == list.data[i].key)
+			assert(list.data[i - 1].value < list.data[i].value); // equal keys keep their order
+	}
+	for (unsigned threads = 1; threads <= 4; threads += 3) {
+		RadixPair64 *par = malloc(N * sizeof(RadixPair64));
+		assert(par);
+		memcpy(par, copy, N * sizeof(RadixPair64));
+		ok = radix_sort_pairs64_parallel(par, N, threads);
+		assert(ok);
+		assert(memcmp(par, list.data, N * sizeof(RadixPair64)) == 0);
+		free(par);
+	}
+
+	uint64_t *keys = malloc(N * sizeof(uint64_t));
+	uint32_t *keys32 = malloc(N * sizeof(uint32_t));
+	assert(keys && keys32);
+	for (size_t i = 0; i < N; ++i) {
+		keys[i] = test_rand();
+		keys32[i] = (uint32_t) keys[i];
+	}
+	ok = radix_sort_u64_parallel(keys, N, 0);
+	assert(ok);
+	ok = radix_sort_u32_parallel(keys32, N, 3);
+	assert(ok);
+	for (size_t i = 1; i < N; ++i)
+		assert(keys[i - 1] <= keys[i] && keys32[i - 1] <= keys32[i]);
+	free(keys);
+	free(keys32);
+	free(copy);
+	DrawList_deinit(&list);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_sort_generated();	 // Run comparison sort test
+	test_sort_radix_keys();	 // Run radix key test
+	test_sort_radix_pairs(); // Run key/value and parallel test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -0,0 +1,226 @@
+#include "test_common.h"
+#include "vector/vec_kernels.h"
+#include "vector/vector.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+DEF_VECTOR(float, FloatVec)
+DEF_VECTOR(int32_t, Int32Vec)
+
+// Sizes around every vector width and unroll factor, plus a larger one
+static const size_t sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 23, 31, 32, 33, 63, 64, 65, 1000};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+#define MAX_SIZE   1000
+#define MAX_OFFSET 3 // Start offsets, so that the data is not vector-aligned
+
+// Non-negative 31-bit values from test_rand
+static int32_t rand_int32(void) {
+	return (int32_t) (test_rand() >> 33);
+}
+
+// Small integers, so that float sums are exact in any order
+static void fill_random(float *f, int32_t *i, uint8_t *mask, size_t n) {
+	for (size_t k = 0; k < n; ++k) {
+		i[k] = rand_int32() % 2001 - 1000;
+		f[k] = (float) (i[k] % 64);
+		mask[k] = (uint8_t) (rand_int32() % 3 == 0 ? 0 : rand_int32() % 255 + 1);
+	}
+}
+
+// Function to test find, count, min, max and argmin against plain loops.
+void test_vec_kernels_search(const float *f, const int32_t *i, size_t n) {
+	for (size_t k = 0; k < n; k += n / 7 + 1) {
+		size_t first = 0;
+		while (f[first] != f[k])
+			++first;
+		assert(vec_find_f32(f, n, f[k]) == first);
+		first = 0;
+		while (i[first] != i[k])
+			++first;
+		assert(vec_find_i32(i, n, i[k]) == first);
+	}
+	assert(vec_find_f32(f, n, 1000.0f) == n);
+	assert(vec_find_i32(i, n, 5000) == n);
+
+	size_t fc = 0, ic = 0;
+	for (size_t k = 0; k < n; ++k) {
+		fc += f[k] == 3.0f;
+		ic += i[k] == i[0];
+	}
+	assert(vec_count_f32(f, n, 3.0f) == fc);
+	if (n)
+		assert(vec_count_i32(i, n, i[0]) == ic);
+
+	if (n == 0) {
+		assert(vec_argmin_f32(f, 0) == 0 && vec_argmin_i32(i, 0) == 0);
+		return;
+	}
+	size_t fmin = 0, fmax = 0, imin = 0, imax = 0;
+	for (size_t k = 1; k < n; ++k) {
+		fmin = f[k] < f[fmin] ? k : fmin;
+		fmax = f[k] > f[fmax] ? k : fmax;
+		imin = i[k] < i[imin] ? k : imin;
+		imax = i[k] > i[imax] ? k : imax;
+	}
+	assert(vec_min_f32(f, n) == f[fmin] && vec_max_f32(f, n) == f[fmax]);
+	assert(vec_min_i32(i, n) == i[imin] && vec_max_i32(i, n) == i[imax]);
+	assert(vec_argmin_f32(f, n) == fmin);
+	assert(vec_argmin_i32(i, n) == imin);
+}
+
+// Function to test sum and dot products.
+void test_vec_kernels_reduce(const float *f, const int32_t *i, size_t n) {
+	float	 fsum = 0.0f, fdot = 0.0f;
+	int64_t	 isum = 0;
+	uint32_t idot = 0;
+	for (size_t k = 0; k < n; ++k) {
+		fsum += f[k];
+		fdot += f[k] * f[n - 1 - k];
+		isum += i[k];
+		idot += (uint32_t) i[k] * (uint32_t) i[n - 1 - k];
+	}
+	float *rev = malloc((n + 1) * sizeof(float));
+	assert(rev);
+	for (size_t k = 0; k < n; ++k)
+		rev[k] = f[n - 1 - k];
+	assert(vec_sum_f32(f, n) == fsum);
+	assert(vec_dot_f32(f, rev, n) == fdot);
+	assert(vec_sum_i32(i, n) == isum);
+	int32_t *irev = malloc((n + 1) * sizeof(int32_t));
+	assert(irev);
+	for (size_t k = 0; k < n; ++k)
+		irev[k] = i[n - 1 - k];
+	assert(vec_dot_i32(i, irev, n) == (int32_t) idot);
+	free(rev);
+	free(irev);
+}
+
+// Function to test the kernels that write: fill, clamp, compact and prefix sum, with guard elements after the end.
+void test_vec_kernels_write(const float *f, const int32_t *i, const uint8_t *mask, size_t n) {
+	float	fbuf[MAX_SIZE + 1], fout[MAX_SIZE + 1];
+	int32_t ibuf[MAX_SIZE + 1], iout[MAX_SIZE + 1];
+
+	fbuf[n] = -7.0f;
+	ibuf[n] = -7;
+	vec_fill_f32(fbuf, n, 2.5f);
+	vec_fill_i32(ibuf, n, 42);
+	for (size_t k = 0; k < n; ++k)
+		assert(fbuf[k] == 2.5f && ibuf[k] == 42);
+	assert(fbuf[n] == -7.0f && ibuf[n] == -7);
+
+	memcpy(fbuf, f, n * sizeof(float));
+	memcpy(ibuf, i, n * sizeof(int32_t));
+	vec_clamp_f32(fbuf, n, -10.0f, 20.0f);
+	vec_clamp_i32(ibuf, n, -100, 300);
+	for (size_t k = 0; k < n; ++k) {
+		float	fx = f[k] < -10.0f ? -10.0f : f[k] > 20.0f ? 20.0f : f[k];
+		int32_t ix = i[k] < -100 ? -100 : i[k] > 300 ? 300 : i[k];
+		assert(fbuf[k] == fx && ibuf[k] == ix);
+	}
+	assert(fbuf[n] == -7.0f && ibuf[n] == -7);
+
+	// Compact into a separate buffer and in place
+	size_t kept = 0;
+	for (size_t k = 0; k < n; ++k)
+		kept += mask[k] != 0;
+	size_t fkept = vec_compact_f32(fout, f, mask, n);
+	size_t ikept = vec_compact_i32(iout, i, mask, n);
+	assert(fkept == kept && ikept == kept);
+	memcpy(ibuf, i, n * sizeof(int32_t));
+	ikept = vec_compact_i32(ibuf, ibuf, mask, n);
+	assert(ikept == kept);
+	for (size_t k = 0, j = 0; k < n; ++k) {
+		if (mask[k]) {
+			assert(fout[j] == f[k] && iout[j] == i[k] && ibuf[j] == i[k]);
+			++j;
+		}
+	}
+
+	// Prefix sums into a separate buffer and in place
+	fout[n] = -7.0f;
+	iout[n] = -7;
+	vec_prefix_sum_f32(fout, f, n);
+	vec_prefix_sum_i32(iout, i, n);
+	memcpy(ibuf, i, n * sizeof(int32_t));
+	vec_prefix_sum_i32(ibuf, ibuf, n);
+	float	fsum = 0.0f;
+	int32_t isum = 0;
+	for (size_t k = 0; k < n; ++k) {
+		fsum += f[k];
+		isum += i[k];
+		assert(fout[k] == fsum && iout[k] == isum && ibuf[k] == isum);
+	}
+	assert(fout[n] == -7.0f && iout[n] == -7);
+}
+
+// Function to test every kernel at every supported level, size and start offset.
+void test_vec_kernels_levels() {
+	static float   f[MAX_SIZE + MAX_OFFSET];
+	static int32_t i[MAX_SIZE + MAX_OFFSET];
+	static uint8_t mask[MAX_SIZE + MAX_OFFSET];
+	fill_random(f, i, mask, MAX_SIZE + MAX_OFFSET);
+
+	VecSimdLevel best = vec_simd_detect();
+	for (int level = VEC_SIMD_SCALAR; level <= (int) best; ++level) {
+		VecSimdLevel set = vec_simd_set_level((VecSimdLevel) level);
+		assert(set == (VecSimdLevel) level);
+		assert(vec_simd_level() == (VecSimdLevel) level);
+		for (size_t s = 0; s < SIZE_COUNT; ++s) {
+			for (size_t off = 0; off <= MAX_OFFSET; ++off) {
+				test_vec_kernels_search(f + off, i + off, sizes[s]);
+				test_vec_kernels_reduce(f + off, i + off, sizes[s]);
+				test_vec_kernels_write(f + off, i + off, mask + off, sizes[s]);
+			}
+		}
+	}
+	printf("vec_kernels: tested up to level %d\n", (int) best);
+
+	// Levels above the supported one fall back to it
+	VecSimdLevel set = vec_simd_set_level(VEC_SIMD_AVX2);
+	assert(set == best);
+}
+
+// Function to test edge values and kernels applied to DEF_VECTOR storage.
+void test_vec_kernels_vectors() {
+	Int32Vec iv;
+	Int32Vec_init(&iv, 0);
+	for (int k = 0; k < 37; ++k) {
+		int ok = Int32Vec_push_back(&iv, k == 20 ? INT32_MIN : k == 30 ? INT32_MAX : k);
+		assert(ok);
+	}
+	assert(vec_min_i32(VEC_SPAN(&iv)) == INT32_MIN);
+	assert(vec_max_i32(VEC_SPAN(&iv)) == INT32_MAX);
+	assert(vec_argmin_i32(VEC_SPAN(&iv)) == 20);
+	assert(vec_sum_i32(VEC_SPAN(&iv)) == (int64_t) INT32_MIN + INT32_MAX + (36 * 37 / 2 - 20 - 30));
+	vec_clamp_i32(VEC_SPAN(&iv), -5, 5);
+	assert(iv.data[20] == -5 && iv.data[30] == 5 && iv.data[3] == 3);
+	Int32Vec_deinit(&iv);
+
+	FloatVec fv;
+	FloatVec_init(&fv, 0);
+	int ok = FloatVec_resize_uninit(&fv, 19);
+	assert(ok);
+	vec_fill_f32(VEC_SPAN(&fv), 1.0f);
+	fv.data[18] = -1.0f;
+	fv.data[5] = -1.0f;
+	assert(vec_argmin_f32(VEC_SPAN(&fv)) == 5);
+	assert(vec_sum_f32(VEC_SPAN(&fv)) == 15.0f);
+	vec_prefix_sum_f32(fv.data, fv.data, fv.count);
+	assert(fv.data[18] == 15.0f);
+	FloatVec_deinit(&fv);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_vec_kernels_levels();	// Run all kernels at every level
+	test_vec_kernels_vectors(); // Run DEF_VECTOR and edge value test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
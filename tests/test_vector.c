@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* ------------------------------------------------------------------ */
 /* 1️⃣  Define the inner and outer vector types                         */
@@ -35,7 +36,102 @@ static void print_intvecvec(const IntVecVec *vv) {
 }
 
 /* ------------------------------------------------------------------ */
-/* 4️⃣  Test entry point – now also exercises push_back / pop_back    */
+/* 4️⃣  Bulk operations, emplace and explicit shrinking                 */
+/* ------------------------------------------------------------------ */
+static void test_bulk_ops(void) {
+	IntVec v;
+	IntVec_init(&v, 0);
+	assert(v.data == NULL && v.capacity == 0);
+
+	/* ---- reserve allocates without changing count ---------------- */
+	int ok = IntVec_reserve(&v, 10);
+	assert(ok && "reserve should succeed");
+	assert(v.capacity == 10 && v.count == 0);
+	ok = IntVec_reserve(&v, 5); /* never shrinks */
+	assert(ok && "reserve below capacity should succeed");
+	assert(v.capacity == 10);
+
+	/* ---- append_n / insert_range ---------------------------------- */
+	const int first[4] = {1, 2, 3, 4};
+	ok = IntVec_append_n(&v, first, 4);
+	assert(ok && "append_n should succeed");
+	const int middle[3] = {10, 11, 12};
+	ok = IntVec_insert_range(&v, 2, middle, 3); /* 1 2 10 11 12 3 4 */
+	assert(ok && "insert_range in the middle should succeed");
+	ok = IntVec_insert_range(&v, 0, middle, 1); /* 10 1 2 10 11 12 3 4 */
+	assert(ok && "insert_range at the front should succeed");
+	ok = IntVec_insert_range(&v, v.count, first, 2); /* ... 1 2 */
+	assert(ok && "insert_range at the end should succeed");
+	ok = IntVec_insert_range(&v, v.count + 1, first, 1);
+	assert(!ok && "insert_range past the end must return 0");
+	const int expect1[10] = {10, 1, 2, 10, 11, 12, 3, 4, 1, 2};
+	assert(v.count == 10 && memcmp(v.data, expect1, sizeof(expect1)) == 0);
+
+	/* ---- erase_range ---------------------------------------------- */
+	ok = IntVec_erase_range(&v, 3, 3); /* 10 1 2 3 4 1 2 */
+	assert(ok && "erase_range in the middle should succeed");
+	ok = IntVec_erase_range(&v, 5, 2); /* 10 1 2 3 4 */
+	assert(ok && "erase_range at the end should succeed");
+	ok = IntVec_erase_range(&v, 5, 0);
+	assert(ok && "empty erase_range should succeed");
+	ok = IntVec_erase_range(&v, 4, 2);
+	assert(!ok && "erase_range past the end must return 0");
+	const int expect2[5] = {10, 1, 2, 3, 4};
+	assert(v.count == 5 && memcmp(v.data, expect2, sizeof(expect2)) == 0);
+
+	/* ---- emplace_back returns the new slot ------------------------ */
+	int *slot = IntVec_emplace_back(&v);
+	assert(slot == &v.data[5] && v.count == 6);
+	*slot = 99;
+	assert(v.data[5] == 99);
+
+	/* ---- resize_uninit grows geometrically, keeps the prefix ------ */
+	size_t cap = v.capacity;
+	ok = IntVec_resize_uninit(&v, cap + 1);
+	assert(ok && "resize_uninit growing should succeed");
+	assert(v.count == cap + 1 && v.capacity >= 2 * cap);
+	for (size_t i = 6; i < v.count; ++i)
+		v.data[i] = (int) i;
+	assert(memcmp(v.data, expect2, sizeof(expect2)) == 0 && v.data[5] == 99);
+	ok = IntVec_resize_uninit(&v, 3);
+	assert(ok && "resize_uninit shrinking should succeed");
+	assert(v.count == 3 && v.capacity >= 2 * cap);
+
+	/* ---- pop_back never shrinks: no thrashing around a boundary ---- */
+	for (int round = 0; round < 100; ++round) {
+		ok = IntVec_push_back(&v, round);
+		assert(ok && "push_back should succeed");
+		ok = IntVec_pop_back(&v, NULL);
+		assert(ok && "pop_back should succeed");
+	}
+	while (IntVec_pop_back(&v, NULL)) {
+	}
+	assert(v.count == 0 && v.capacity >= 2 * cap);
+
+	/* ---- explicit shrinking ---------------------------------------- */
+	ok = IntVec_append_n(&v, first, 4);
+	assert(ok && "append_n should succeed");
+	ok = IntVec_shrink_to_fit(&v);
+	assert(ok && "shrink_to_fit should succeed");
+	assert(v.capacity == 4 && memcmp(v.data, first, sizeof(first)) == 0);
+	ok = IntVec_erase_range(&v, 0, 4);
+	assert(ok && "erase_range of everything should succeed");
+	ok = IntVec_shrink_to_fit(&v);
+	assert(ok && "shrink_to_fit of an empty vector should succeed");
+	assert(v.capacity == 0 && v.data == NULL);
+
+	/* ---- many single pushes reuse the geometric growth ------------ */
+	for (int i = 0; i < 1000; ++i) {
+		ok = IntVec_push_back(&v, i);
+		assert(ok && "push_back should succeed");
+	}
+	assert(v.count == 1000 && v.data[999] == 999 && v.capacity < 2000);
+	IntVec_deinit(&v);
+	printf("\n=== Bulk operations passed ===\n");
+}
+
+/* ------------------------------------------------------------------ */
+/* 5️⃣  Test entry point – now also exercises push_back / pop_back    */
 /* ------------------------------------------------------------------ */
 int main(void) {
 	IntVecVec outer;
@@ -117,5 +213,7 @@ int main(void) {
 	printf("\n=== After full deinitialisation ===\n");
 	printf("outer: capacity=%zu, count=%zu, data=%p\n", outer.capacity, outer.count, (void *) outer.data);
 
+	test_bulk_ops();
+
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "test_common.h"
+#include "vector/vector.h"
+#include "vector/vector_eytzinger.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct Keyframe {
+	float time;
+	float value;
+} Keyframe;
+
+#define INT_LESS(a, b)		(*(a) < *(b))
+#define KEYFRAME_LESS(a, b) ((a)->time < (b)->time)
+
+DEF_VECTOR(int, IntVec)
+DEF_VECTOR_EYTZINGER(int, IntVec, INT_LESS)
+DEF_VECTOR(Keyframe, KeyframeVec)
+DEF_VECTOR_EYTZINGER(Keyframe, KeyframeVec, KEYFRAME_LESS)
+
+// Function to test the layout, in-order stepping and searches against a sorted copy, for every size up to a few
+// complete levels and a larger one.
+void test_eytzinger_int() {
+	for (size_t n = 0; n <= 1100; n = n < 70 ? n + 1 : n * 4) {
+		IntVec vec;
+		IntVec_init(&vec, n);
+		int *sorted = malloc((n + 1) * sizeof(int));
+		assert(sorted);
+		int value = 0;
+		for (size_t i = 0; i < n; ++i) {
+			value += (int) (test_rand() % 3); // ascending with duplicates
+			sorted[i] = value;
+			int ok = IntVec_push_back(&vec, value);
+			assert(ok);
+		}
+		int ok = IntVec_eytzinger_layout(&vec);
+		assert(ok);
+		assert(vec.count == n);
+
+		// Stepping forwards and backwards visits the sorted order
+		size_t index = IntVec_eytzinger_first(n);
+		for (size_t i = 0; i < n; ++i) {
+			assert(index < n && vec.data[index] == sorted[i]);
+			index = IntVec_eytzinger_next(index, n);
+		}
+		assert(index == n);
+		index = IntVec_eytzinger_last(n);
+		for (size_t i = n; i-- > 0;) {
+			assert(index < n && vec.data[index] == sorted[i]);
+			index = IntVec_eytzinger_prev(index, n);
+		}
+		assert(index == n);
+
+		// Lower bounds land on the first of any run of duplicates
+		for (int key = -1; key <= value + 1; ++key) {
+			size_t rank = 0;
+			while (rank < n && sorted[rank] < key)
+				++rank;
+			size_t found = IntVec_eytzinger_lower_bound(VEC_SPAN(&vec), &key);
+			if (rank == n) {
+				assert(found == n);
+			} else {
+				assert(found < n && vec.data[found] == sorted[rank]);
+				size_t prev = IntVec_eytzinger_prev(found, n);
+				assert(rank == 0 ? prev == n : vec.data[prev] < key);
+			}
+			found = IntVec_eytzinger_find(VEC_SPAN(&vec), &key);
+			assert(rank < n && sorted[rank] == key ? found < n && vec.data[found] == key : found == n);
+		}
+		free(sorted);
+		IntVec_deinit(&vec);
+	}
+}
+
+// Function to test bracketing a time between two keyframes of a struct array.
+void test_eytzinger_keyframes() {
+	KeyframeVec frames;
+	KeyframeVec_init(&frames, 0);
+	for (int i = 0; i < 1000; ++i) {
+		Keyframe frame = {(float) i * 0.5f, (float) i};
+		int		 ok = KeyframeVec_push_back(&frames, frame);
+		assert(ok);
+	}
+	int ok = KeyframeVec_eytzinger_layout(&frames);
+	assert(ok);
+	for (int i = 0; i < 4000; ++i) {
+		Keyframe probe = {(float) (1 + test_rand() % 498999) / 1000.0f, 0.0f};
+		size_t	 after = KeyframeVec_eytzinger_lower_bound(VEC_SPAN(&frames), &probe);
+		size_t	 before = KeyframeVec_eytzinger_prev(after, frames.count);
+		assert(after < frames.count && before < frames.count);
+		assert(frames.data[before].time < probe.time && probe.time <= frames.data[after].time);
+		assert(frames.data[after].value == frames.data[before].value + 1.0f);
+	}
+	Keyframe past = {1000.0f, 0.0f};
+	assert(KeyframeVec_eytzinger_lower_bound(VEC_SPAN(&frames), &past) == frames.count);
+	KeyframeVec_deinit(&frames);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_eytzinger_int();		// Run integer layout and search test
+	test_eytzinger_keyframes(); // Run keyframe bracketing test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}
@@ -0,0 +1,140 @@
+#include "vector/vm_vector.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef struct Particle {
+	float	 position[3];
+	uint32_t id;
+} Particle;
+
+DEF_VM_VECTOR(int, IntVmVec)
+DEF_VM_VECTOR(Particle, ParticleVmVec)
+
+// Whether the page holding `addr` is backed by memory
+static int page_resident(const void *addr) {
+	size_t		  page = (size_t) sysconf(_SC_PAGESIZE);
+	unsigned char resident = 0;
+	void		 *start = (void *) ((uintptr_t) addr & ~(uintptr_t) (page - 1));
+	int			  err = mincore(start, page, &resident);
+	assert(err == 0);
+	return resident & 1;
+}
+
+// Function to test that growing never moves the data.
+void test_vm_vector_stable() {
+	ParticleVmVec vec;
+	int			  ok = ParticleVmVec_init(&vec, 1000000, 0);
+	assert(ok);
+	assert(vec.data && vec.capacity == 0 && vec.count == 0);
+
+	ok = ParticleVmVec_push_back(&vec, (Particle) {{0, 0, 0}, 0});
+	assert(ok);
+	Particle *base = vec.data;
+	Particle *first = &vec.data[0];
+	size_t	  grows = 0, last_capacity = vec.capacity;
+	for (uint32_t i = 1; i < 1000000; ++i) {
+		ok = ParticleVmVec_push_back(&vec, (Particle) {{(float) i, 0, 0}, i});
+		assert(ok);
+		if (vec.capacity != last_capacity) {
+			++grows;
+			last_capacity = vec.capacity;
+		}
+	}
+	assert(grows > 5);
+	assert(vec.data == base && &vec.data[0] == first);
+	for (uint32_t i = 0; i < 1000000; ++i)
+		assert(vec.data[i].id == i);
+
+	// Bulk operations work in place too
+	ok = ParticleVmVec_erase_range(&vec, 0, 500000);
+	assert(ok);
+	assert(vec.count == 500000 && vec.data[0].id == 500000 && vec.data == base);
+	ParticleVmVec_deinit(&vec);
+	assert(vec.data == NULL && vec.capacity == 0);
+}
+
+// Function to test that the reservation is a hard limit that growth may reach exactly.
+void test_vm_vector_limit() {
+	IntVmVec vec;
+	int		 ok = IntVmVec_init(&vec, 0, 0);
+	assert(!ok);
+	ok = IntVmVec_init(&vec, SIZE_MAX / 2, 0);
+	assert(!ok);
+
+	ok = IntVmVec_init(&vec, 3000, 0);
+	assert(ok);
+	for (int i = 0; i < 3000; ++i) {
+		ok = IntVmVec_push_back(&vec, i); // doubling past 3000 falls back to the exact need
+		assert(ok);
+	}
+	assert(vec.count == 3000 && vec.capacity == 3000);
+	ok = IntVmVec_push_back(&vec, 3000);
+	assert(!ok);
+	ok = IntVmVec_reserve(&vec, 3001);
+	assert(!ok);
+	assert(vec.count == 3000 && vec.data[2999] == 2999);
+	IntVmVec_deinit(&vec);
+}
+
+// Function to test that shrinking returns pages and regrowing hands back zeroed memory at the same address.
+void test_vm_vector_shrink() {
+	size_t	 page = (size_t) sysconf(_SC_PAGESIZE);
+	IntVmVec vec;
+	int		 ok = IntVmVec_init(&vec, 1 << 24, 0);
+	assert(ok);
+	ok = IntVmVec_resize_uninit(&vec, 16 * page);
+	assert(ok);
+	for (size_t i = 0; i < vec.count; ++i)
+		vec.data[i] = 7;
+	int *base = vec.data;
+	int *tail = &vec.data[vec.count - 1];
+	assert(page_resident(tail));
+
+	vec.count = 10;
+	ok = IntVmVec_shrink_to_fit(&vec);
+	assert(ok);
+	assert(vec.data == base && vec.capacity * sizeof(int) == page);
+	assert(!page_resident(tail));
+	assert(vec.data[9] == 7);
+
+	ok = IntVmVec_resize_uninit(&vec, 16 * page);
+	assert(ok);
+	assert(vec.data == base && *tail == 0);
+	IntVmVec_deinit(&vec);
+}
+
+// Function to test the huge-page mode.
+void test_vm_vector_huge() {
+	IntVmVec vec;
+	int		 ok = IntVmVec_init(&vec, 10000000, VM_VECTOR_HUGE_PAGES);
+	assert(ok);
+	assert(((uintptr_t) vec.data & (VM_VECTOR_HUGE_PAGE_SIZE - 1)) == 0);
+	ok = IntVmVec_push_back(&vec, 1);
+	assert(ok);
+	assert(vec.capacity * sizeof(int) == VM_VECTOR_HUGE_PAGE_SIZE);
+	int *base = vec.data;
+	for (int i = 1; i < 10000000; ++i) {
+		ok = IntVmVec_push_back(&vec, i);
+		assert(ok);
+	}
+	assert(vec.data == base && vec.count == 10000000 && vec.capacity == 10000000);
+	assert(vec.data[9999999] == 9999999);
+	IntVmVec_deinit(&vec);
+}
+
+// Function to run all test cases.
+void run_tests() {
+	test_vm_vector_stable(); // Run address stability test
+	test_vm_vector_limit();	 // Run reservation limit test
+	test_vm_vector_shrink(); // Run decommit test
+	test_vm_vector_huge();	 // Run huge page test
+}
+
+// Entry point of the program, which executes all the test cases.
+int main() {
+	run_tests(); // Execute the test suite
+	return 0;	 // Indicate successful completion
+}